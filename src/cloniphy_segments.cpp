@@ -0,0 +1,96 @@
+/**
+ * Export clone genome layouts from a segment archive (segments.bin) as text.
+ *
+ * usage: cloniphy-segments <segments.bin> segments|variants [<clone> [<chr>[:<start>-<end>]]]
+ *
+ *   segments: one line per SegmentCopy (clone, chromosome, id, start, end)
+ *   variants: one line per variant carried by a SegmentCopy (id, variant id)
+ */
+#include "core/vario/SegmentArchive.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+using namespace std;
+using seqio::TCoord;
+using vario::ArchivedSegment;
+using vario::SegmentArchive;
+
+int main (int argc, char* argv[])
+{
+  if (argc < 3 || (string(argv[2]) != "segments" && string(argv[2]) != "variants")) {
+    fprintf(stderr, "usage: %s <segments.bin> segments|variants [<clone> [<chr>[:<start>-<end>]]]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  bool do_vars = (string(argv[2]) == "variants");
+
+  SegmentArchive archive;
+  if (!archive.open(argv[1]))
+    return EXIT_FAILURE;
+
+  // parse optional clone label and region
+  vector<string> vec_clone = archive.getCloneLabels();
+  if (argc > 3)
+    vec_clone = { argv[3] };
+  string id_chr_qry = "";
+  TCoord start = 0;
+  TCoord end = numeric_limits<TCoord>::max();
+  if (argc > 4) {
+    id_chr_qry = argv[4];
+    size_t pos_colon = id_chr_qry.find(':');
+    if (pos_colon != string::npos) {
+      string reg = id_chr_qry.substr(pos_colon+1);
+      id_chr_qry = id_chr_qry.substr(0, pos_colon);
+      size_t pos_dash = reg.find('-');
+      bool is_valid_reg = (pos_dash != string::npos);
+      if (is_valid_reg) {
+        try {
+          // coordinates must be numeric to their end
+          string str_start = reg.substr(0, pos_dash);
+          string str_end = reg.substr(pos_dash+1);
+          size_t len_start = 0, len_end = 0;
+          start = stoul(str_start, &len_start);
+          end = stoul(str_end, &len_end);
+          is_valid_reg = (len_start == str_start.length() && len_end == str_end.length() && start <= end);
+        } catch (const logic_error&) {
+          is_valid_reg = false;
+        }
+      }
+      if (!is_valid_reg) {
+        fprintf(stderr, "[ERROR] (main) invalid region '%s', expected <chr>:<start>-<end>.\n", argv[4]);
+        return EXIT_FAILURE;
+      }
+    }
+  }
+
+  for (auto const & lbl_clone : vec_clone) {
+    vector<string> vec_chr = archive.getChromosomeIds(lbl_clone);
+    if (vec_chr.size() == 0) {
+      fprintf(stderr, "[ERROR] (main) clone '%s' not found in archive.\n", lbl_clone.c_str());
+      return EXIT_FAILURE;
+    }
+    if (id_chr_qry.length() > 0)
+      vec_chr = { id_chr_qry };
+    for (auto const & id_chr : vec_chr) {
+      vector<ArchivedSegment> vec_seg;
+      if (!archive.getSegments(lbl_clone, id_chr, vec_seg, start, end)) {
+        fprintf(stderr, "[ERROR] (main) cannot load segments for '%s:%s'.\n", lbl_clone.c_str(), id_chr.c_str());
+        return EXIT_FAILURE;
+      }
+      for (auto const & seg : vec_seg) {
+        if (do_vars) {
+          for (auto const & id_var : seg.vec_var_ids)
+            printf("%lu\t%s\n", seg.id, id_var.c_str());
+        } else {
+          printf("%s\t%s\t%lu\t%lu\t%lu\n", lbl_clone.c_str(), id_chr.c_str(), seg.id, seg.ref_start, seg.ref_end);
+        }
+      }
+    }
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -66,23 +66,20 @@ BulkSample::getTotalCopyNumberAt (
   TCoord& out_seg_len
 ) const
 {
-  typedef interval_map<TCoord, AlleleSpecCopyNum> TCnMap;
-
   // sanity check: chromosome id present? 
-  if ( this->m_chr_cn.count(chr) == 1 ) {
-    // find interval overlapping position
-    TCnMap::const_iterator it = this->m_chr_cn.at(chr).find(pos);
-    // retrieve interval that contains given locus
-    auto seg = it->first;
-    out_seg_len = seg.upper() - seg.lower();
-    // retrieve allele-specific (maternal/paternal) copy number state
-    AlleleSpecCopyNum ascn = it->second;
-    // total copy number: sum of maternal and paternal allele counts
-    out_cn_tot = ascn.count_A + ascn.count_B;
+  auto it_chr = this->m_chr_cn.find(chr);
+  if ( it_chr == this->m_chr_cn.end() ) { // this is to be treated as an error
+    return false;
   }
-  else { // this is to be treated as an error
+  // find interval containing given locus
+  const seqio::CopyNumberProfile& cn = it_chr->second;
+  size_t i = cn.find(pos);
+  if ( i == cn.numIntervals() ) {
     return false;
   }
+  out_seg_len = cn.m_bkp[i+1] - cn.m_bkp[i];
+  // total copy number: sum of maternal and paternal allele counts
+  out_cn_tot = cn.m_count_A[i] + cn.m_count_B[i];
 
   return true;
 }
@@ -91,7 +88,7 @@ bool
 BulkSample::initAlleleCounts (
   const map<string, double> map_clone_ccf,
   const vario::VariantStore& var_store,
-  const map<string, map<string, seqio::TSegMap>> map_clone_chr_seg
+  const map<string, map<string, seqio::SegmentIndex>>& map_clone_chr_seg
   //vario::TMapChrPosVaf& out_map_chr_pos_vaf
 )
 {
@@ -100,51 +97,44 @@ BulkSample::initAlleleCounts (
 
   this->m_map_clone_snv_vac.clear();
   this->m_map_snv_vaf.clear();
+  const vario::VariantTable& tbl_snv = var_store.tbl_snv;
+  vector<int> vec_id_snv = tbl_snv.getIds();
 
   // loop over clone genomes
-  for (auto clone_chr_seg : map_clone_chr_seg) {
+  for (auto const & clone_chr_seg : map_clone_chr_seg) {
 
     string id_clone = clone_chr_seg.first;
-    // segment copy map for clone, indexed by chromosome
-    map<string, seqio::TSegMap> map_chr_seg = clone_chr_seg.second;
+    // segment copy index for clone, by chromosome
+    const map<string, seqio::SegmentIndex>& map_chr_seg = clone_chr_seg.second;
 
     // initialize map for clone
     m_map_clone_snv_vac[id_clone] = map<int, vario::VariantAlleleCount>();
 
     // populate allele counts for SNVs
-    for (auto const & kv : var_store.map_id_snv) {
-      int id_var = kv.first;
-      Variant var = kv.second;
-      
-      TCoord pos_var = var.pos;
-      string id_chr = var.chr;
+    for (int id_var : vec_id_snv) {
+      vario::VariantTable::TRow row = tbl_snv.getRow(id_var);
+      TCoord pos_var = tbl_snv.pos(row);
+      const string& id_chr = tbl_snv.chr(row);
 
       // if (out_map_chr_pos_vaf.count(id_chr) == 0) {
       //   out_map_chr_pos_vaf[id_chr] = TMapPosVaf();
       // }
       
       // get segment copies overlapping SNV position
-      seqio::TSegMap imap_seg_chr = map_clone_chr_seg.at(id_clone).at(id_chr);
-      seqio::TSegSet iset_read;
-      iset_read.add(interval<TCoord>::right_open(pos_var, pos_var+1));
-      seqio::TSegMap imap_seg_ovlp = imap_seg_chr & iset_read;
+      const seqio::SegmentIndex& idx_seg_chr = map_chr_seg.at(id_chr);
+      auto p_seg_ids = idx_seg_chr.getSegmentIds(pos_var, pos_var+1);
 
       short num_tot = 0;
       short num_alt = 0;
 
-      for (auto const & itvl_iset : imap_seg_ovlp) {
-        for (const SegmentCopy & segment : itvl_iset.second) {
-          num_tot++; // increase total allele count
-          // check if current segment copy carries current SNV
-          auto it_seg_vars = var_store.map_seg_vars.find(segment.id);
-          if (it_seg_vars == var_store.map_seg_vars.end()) 
-            continue;
-          vector<int> vec_seg_vars = it_seg_vars->second;
-
-          // increase alternative allele count if variant associated to segment copy
-          if(find(vec_seg_vars.begin(), vec_seg_vars.end(), id_var) != vec_seg_vars.end())
-            num_alt++;
-        }
+      for (const seqio::TSegId* p_id = p_seg_ids.first; p_id != p_seg_ids.second; ++p_id) {
+        num_tot++; // increase total allele count
+        // check if current segment copy carries current SNV (variants at SNV position)
+        auto p_seg_vars = var_store.getSegmentSnvs(*p_id, pos_var, pos_var+1);
+
+        // increase alternative allele count if variant associated to segment copy
+        if(find(p_seg_vars.first, p_seg_vars.second, id_var) != p_seg_vars.second)
+          num_alt++;
       }
 
       vario::VariantAlleleCount vac;
@@ -162,8 +152,7 @@ BulkSample::initAlleleCounts (
   //   A_k,i := Alternative alleles of clone k at variant i
   //   N_k,i := Total alleles of clone k at variant i
 
-  for (auto const & kv : var_store.map_id_snv) {
-    int id_snv = kv.first;
+  for (int id_snv : vec_id_snv) {
     double vaf = 0.0;
 
     for (auto const & clone_ccf : map_clone_ccf) {
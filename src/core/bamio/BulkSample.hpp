@@ -3,6 +3,8 @@
 
 #include "../bamio.hpp"
 #include "../seqio/AlleleSpecCopyNum.hpp"
+#include "../seqio/CopyNumberProfile.hpp"
+#include "../seqio/SegmentIndex.hpp"
 
 namespace bamio {
 
@@ -22,14 +24,8 @@ struct BulkSample {
   /** absolute genome length (all segment copies considered) */
   seqio::TCoord genome_len_abs;
 
-  /** Allele-specific copy number state by chromosome, coordinates */
-  std::map<
-    std::string,     // chromosome id
-    boost::icl::interval_map<
-      seqio::TCoord, // start and end coordinates 
-      seqio::AlleleSpecCopyNum // copy no. for maternal and paternal allele
-    >
-  > m_chr_cn;
+  /** Allele-specific copy number profile by chromosome (weighted sum of clone profiles) */
+  std::map<std::string, seqio::CopyNumberProfile> m_chr_cn;
 
   /** Allele counts of SNVs indexed by clone, SNV id. */
   std::map<std::string, std::map<int, vario::VariantAlleleCount>> m_map_clone_snv_vac;
@@ -134,7 +130,7 @@ struct BulkSample {
   initAlleleCounts (
     const std::map<std::string, double> map_clone_ccf,
     const vario::VariantStore& var_store,
-    const std::map<std::string, std::map<std::string, seqio::TSegMap>> map_clone_chr_seg
+    const std::map<std::string, std::map<std::string, seqio::SegmentIndex>>& map_clone_chr_seg
   );
 };
 
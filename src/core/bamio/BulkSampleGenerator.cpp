@@ -185,7 +185,7 @@ BulkSampleGenerator::generateReadCounts (
   for (auto snv_vaf : sample.m_map_snv_vaf) {
     int id_snv = snv_vaf.first;
     double vaf = snv_vaf.second;
-    Variant var = var_store.map_id_snv.at(id_snv);
+    Variant var = var_store.tbl_snv.at(id_snv);
 
     // calculate copy number-adjusted expected coverage
     double cn_seg;
@@ -228,15 +228,15 @@ fprintf(stderr, "### BulkSampleGenerator::GenerateReadCounts(): colliding varian
   //---------------------------------------------------------------------------
   
   // determine expected number of seq errors
-  unsigned n_err_exp = m_ref_len * seq_error * seq_coverage;
+  TCoord n_err_exp = m_ref_len * seq_error * seq_coverage;
   // sample number of seq errors to introduce
-  unsigned n_err = rng.getRandomFunctionPoisson(n_err_exp)();
+  TCoord n_err = rng.getRandomFunctionPoisson(n_err_exp)();
   // random function to sample relative genome positions
   function<double()> r_pos_rel = rng.getRandomFunctionReal(0.0, 1.0);
 
   // introduce sequencing errors at random genomic positions
   function<TCoord()> r_unif = rng.getRandomFunctionInt(TCoord(0), m_ref_len);
-  for (unsigned i=0; i<n_err; i++) {
+  for (TCoord i=0; i<n_err; i++) {
     // pick random reference position
     TCoord pos_abs = r_pos_rel() * this->m_ref_len;
     // identify chromosome and bp position
@@ -250,8 +250,7 @@ fprintf(stderr, "### BulkSampleGenerator::GenerateReadCounts(): colliding varian
     }
     if ( map_chr_pos_base_rc[chr_err].count(pos_err) == 0 ) {
       // get reference nucleotide for error position
-      string ref_nuc;
-      this->m_ref_genome->getSequence(chr_err, pos_err, pos_err+1, ref_nuc);
+      string ref_nuc(1, this->m_ref_genome->getNucAt(chr_err, pos_err));
       // calculate copy number-adjusted expected coverage
       double cn_seg;
       TCoord seg_len;
@@ -327,8 +326,7 @@ BulkSampleGenerator::writeReadCountsVcf (
     for (auto & pos_rc : chr_rc.second) {
       TCoord pos = pos_rc.first;
       // determine REF allele
-      string ref;
-      this->m_ref_genome->getSequence(chr, pos, pos+1, ref);
+      string ref(1, this->m_ref_genome->getNucAt(chr, pos));
 
       int depth = 0;
       string alt, ac;
@@ -396,7 +394,7 @@ BulkSampleGenerator::generateBulkSeqReads (
   assert ( this->has_clone_genomes );
 
   // calculate total number of reads
-  unsigned long long len_ref = 0;
+  TCoord len_ref = 0;
   for (auto const & kv : m_map_ref_len)
     len_ref += kv.second;
   unsigned long n_reads_tot = cvg_total * len_ref / art.read_len;
@@ -419,7 +417,7 @@ BulkSampleGenerator::generateBulkSeqReads (
   // for(auto& entry: directory_iterator(path_fasta)) {
   for(auto const & fasta_len : this->m_map_fasta_len) {
     path path_fa = fasta_len.first;
-    unsigned long long seq_len = fasta_len.second;
+    TCoord seq_len = fasta_len.second;
 
     //string fn_pfx = basename(entry);
     string fn_pfx = basename(path_fa);
@@ -440,7 +438,7 @@ BulkSampleGenerator::generateBulkSeqReads (
 
     // calculate number of reads to be sampled from this segment
     // (total number of reads) * (fraction of genome contained)
-    unsigned long long genome_len = this->m_map_clone_len[id_clone];
+    TCoord genome_len = this->m_map_clone_len[id_clone];
     double seq_frac = double(seq_len) * copy_number / genome_len;
     unsigned long n_reads = map_clone_reads[id_clone] * seq_frac;
     double cvg = double(n_reads) / seq_len * art.read_len;
@@ -494,9 +492,10 @@ BulkSampleGenerator::mergeBulkSeqReads (
   // initialize read counts for SNV positions
   map<string, unsigned> map_var_cvg;
   map<string, unsigned> map_var_alt;
-  for (auto const id_snv : var_store.map_id_snv) {
-    map_var_cvg[id_snv.second.id] = 0;
-    map_var_alt[id_snv.second.id] = 0;
+  const vario::VariantTable& tbl_snv = var_store.tbl_snv;
+  for (size_t row = 0; row < tbl_snv.size(); ++row) {
+    map_var_cvg[tbl_snv.label(row)] = 0;
+    map_var_alt[tbl_snv.label(row)] = 0;
   }
 
   // create new output file for sample
@@ -593,7 +592,7 @@ fprintf(stderr, "### Removing input SAM (%s).\n", fn_bam_in);
 
 void
 BulkSampleGenerator::initCloneGenomes (
-  const map<string, GenomeInstance> map_lbl_gi,
+  const map<string, GenomeInstance>& map_lbl_gi,
   const path path_bed
 )
 {
@@ -601,30 +600,30 @@ BulkSampleGenerator::initCloneGenomes (
   
   for (auto const & kv : map_lbl_gi) {
     string lbl_clone = kv.first;
-    GenomeInstance genome = kv.second;
+    const GenomeInstance& genome = kv.second;
+
+    // infer copy number profile for each chromosome
+    map<string, seqio::CopyNumberProfile>& map_chr_cn = this->m_map_clone_chr_cn[lbl_clone];
+    map_chr_cn.clear();
+    genome.getCopyNumberProfiles(map_chr_cn);
 
     // data structure to keep track of genomic fragments and their CN state
     // ordered by location (chr, start, end);
     map<seqio::TRegion, seqio::AlleleSpecCopyNum> map_reg_cn;
 
-    // infer copy number state segments
-    // for each chromosome id, build an interval map
-    map<string, interval_map<TCoord, seqio::AlleleSpecCopyNum>> map_chr_alleles;
-    genome.getCopyNumberStateByChr(map_chr_alleles);
-
     // loop over chromosomes
-    for ( auto const & chr_seg : map_chr_alleles ) {
-      string id_chr = chr_seg.first;
+    for ( auto const & chr_cn : map_chr_cn ) {
+      string id_chr = chr_cn.first;
+      const seqio::CopyNumberProfile& cn = chr_cn.second;
       // loop over segments belonging to chromosome
-      for ( auto const & seg : chr_seg.second ) {
-        auto itvl = seg.first;
-        seqio::AlleleSpecCopyNum cn_state = seg.second;
-
-        TCoord ref_start = itvl.lower();
-        TCoord ref_end = itvl.upper();
+      for ( size_t i = 0; i < cn.numIntervals(); ++i ) {
+        if ( !cn.isCovered(i) ) continue;
+        seqio::AlleleSpecCopyNum cn_state;
+        cn_state.count_A = cn.m_count_A[i];
+        cn_state.count_B = cn.m_count_B[i];
 
         // remember CN state for region
-        TRegion region = make_tuple(id_chr, ref_start, ref_end);
+        TRegion region = make_tuple(id_chr, cn.m_bkp[i], cn.m_bkp[i+1]);
         map_reg_cn[region] = cn_state;
       }
     }
@@ -636,22 +635,14 @@ BulkSampleGenerator::initCloneGenomes (
     // store genomic segments for clone by chromosome
     //-------------------------------------------------------------------------
 
-    map<string, seqio::TSegMap> map_chr_seg;
+    map<string, seqio::SegmentIndex>& map_chr_seg = this->m_map_clone_chr_seg[lbl_clone];
     for (auto const & id_ci : genome.map_id_chr) {
-      seqio::TSegMap imap_seg;
-      for (auto const & ci : id_ci.second) {
-        for (auto const & seg : ci->lst_segments) {
-          TCoord c1 = seg.ref_start;
-          TCoord c2 = seg.ref_end;
-          std::set<SegmentCopy> segset({seg});
-          imap_seg += make_pair(interval<TCoord>::right_open(c1,c2), segset);
-        }
-      }
-      map_chr_seg[id_ci.first] = imap_seg;
+      vector<SegmentCopy> vec_seg;
+      for (auto const & ci : id_ci.second)
+        vec_seg.insert(vec_seg.end(), ci->segments.begin(), ci->segments.end());
+      map_chr_seg[id_ci.first].build(vec_seg);
     }
 
-    this->m_map_clone_chr_seg[lbl_clone] = map_chr_seg;
-
     // write intervals and corresponding CN state to BED file
     path fn_bed = path_bed / format("%s.cn.bed", lbl_clone.c_str());
     std::ofstream f_bed(fn_bed.string());
@@ -682,20 +673,17 @@ BulkSampleGenerator::initCloneGenomes (
   */
 void
 BulkSampleGenerator::writeCloneGenomes (
-  const map<string, GenomeInstance> map_lbl_gi,
-  const GenomeReference ref_genome,
+  const map<string, GenomeInstance>& map_lbl_gi,
+  const GenomeReference& ref_genome,
   unsigned padding,
   unsigned min_len,
-  const path path_fasta,
-  const path path_bed
+  const path& path_fasta,
+  const path& path_bed
 )
 {
   fprintf(stdout, "Writing tiled ref seqs...\n");
   for (auto const & kv : map_lbl_gi) {
-    string label = kv.first;
-    GenomeInstance genome = kv.second;
-//fprintf(stderr, "\t%s\n", label.c_str());
-//cerr << genome;
+    const string& label = kv.first;
     // writeFastaTiled(genome, ref_genome, label, padding, min_len, path_fasta, path_bed);
     writeFastaTiled(label, this->m_clone_reg_cn[label], padding, min_len, path_fasta);
   }
@@ -709,54 +697,57 @@ BulkSampleGenerator::writeCloneGenomes (
 bool
 BulkSampleGenerator::calculateBulkCopyNumber (
   //const map<string, map<string, double>> mtx_sample,
-  const map<string, GenomeInstance> map_lbl_gi
+  const map<string, GenomeInstance>& map_lbl_gi
 )
 {
-  typedef interval_map<TCoord, seqio::AlleleSpecCopyNum> TImapCn;
+  // copy number profiles of clone genomes
+  // (reuse profiles built by initCloneGenomes(), compute missing ones)
+  for (auto const & lbl_gi : map_lbl_gi) {
+    if (this->m_map_clone_chr_cn.count(lbl_gi.first) > 0) continue;
+    lbl_gi.second.getCopyNumberProfiles(this->m_map_clone_chr_cn[lbl_gi.first]);
+  }
 
-  // loop over samples
+  // collect clone profiles and weights by chromosome for each sample
+  // (done before parallel region, so that errors can be reported)
+  typedef pair<vector<const seqio::CopyNumberProfile*>, vector<double>> TProfilesWeights;
+  vector<BulkSample*> vec_sample;
+  vector<map<string, TProfilesWeights>> vec_chr_clone_cn;
   for (auto & kv : this->m_samples) {
-    string id_sample = kv.first;
-    map<string, double> w = kv.second.m_clone_weight;
-
-    // merge CN states for individual clone genomes (use interval_map)
-    map<string, TImapCn> map_chr_cn;
-    for (auto const lbl_w : w) {
-      string id_clone = lbl_w.first;
-      double weight = lbl_w.second;
-
+    BulkSample& sample = kv.second;
+    map<string, TProfilesWeights> map_chr_clone_cn;
+    for (auto const & lbl_w : sample.m_clone_weight) {
       // clones not present in sample do not contribute to copy number.
-      if (weight == 0.0) continue;
-
-      GenomeInstance gi = map_lbl_gi.at(id_clone);
-      map<string, TImapCn> map_chr_cn_clone;
-      gi.getCopyNumberStateByChr(map_chr_cn_clone, weight);
-
-      // for each chromosome id, build an interval map
-      for ( auto const & chr_seg : map_chr_cn_clone ) {
-        string id_chr = chr_seg.first;
-        if (map_chr_cn.count(id_chr) == 0) {
-          map_chr_cn[id_chr] = chr_seg.second;
-        } else {
-          map_chr_cn[id_chr] += chr_seg.second;
-        }
+      if (lbl_w.second == 0.0) continue;
+      auto it_clone_cn = this->m_map_clone_chr_cn.find(lbl_w.first);
+      if (it_clone_cn == this->m_map_clone_chr_cn.end()) {
+        fprintf(stderr, "[ERROR] (BulkSampleGenerator::calculateBulkCopyNumber) no genome for clone '%s' (sample '%s').\n", lbl_w.first.c_str(), kv.first.c_str());
+        return false;
+      }
+      for (auto const & chr_cn : it_clone_cn->second) {
+        TProfilesWeights& cn_w = map_chr_clone_cn[chr_cn.first];
+        cn_w.first.push_back(&(chr_cn.second));
+        cn_w.second.push_back(lbl_w.second);
       }
     }
+    vec_sample.push_back(&sample);
+    vec_chr_clone_cn.push_back(map_chr_clone_cn);
+  }
 
-    // store genomic intervals and CN state in internal index
-    this->m_samples[id_sample].m_chr_cn = map_chr_cn;
+  // sample profiles are weighted sums of clone profiles
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < vec_sample.size(); ++i) {
+    BulkSample& sample = *(vec_sample[i]);
 
+    // store genomic intervals and CN state in internal index,
     // calculate real genome length for sample (used in exp. cvg. calc)
+    sample.m_chr_cn.clear();
     TCoord g_len = 0;
-    for (auto & chr_cn : map_chr_cn) {
-      TImapCn imap_cn = chr_cn.second;
-      for (auto it = imap_cn.begin(); it != imap_cn.end(); ++it) {
-        TCoord seg_len = it->first.upper() - it->first.lower();
-        double seg_cn  = it->second.count_A + it->second.count_B;
-        g_len += TCoord(seg_len * seg_cn); 
-      }
+    for (auto const & chr_clone_cn : vec_chr_clone_cn[i]) {
+      seqio::CopyNumberProfile& cn = sample.m_chr_cn[chr_clone_cn.first];
+      cn.build(chr_clone_cn.second.first, chr_clone_cn.second.second);
+      g_len += cn.getAbsoluteLength();
     }
-    this->m_samples[id_sample].genome_len_abs = g_len;
+    sample.genome_len_abs = g_len;
   }
 
   this->has_cn_states = true;
@@ -772,29 +763,23 @@ BulkSampleGenerator::writeBulkCopyNumber (
   // make sure copy number states have been initialized
   assert ( this->has_cn_states );
 
-  typedef interval_map<TCoord, seqio::AlleleSpecCopyNum> TCnMap;
-
   // loop over samples
   for (auto & id_smp : this->m_samples) {
     string id_sample = id_smp.first;
-    map<string, TCnMap> map_chr_cn = id_smp.second.m_chr_cn;
+    const map<string, seqio::CopyNumberProfile>& map_chr_cn = id_smp.second.m_chr_cn;
 
     // create BED file for sample
     path fn_bed = path_out / format("%s.cn.bed", id_sample.c_str());
     std::ofstream ofs_bed(fn_bed.string(), std::ofstream::out);
 
     // write genomic intervals and CN state to BED file
-    for (auto const & chr_seg : map_chr_cn) {
-      string id_chr = chr_seg.first;
-      interval_map<TCoord, seqio::AlleleSpecCopyNum> imap_reg_cn = chr_seg.second;
-      for (auto const & reg_cn : imap_reg_cn) {
-        TCoord ref_start, ref_end;
-        auto reg = reg_cn.first;
-        ref_start = reg.lower();
-        ref_end = reg.upper();
-        seqio::AlleleSpecCopyNum cn_state = reg_cn.second;
+    for (auto const & chr_cn : map_chr_cn) {
+      string id_chr = chr_cn.first;
+      const seqio::CopyNumberProfile& cn = chr_cn.second;
+      for (size_t i = 0; i < cn.numIntervals(); ++i) {
+        if (!cn.isCovered(i)) continue;
         ofs_bed << format("%s\t%lu\t%lu\t%0.2f\t%0.2f\n", 
-          id_chr.c_str(), ref_start, ref_end, cn_state.count_A, cn_state.count_B);
+          id_chr.c_str(), cn.m_bkp[i], cn.m_bkp[i+1], cn.m_count_A[i], cn.m_count_B[i]);
       }
     }
   }
@@ -894,6 +879,8 @@ BulkSampleGenerator::transformBamTileSeg (
 
   // get SegmentCopy map for clone
   auto it_clone_chr_seg = m_map_clone_chr_seg.find(id_clone);
+  // SNVs indexed by position
+  const vario::VariantTable& tbl_snv = var_store.tbl_snv;
 
   // get global ref seq IDs
   auto context_out = context(bam_out);
@@ -999,13 +986,14 @@ BulkSampleGenerator::transformBamTileSeg (
 
     // spike in mutations
     string chr(toCString(contigNames(context_out)[rid_new]));
-    map<TCoord, vector<int>> map_pos_var = var_store.map_chr_pos_snvs.at(chr);
-    seqio::TSegMap segments = it_clone_chr_seg->second[chr];
+    static const seqio::SegmentIndex idx_empty;
+    auto it_chr_seg = it_clone_chr_seg->second.find(chr);
+    const seqio::SegmentIndex& segments = (it_chr_seg != it_clone_chr_seg->second.end()) ? it_chr_seg->second : idx_empty;
 
     //--- MUTATE READ PAIR (BEGIN) ---
     // Code copied from mutateReadPairSeg() for increased runtime performance. 
 
-    SegmentCopy seg(0);
+    SegmentCopy seg;
   
     // determine read pair coordinates
     TCoord pos_begin, pos_end;
@@ -1019,19 +1007,14 @@ BulkSampleGenerator::transformBamTileSeg (
     }
   
     // increase read count for variants overlapping read pair.
-    for (auto it = map_pos_var.lower_bound(pos_begin); 
-         it != map_pos_var.end() && it->first <= pos_end;
-         ++it)
-    {
-      if ( it->first >= r1_begin && it->first < r1_end ) { // read1 overlaps with variant
-        for ( int v : it->second ) {
-          map_var_cvg[var_store.map_id_snv.at(v).id]++;
-        }
+    auto p_rows = tbl_snv.getRowsInRange(chr, pos_begin, pos_end+1);
+    for (const vario::VariantTable::TRow* p_row = p_rows.first; p_row != p_rows.second; ++p_row) {
+      TCoord pos_var = tbl_snv.pos(*p_row);
+      if ( pos_var >= r1_begin && pos_var < r1_end ) { // read1 overlaps with variant
+        map_var_cvg[tbl_snv.label(*p_row)]++;
       }
-      else if ( it->first >= r2_begin && it->first < r2_end ) { // read1 overlaps with variant
-        for ( int v : it->second ) {
-          map_var_cvg[var_store.map_id_snv.at(v).id]++;
-        }
+      else if ( pos_var >= r2_begin && pos_var < r2_end ) { // read1 overlaps with variant
+        map_var_cvg[tbl_snv.label(*p_row)]++;
       }
     }
 
@@ -1039,61 +1022,39 @@ BulkSampleGenerator::transformBamTileSeg (
     //--------------------------------------
   
     // determine SegmentCopies overlapping with read pair mapping coords
-    seqio::TSegSet iset_read;
-    iset_read.add(interval<TCoord>::right_open(pos_begin, pos_end));
-    seqio::TSegMap imap_seg_avail = segments & iset_read;
-
-    if (imap_seg_avail.size()>0) {
-      // flatten interval map
-      vector<SegmentCopy> vec_seg;
-      for (auto const & itvl_iset : imap_seg_avail) {
-        for (const SegmentCopy & segment : itvl_iset.second)
-          vec_seg.push_back(segment);
-      }
-      seg = selector(vec_seg);
-
-/* fprintf(stderr, "#%s#\t%s\t%s\t%lu\t%lu\t%d\t%d\t%d\t%d\n", 
-  id_clone.c_str(), 
-  boost::uuids::to_string(seg.id).c_str(),
-  toCString(read1.qName), 
-  pos_begin,
-  pos_end,
-  r1_begin, r1_end,
-  r2_begin, r2_end); */
-
+    auto p_seg_ids = segments.getSegmentIds(pos_begin, pos_end);
+    bool has_seg = (p_seg_ids.first != p_seg_ids.second);
+    if (has_seg) {
+      seg.id = *selector(p_seg_ids.first, p_seg_ids.second);
     } 
     else {
       fprintf(stderr, "[WARN] (BulkSampleGenerator::transformBamTile)\n");
       fprintf(stderr, "       No genomic segment copy found for read pair '%s'\n", toCString(read1.qName));
     }
   
-    // 2. Get variants associated with SegmentCopy.
+    // 2. Get variants associated with SegmentCopy (sorted by position).
     //----------------------------------------------
   
-    map<seqio::TCoord, vector<Variant>> map_pos_mut;
-    //var_store.getSnvsForSegmentCopy(map_pos_mut, seg.id);
-    var_store.getSnvsForSegmentCopy(map_pos_mut, seg.id, pos_begin, pos_end);
+    pair<const int*, const int*> p_snvs(nullptr, nullptr);
+    if (has_seg)
+      p_snvs = var_store.getSegmentSnvs(seg.id, pos_begin, pos_end+1);
   
     // 3. Apply variants overlapping read pair.
     //------------------------------------------
   
-    for (auto it = map_pos_mut.lower_bound(pos_begin); 
-         it != map_pos_mut.end() && it->first <= pos_end;
-         ++it)
-    {
-      for (Variant var : it->second) {
+    for (const int* p_id = p_snvs.first; p_id != p_snvs.second; ++p_id) {
+      vario::VariantTable::TRow row = tbl_snv.getRow(*p_id);
   
-        int r1_var_pos = var.pos - r1_begin;
-        if (r1_var_pos >= 0 && r1_var_pos < r1_len) { // read1 overlaps with variant
-          map_var_alt[var.id]++;
-          read1.seq[r1_var_pos] = var.alleles[1][0];
-        }
+      int r1_var_pos = tbl_snv.pos(row) - r1_begin;
+      if (r1_var_pos >= 0 && r1_var_pos < r1_len) { // read1 overlaps with variant
+        map_var_alt[tbl_snv.label(row)]++;
+        read1.seq[r1_var_pos] = tbl_snv.alt(row);
+      }
   
-        int r2_var_pos = var.pos - r2_begin;
-        if (r2_var_pos >= 0 && r2_var_pos < r2_len) { // read2 overlaps with variant
-          map_var_alt[var.id]++;
-          read2.seq[r2_var_pos] = var.alleles[1][0];
-        }
+      int r2_var_pos = tbl_snv.pos(row) - r2_begin;
+      if (r2_var_pos >= 0 && r2_var_pos < r2_len) { // read2 overlaps with variant
+        map_var_alt[tbl_snv.label(row)]++;
+        read2.seq[r2_var_pos] = tbl_snv.alt(row);
       }
     }
 
@@ -1111,8 +1072,8 @@ BulkSampleGenerator::transformBamTileSeg (
     
     // mutateReadPair(read1, read2, it_clone_chr_seg->second[chr], var_store, selector);
     // mutateReadPairVaf(read1, read2,
-    //                   var_store.map_chr_pos_snvs.at(chr),
-    //                   var_store.map_id_snv,
+    //                   var_store.tbl_snv,
+    //                   chr,
     //                   r_dbl,
     //                   r1_begin,
     //                   r2_begin,
@@ -1160,6 +1121,8 @@ BulkSampleGenerator::transformBamTileVaf (
 
   // get SegmentCopy map for clone
   auto it_clone_chr_seg = m_map_clone_chr_seg.find(id_clone);
+  // SNVs indexed by position
+  const vario::VariantTable& tbl_snv = var_store.tbl_snv;
 
   // get global ref seq IDs
   auto context_out = context(bam_out);
@@ -1276,9 +1239,6 @@ auto t_start_10k = chrono::steady_clock::now();
     }
 #endif
 
-    //auto map_pos_snv = var_store.map_chr_pos_snvs.at(chr); 
-    //auto map_id_snv = var_store.map_id_snv;
-    
     // determine read pair coordinates
     TCoord pos_begin, pos_end;
     if (r1_begin < r2_begin) {
@@ -1290,43 +1250,36 @@ auto t_start_10k = chrono::steady_clock::now();
       pos_end   = r1_end;
     }
 
-    // identify first variant larger than read pair start
-    auto it_snv = var_store.map_chr_pos_snvs.at(chr).lower_bound(pos_begin);
-    
-    // loop over candidate variants
-    while ( it_snv != var_store.map_chr_pos_snvs.at(chr).end() && it_snv->first < pos_end ) {
-      seqio::TCoord pos_var = it_snv->first;
-      // each position can be affected by multiple SNVs (relaxing infinite sites assumption)
-      vector<int> vec_snv = it_snv->second;
-      for (int id_snv : vec_snv) {
-        // get variant allele frequency for SNV in this sample
-        double vaf = map_snv_vaf.at(id_snv);
-
-        Variant snv = var_store.map_id_snv.at(id_snv);
-
-        if (pos_var >= r1_begin && pos_var < r1_end) { // variant overlaps read1
-          map_var_cvg[snv.id]++;
-
-          // decide if read pair is to be mutated (with probability VAF)
-          if (r_dbl() <= vaf) {
-            int r1_var_pos = pos_var - r1_begin;
-            read1.seq[r1_var_pos] = snv.alleles[1][0];
-            map_var_alt[snv.id]++;
-          }
-        } 
-        else if (pos_var >= r2_begin && pos_var < r2_end) { // variant overlaps read2
-          map_var_cvg[snv.id]++;
-
-          // decide if read pair is to be mutated (with probability VAF)
-          if (r_dbl() <= vaf) {
-            int r2_var_pos = pos_var - r2_begin;
-            read2.seq[r2_var_pos] = snv.alleles[1][0];
-            map_var_alt[snv.id]++;
-          }
+    // loop over candidate variants (sorted by position)
+    // NOTE: each position can be affected by multiple SNVs (relaxing infinite sites assumption)
+    auto p_rows = tbl_snv.getRowsInRange(chr, pos_begin, pos_end);
+    for (const vario::VariantTable::TRow* p_row = p_rows.first; p_row != p_rows.second; ++p_row) {
+      vario::VariantTable::TRow row = *p_row;
+      seqio::TCoord pos_var = tbl_snv.pos(row);
+      // get variant allele frequency for SNV in this sample
+      double vaf = map_snv_vaf.at(tbl_snv.col_id[row]);
+      const string& id_snv = tbl_snv.label(row);
+
+      if (pos_var >= r1_begin && pos_var < r1_end) { // variant overlaps read1
+        map_var_cvg[id_snv]++;
+
+        // decide if read pair is to be mutated (with probability VAF)
+        if (r_dbl() <= vaf) {
+          int r1_var_pos = pos_var - r1_begin;
+          read1.seq[r1_var_pos] = tbl_snv.alt(row);
+          map_var_alt[id_snv]++;
+        }
+      } 
+      else if (pos_var >= r2_begin && pos_var < r2_end) { // variant overlaps read2
+        map_var_cvg[id_snv]++;
+
+        // decide if read pair is to be mutated (with probability VAF)
+        if (r_dbl() <= vaf) {
+          int r2_var_pos = pos_var - r2_begin;
+          read2.seq[r2_var_pos] = tbl_snv.alt(row);
+          map_var_alt[id_snv]++;
         }
       }
-      // next variable position
-      it_snv++;
     }
 
     // write updated reads to output BAM
@@ -1345,7 +1298,7 @@ fprintf(stderr, "### TIME: %.2f ms for %d read pairs.\n", chrono::duration <doub
 bool BulkSampleGenerator::mutateReadPairSeg (
   BamAlignmentRecord& read1, 
   BamAlignmentRecord& read2,
-  const seqio::TSegMap& segments,
+  const seqio::SegmentIndex& segments,
   const vario::VariantStore& var_store,
   random_selector<>& selector
 )
@@ -1373,55 +1326,38 @@ bool BulkSampleGenerator::mutateReadPairSeg (
   //--------------------------------------
 
   // determine SegmentCopies overlapping with read pair mapping coords
-  seqio::TSegSet iset_read;
-  iset_read.add(interval<TCoord>::right_open(pos_begin, pos_end));
-  seqio::TSegMap imap_seg_avail = segments & iset_read;
-  //SegmentCopy seg = selector(imap_seg_avail);
-  if (imap_seg_avail.size()>0) {
-    // flatten interval map
-    vector<SegmentCopy> vec_seg;
-    for (auto const & itvl_iset : imap_seg_avail) {
-      for (const SegmentCopy & segment : itvl_iset.second)
-        vec_seg.push_back(segment);
-    }
-    seg = selector(vec_seg);
+  auto p_seg_ids = segments.getSegmentIds(pos_begin, pos_end);
+  bool has_seg = (p_seg_ids.first != p_seg_ids.second);
+  if (has_seg) {
+    seg.id = *selector(p_seg_ids.first, p_seg_ids.second);
   } 
   else {
     fprintf(stderr, "[WARN] (BulkSampleGenerator::transformBamTile)\n");
     fprintf(stderr, "       No genomic segment copy found for read pair '%s'\n", toCString(read1.qName));
   }
 
-  // 2. Get variants associated with SegmentCopy.
+  // 2. Get variants associated with SegmentCopy (sorted by position).
   //----------------------------------------------
 
-  map<seqio::TCoord, vector<Variant>> map_pos_var;
-  //var_store.getSnvsForSegmentCopy(map_pos_var, seg.id);
-  var_store.getSnvsForSegmentCopy(map_pos_var, seg.id, r1_begin, r2_end);
+  pair<const int*, const int*> p_snvs(nullptr, nullptr);
+  if (has_seg)
+    p_snvs = var_store.getSegmentSnvs(seg.id, max(TCoord(r1_begin), pos_begin), min(TCoord(r2_end), pos_end)+1);
 
   // 3. Apply variants overlapping read pair.
   //------------------------------------------
 
-  for (auto it = map_pos_var.lower_bound(pos_begin); 
-       it != map_pos_var.end() && it->first <= pos_end;
-       ++it)
-  {
-    for (Variant var : it->second) {
+  const vario::VariantTable& tbl_snv = var_store.tbl_snv;
+  for (const int* p_id = p_snvs.first; p_id != p_snvs.second; ++p_id) {
+    vario::VariantTable::TRow row = tbl_snv.getRow(*p_id);
 
-      int r1_var_pos = var.pos - r1_begin;
-      if (r1_var_pos >= 0 && r1_var_pos < r1_len) { // read1 overlaps with variant
-        //map_var_cvg[var.id]++;
-        //map_var_vaf[var.id]++;
-        //fs_log << str(boost::format("%s:%d\t%s->%s\n") % toCString(read1.qName) % r1_var_pos % var.alleles[0].c_str() % var.alleles[1].c_str());
-        read1.seq[r1_var_pos] = var.alleles[1][0];
-      }
+    int r1_var_pos = tbl_snv.pos(row) - r1_begin;
+    if (r1_var_pos >= 0 && r1_var_pos < r1_len) { // read1 overlaps with variant
+      read1.seq[r1_var_pos] = tbl_snv.alt(row);
+    }
 
-      int r2_var_pos = var.pos - r2_begin;
-      if (r2_var_pos >= 0 && r2_var_pos < r2_len) { // read2 overlaps with variant
-        //map_var_cvg[var.id]++;
-        //map_var_vaf[var.id]++;
-        //fs_log << str(boost::format("%s:%d\t%s->%s\n") % toCString(read2.qName) % r2_var_pos % var.alleles[0].c_str() % var.alleles[1].c_str());
-        read2.seq[r2_var_pos] = var.alleles[1][0];
-      }
+    int r2_var_pos = tbl_snv.pos(row) - r2_begin;
+    if (r2_var_pos >= 0 && r2_var_pos < r2_len) { // read2 overlaps with variant
+      read2.seq[r2_var_pos] = tbl_snv.alt(row);
     }
   }
 
@@ -1431,8 +1367,8 @@ bool BulkSampleGenerator::mutateReadPairSeg (
 bool BulkSampleGenerator::mutateReadPairVaf (
   BamAlignmentRecord& read1, 
   BamAlignmentRecord& read2,
-  const map<seqio::TCoord, vector<int>>& map_pos_snv,
-  const map<int, vario::Variant>& map_id_snv,
+  const vario::VariantTable& tbl_snv,
+  const string& chr,
   const map<int, double>& map_snv_vaf,
   function<double()>& r_dbl,
   const int r1_begin,
@@ -1452,34 +1388,25 @@ bool BulkSampleGenerator::mutateReadPairVaf (
     pos_end   = r1_end;
   }
 
-  // identify first variant larger than read pair start
-  auto it_snv = map_pos_snv.lower_bound(pos_begin);
-  
-  // loop over candidate variants
-  while ( it_snv != map_pos_snv.end() && it_snv->first < pos_end ) {
-    seqio::TCoord pos_var = it_snv->first;
-    // each position can be affected by multiple SNVs (relaxing infinite sites assumption)
-    vector<int> vec_snv = it_snv->second;
-    for (int id_snv : vec_snv) {
-      // get variant allele frequency for SNV in this sample
-      double vaf = map_snv_vaf.at(id_snv);
-
-      // decide if read pair is to be mutated (with probability VAF)
-      if (r_dbl() > vaf) continue;
+  // loop over candidate variants (sorted by position)
+  // NOTE: each position can be affected by multiple SNVs (relaxing infinite sites assumption)
+  auto p_rows = tbl_snv.getRowsInRange(chr, pos_begin, pos_end);
+  for (const vario::VariantTable::TRow* p_row = p_rows.first; p_row != p_rows.second; ++p_row) {
+    seqio::TCoord pos_var = tbl_snv.pos(*p_row);
+    // get variant allele frequency for SNV in this sample
+    double vaf = map_snv_vaf.at(tbl_snv.col_id[*p_row]);
 
-      Variant snv = map_id_snv.at(id_snv);
+    // decide if read pair is to be mutated (with probability VAF)
+    if (r_dbl() > vaf) continue;
 
-      if (pos_var >= r1_begin && pos_var < r1_end) { // mutate read1
-        int r1_var_pos = pos_var - r1_begin;
-        read1.seq[r1_var_pos] = snv.alleles[1][0];
-      } 
-      else if (pos_var >= r2_begin && pos_var < r2_end) { // mutate read2
-        int r2_var_pos = pos_var - r2_begin;
-        read2.seq[r2_var_pos] = snv.alleles[1][0];
-      }
+    if (pos_var >= r1_begin && pos_var < r1_end) { // mutate read1
+      int r1_var_pos = pos_var - r1_begin;
+      read1.seq[r1_var_pos] = tbl_snv.alt(*p_row);
+    } 
+    else if (pos_var >= r2_begin && pos_var < r2_end) { // mutate read2
+      int r2_var_pos = pos_var - r2_begin;
+      read2.seq[r2_var_pos] = tbl_snv.alt(*p_row);
     }
-    // next variable position
-    it_snv++;
   }
   
   return true;
@@ -1503,12 +1430,12 @@ BulkSampleGenerator::writeExpectedReadCounts (
     double vaf = snv_vaf.second;
 
     // get SNV details
-    Variant var = var_store.map_id_snv.at(id_snv);
+    vario::VariantTable::TRow row = var_store.tbl_snv.getRow(id_snv);
     
     // write output to file
     ofs_out << id_snv << ",";
-    ofs_out << var.chr << ",";
-    ofs_out << var.pos << ",";
+    ofs_out << var_store.tbl_snv.chr(row) << ",";
+    ofs_out << var_store.tbl_snv.pos(row) << ",";
     ofs_out << vaf << endl;
   }
 }
@@ -1516,17 +1443,18 @@ BulkSampleGenerator::writeExpectedReadCounts (
 /** NOTE: Requires that initCloneGenomes() has been called before! */
 void
 BulkSampleGenerator::writeFastaTiled (
-  const string lbl_clone,
-  const map<seqio::TRegion, seqio::AlleleSpecCopyNum> map_reg_cn,
+  const string& lbl_clone,
+  const map<seqio::TRegion, seqio::AlleleSpecCopyNum>& map_reg_cn,
   const TCoord padding,
   const TCoord min_len,
-  const path path_fasta) 
+  const path& path_fasta) 
 {
   int line_width = 60; // TODO: should this be a parameter?
-  string str_pad(padding, 'A');
+  // views of reference sequences (reused for all regions)
+  vector<seqio::SeqView> views;
 
   // keep track of sequence lengths in genomic tiles
-  map<int, unsigned long long> map_cn_len;
+  map<int, TCoord> map_cn_len;
   // keep track of number of sequences per CN state
   map<int, unsigned> map_cn_nseq;
 
@@ -1557,17 +1485,13 @@ BulkSampleGenerator::writeFastaTiled (
     }
     shared_ptr<std::ofstream> ofs = map_cn_file[cn_total];
 
-    // get sequence for target region from reference genome
-    map<TCoord, string> map_start_seq;
-    this->m_ref_genome->getSequence(chr, start, end, map_start_seq);
-    vector<shared_ptr<SeqRecord>> sequences;
-    for (auto const & start_seq : map_start_seq) {
-      TCoord start = start_seq.first;
-      string seq = start_seq.second;
-      TCoord end = start + seq.length();
+    // stream sequence for target region from reference genome
+    this->m_ref_genome->getSequenceViews(chr, start, end, views);
+    for (auto const & view : views) {
+      TCoord start = view.pos_chr;
+      TCoord end = start + view.length();
       string id_rec = format("%s_%lu_%lu_%u", chr.c_str(), start, end, padding);
-      shared_ptr<SeqRecord> rec(new SeqRecord(id_rec, "", str_pad+seq+str_pad));
-      sequences.push_back(rec);
+      seqio::writeFastaRecord(id_rec, view, *ofs, padding, 'A', line_width);
 
       // add fragment length to CN->len index
       if (map_cn_len.count(cn_total) == 0) {
@@ -1578,8 +1502,6 @@ BulkSampleGenerator::writeFastaTiled (
         map_cn_nseq[cn_total] += 1;
       }
     }
-    
-    writeFasta(sequences, *ofs, line_width);
   }
 
   // close output file streams
@@ -1595,10 +1517,10 @@ BulkSampleGenerator::writeFastaTiled (
   // 1.a) no. sequences by CN
   // 1.b) seq length by CN 
   // 1.c) total seq length by clone
-  unsigned long long genome_len = 0;
+  TCoord genome_len = 0;
   for (auto const & cn_len : map_cn_len) {
     int cn_state = cn_len.first;
-    unsigned long long seq_len = cn_len.second;
+    TCoord seq_len = cn_len.second;
     unsigned num_seqs = map_cn_nseq[cn_state];
 
     // update FASTA file indices
@@ -1684,7 +1606,7 @@ BulkSampleGenerator::writeFastaTiledBak (
   }
 
   // keep track of sequence lengths in genomic tiles
-  map<int, unsigned long long> map_cn_len;
+  map<int, TCoord> map_cn_len;
   // keep track of number of sequences per CN state
   map<int, unsigned> map_cn_nseq;
 
@@ -1718,10 +1640,10 @@ BulkSampleGenerator::writeFastaTiledBak (
   // 1.a) no. sequences by CN
   // 1.b) seq length by CN 
   // 1.c) total seq length by clone
-  unsigned long long genome_len = 0;
+  TCoord genome_len = 0;
   for (auto const & cn_len : map_cn_len) {
     int cn_state = cn_len.first;
-    unsigned long long seq_len = cn_len.second;
+    TCoord seq_len = cn_len.second;
     unsigned num_seqs = map_cn_nseq[cn_state];
 
     // update FASTA file indices
@@ -1735,31 +1657,25 @@ BulkSampleGenerator::writeFastaTiledBak (
   this->m_map_clone_len[lbl_clone] = genome_len;
 
   // 2. genomic segments by clone and chromosome
-  map<string, seqio::TSegMap> map_chr_seg;
+  map<string, seqio::SegmentIndex>& map_chr_seg = this->m_map_clone_chr_seg[lbl_clone];
   for (auto const & id_ci : genome.map_id_chr) {
-    seqio::TSegMap imap_seg;
-    for (auto const & ci : id_ci.second) {
-      for (auto const & seg : ci->lst_segments) {
-        TCoord c1 = seg.ref_start;
-        TCoord c2 = seg.ref_end;
-        std::set<SegmentCopy> segset({seg});
-        imap_seg += make_pair(interval<TCoord>::right_open(c1,c2), segset);
-      }
-    }
-    map_chr_seg[id_ci.first] = imap_seg;
+    vector<SegmentCopy> vec_seg;
+    for (auto const & ci : id_ci.second)
+      vec_seg.insert(vec_seg.end(), ci->segments.begin(), ci->segments.end());
+    map_chr_seg[id_ci.first].build(vec_seg);
   }
 // DEBUG output
 cerr << "genomic segment index for clone " << lbl_clone << endl;
 for (auto const & kv : map_chr_seg) {
   cerr << "  " << kv.first << endl;
-  for (auto const & iseg : kv.second) {
-    fprintf(stderr, "    [%lu,%lu)\n", iseg.first.lower(), iseg.first.upper());
-    for (auto const & s : iseg.second) {
-      fprintf(stderr, "    %s [%lu,%lu)\n", boost::uuids::to_string(s.id).c_str(), s.ref_start, s.ref_end);
+  const seqio::SegmentIndex& idx_seg = kv.second;
+  for (size_t i = 0; i < idx_seg.numIntervals(); ++i) {
+    fprintf(stderr, "    [%lu,%lu)\n", idx_seg.m_bkp[i], idx_seg.m_bkp[i+1]);
+    for (size_t j = idx_seg.m_offset[i]; j < idx_seg.m_offset[i+1]; ++j) {
+      fprintf(stderr, "    %lu\n", idx_seg.m_ids[j]);
     }
   }
 }
-  this->m_map_clone_chr_seg[lbl_clone] = map_chr_seg;
 }
 
 } /* namespace bamio */
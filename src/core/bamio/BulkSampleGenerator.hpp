@@ -3,6 +3,7 @@
 
 #include "../bamio.hpp"
 #include "BulkSample.hpp"
+#include "../seqio/SegmentIndex.hpp"
 #include "../seqio/types.hpp"
 #include "../vario/VariantStore.hpp"
 
@@ -40,12 +41,14 @@ private:
   seqio::TCoord m_ref_len;
   /** The set of reference sequences to be included in output header. */
   std::map<std::string, seqio::TCoord> m_map_ref_len;
+  /** Copy number profiles for each clone and chromosome (rebuilt by initCloneGenomes()). */
+  std::map<std::string, std::map<std::string, seqio::CopyNumberProfile>> m_map_clone_chr_cn;
   /** Index of genomic segments for each clone and chromosome. */
-  std::map<std::string, std::map<std::string, seqio::TSegMap>> m_map_clone_chr_seg;
+  std::map<std::string, std::map<std::string, seqio::SegmentIndex>> m_map_clone_chr_seg;
   /** Total lengths of clone genomes (sum of SegmentCopies + padding) */
-  std::map<std::string, unsigned long long> m_map_clone_len;
+  std::map<std::string, seqio::TCoord> m_map_clone_len;
   /** Filenames of reference FASTA files, along with seq length, for each clone. */
-  std::map<boost::filesystem::path, unsigned long long> m_map_fasta_len;
+  std::map<boost::filesystem::path, seqio::TCoord> m_map_fasta_len;
   /** Stores for each FASTA file the number of contained sequences. */
   std::map<boost::filesystem::path, unsigned> m_map_fasta_nseq;
   /** Allele counts of SNVs indexed by clone, SNV id. */
@@ -144,7 +147,7 @@ public:
    */
   void
   initCloneGenomes (
-    const std::map<std::string, seqio::GenomeInstance> map_lbl_gi,
+    const std::map<std::string, seqio::GenomeInstance>& map_lbl_gi,
     //const seqio::GenomeReference reference,
     //unsigned padding,
     //unsigned min_len,
@@ -308,7 +311,7 @@ public:
     *  
     * \param read1      First read in pair.
     * \param read2      Second read in pair.
-    * \param segments   Interval map of genomic SegmentCopies.
+    * \param segments   Index of genomic SegmentCopies by reference position.
     * \param var_store  VariantStore providing Variants-to-SegmentCopy mapping.
     * \param selector   Random selector (pick random collection element).
     * \returns          True on success, false on error.
@@ -317,7 +320,7 @@ public:
   mutateReadPairSeg (
     seqan::BamAlignmentRecord& read1, 
     seqan::BamAlignmentRecord& read2,
-    const seqio::TSegMap& segments,
+    const seqio::SegmentIndex& segments,
     const vario::VariantStore& var_store,
     random_selector<>& selector
   );
@@ -328,8 +331,8 @@ public:
     *  
     * \param read1       First read in pair.
     * \param read2       Second read in pair.
-    * \param map_pos_snv SNV ids indexed by position (for quick lookup).
-    * \param map_id_snv  SNV Variant objects indexed by id.
+    * \param tbl_snv     SNVs (indexed by position for quick lookup).
+    * \param chr         Chromosome the read pair maps to.
     * \param map_snv_vaf Variant allele frequency of SNVs in this sample.
     * \param r_dbl       Random function (value decides if read receives mutation).
     * \param r1_begin    Start coordinate of read1.
@@ -342,8 +345,8 @@ public:
   mutateReadPairVaf (
     seqan::BamAlignmentRecord& read1, 
     seqan::BamAlignmentRecord& read2,
-    const std::map<seqio::TCoord, std::vector<int>>& map_pos_snv,
-    const std::map<int, vario::Variant>& map_id_snv,
+    const vario::VariantTable& tbl_snv,
+    const std::string& chr,
     const std::map<int, double>& map_snv_vaf,
     std::function<double()>& r_dbl,
     const int r1_begin,
@@ -380,12 +383,12 @@ public:
     */
   void
   writeCloneGenomes (
-    const std::map<std::string, seqio::GenomeInstance> map_lbl_gi,
-    const seqio::GenomeReference reference,
+    const std::map<std::string, seqio::GenomeInstance>& map_lbl_gi,
+    const seqio::GenomeReference& reference,
     unsigned padding,
     unsigned min_len,
-    const boost::filesystem::path path_fasta,
-    const boost::filesystem::path path_bed
+    const boost::filesystem::path& path_fasta,
+    const boost::filesystem::path& path_bed
   );
 
   /** Stores absolute copy number (CN) states for each bulk sample in internal index map.
@@ -397,7 +400,7 @@ public:
   bool
   calculateBulkCopyNumber (
     //const std::map<std::string, std::map<std::string, double>> mtx_sample,
-    const std::map<std::string, seqio::GenomeInstance> map_lbl_gi
+    const std::map<std::string, seqio::GenomeInstance>& map_lbl_gi
   );
 
   /** 
@@ -416,13 +419,18 @@ public:
     const boost::filesystem::path path_out
   ) const;
 
+  /** Write genomic tiles of a clone genome to FASTA files (one for each total CN state).
+    * Sequences are streamed from the reference genome, memory use does not depend on tile length.
+    *
+    * NOTE: Requires that initCloneGenomes() has been called before!
+    */
   void
   writeFastaTiled (
-    const std::string lbl_clone,
-    const std::map<seqio::TRegion, seqio::AlleleSpecCopyNum> map_reg_cn,
+    const std::string& lbl_clone,
+    const std::map<seqio::TRegion, seqio::AlleleSpecCopyNum>& map_reg_cn,
     const seqio::TCoord padding,
     const seqio::TCoord min_len,
-    const boost::filesystem::path path_fasta
+    const boost::filesystem::path& path_fasta
   );
 
   /** Write genomic sequence of a GenomeInstance to FASTA file(s). 
@@ -50,6 +50,7 @@ bool ConfigStore::parseArgs (int ac, char* av[])
   bool do_reuse_reads = false;
   bool do_fq_out = true;
   bool do_sam_out = true;
+  bool do_hap_out = false;
   int verb = 1;
   long seed = time(NULL) + clock();
 
@@ -289,6 +290,11 @@ bool ConfigStore::parseArgs (int ac, char* av[])
       _config["seq-sam-out"] = do_sam_out;
   }
   do_fq_out = _config["seq-sam-out"].as<bool>();
+  // bit to indicate if clone haplotypes should be written to FASTA files
+  if (!_config["seq-hap-out"]) {
+      _config["seq-hap-out"] = do_hap_out;
+  }
+  do_hap_out = _config["seq-hap-out"].as<bool>();
   // when generating read counts, minimum ALT read count for which to output a VCF line
   if (!_config["seq-rc-min"]) {
     _config["seq-rc-min"] = seq_rc_min;
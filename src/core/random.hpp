@@ -6,6 +6,7 @@
 #include <algorithm> // std::sort()
 #include <cassert>
 #include <cmath> // pow()
+#include <cstdint>
 #include <functional> // std::function<>, std::bind(), std::ref()
 #include <random>
 #include <vector>
@@ -30,6 +31,24 @@ struct RandomNumberGenerator {
     generator.seed(seed);
   }
 
+  /** Initialize generator on one of multiple independent streams. */
+  RandomNumberGenerator(uint64_t seed, uint64_t stream) {
+    generator.seed(seed, stream);
+  }
+
+  /** Draw a seed for deriving independent streams (cf. RandomNumberGenerator(seed, stream)). */
+  uint64_t getStreamSeed() {
+    uint64_t hi = generator();
+    return (hi << 32) | generator();
+  }
+
+  /** Draw a random index in [0, n) (advances generator). */
+  size_t getRandomIndex(const size_t n) {
+    assert( n > 0 );
+    std::uniform_int_distribution<size_t> dist(0, n - 1);
+    return dist(generator);
+  }
+
   template <typename RealType = double>
   std::function<RealType()> 
   getRandomFunctionReal (
@@ -302,6 +321,67 @@ struct RandomNumberGenerator {
   }
 };
 
+/**
+ * Samples indices from a discrete distribution in constant time
+ * (Walker's alias method, built using Vose's algorithm).
+ */
+struct AliasTable
+{
+	/** acceptance thresholds (scaled to 32-bit random numbers) */
+	std::vector<uint64_t> m_thresh;
+	/** alternative index for each column */
+	std::vector<uint32_t> m_alias;
+
+	AliasTable() {}
+
+	/** Build table for a set of (unnormalized) weights. */
+	AliasTable(const std::vector<double>& weights) {
+		size_t n = weights.size();
+		assert( n > 0 );
+		m_thresh.assign(n, uint64_t(1) << 32);
+		m_alias.resize(n);
+		double sum = 0.0;
+		for (double w : weights)
+			sum += w;
+		for (size_t i = 0; i < n; ++i)
+			m_alias[i] = i;
+		if (sum <= 0.0) // no information: uniform distribution
+			return;
+
+		// scale probabilities to mean 1, split into small and large columns
+		std::vector<double> p(n);
+		std::vector<uint32_t> small, large;
+		for (size_t i = 0; i < n; ++i) {
+			p[i] = weights[i] * n / sum;
+			(p[i] < 1.0 ? small : large).push_back(i);
+		}
+		// fill each small column with the excess of a large one
+		while (!small.empty() && !large.empty()) {
+			uint32_t s = small.back(); small.pop_back();
+			uint32_t l = large.back();
+			m_thresh[s] = uint64_t(p[s] * 4294967296.0);
+			m_alias[s] = l;
+			p[l] -= (1.0 - p[s]);
+			if (p[l] < 1.0) {
+				large.pop_back();
+				small.push_back(l);
+			}
+		}
+		// remaining columns are full (up to rounding errors)
+	}
+
+	/** Number of outcomes. */
+	size_t size() const { return m_alias.size(); }
+
+	/** Draw a random index (requires a generator with 32-bit output, e.g. pcg32). */
+	template <typename RandomGenerator>
+	uint32_t sample(RandomGenerator& gen) const {
+		static_assert( sizeof(typename RandomGenerator::result_type) == 4, "32-bit generator required" );
+		uint32_t i = (uint64_t(gen()) * m_alias.size()) >> 32;
+		return (gen() < m_thresh[i]) ? i : m_alias[i];
+	}
+};
+
 /** Selects random element from container */
 template <typename RandomGenerator = base_generator_type>
 struct random_selector
@@ -320,6 +400,13 @@ struct random_selector
 		return start;
 	}
 
+	// pick a random index in [0, n)
+	size_t index(size_t n) {
+		assert( n > 0 );
+		std::uniform_int_distribution<size_t> dist(0, n - 1);
+		return dist(_gen);
+	}
+
 	//convenience function
 	template <typename Iter>
 	Iter operator()(Iter start, Iter end) {
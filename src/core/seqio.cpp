@@ -1,6 +1,10 @@
 #include "seqio.hpp"
 #include <cctype>
 #include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <initializer_list>
+#include <sys/stat.h>
 
 using namespace std;
 
@@ -10,14 +14,25 @@ namespace seqio {
 /*           Utility methods          */
 /*------------------------------------*/
 
-void readFasta(const char *filename, vector<shared_ptr<SeqRecord>> &records) {
+/** Sets SeqRecord properties encoded in its description (e.g. "id_ref=chr1"). */
+static void parseDescription(SeqRecord& rec) {
+  vector<string> desc_parts = stringio::split(rec.description, ';');
+  for (string part : desc_parts) {
+    vector<string> kv = stringio::split(part, '=');
+    if (kv.size() == 2)
+      if (kv[0] == "id_ref")
+        rec.id_ref = kv[1];
+  }
+}
+
+void readFasta(const char *filename, vector<shared_ptr<SeqRecord>> &records, const bool pack) {
   ifstream inputFile;
   inputFile.open(filename, ios::in);
-  readFasta(inputFile, records);
+  readFasta(inputFile, records, pack);
   inputFile.close();
 }
 
-void readFasta(istream &input, vector<shared_ptr<SeqRecord>> &records) {
+void readFasta(istream &input, vector<shared_ptr<SeqRecord>> &records, const bool pack) {
   string header;
   string seq;
   string line;
@@ -36,13 +51,9 @@ void readFasta(istream &input, vector<shared_ptr<SeqRecord>> &records) {
       //SeqRecord rec = {seq_id, seq_desc, seq};
       shared_ptr<SeqRecord> sp_rec(new SeqRecord(seq_id, seq_desc, seq));
       // get properties from description
-      vector<string> desc_parts = stringio::split(seq_desc, ';');
-      for (string part : desc_parts) {
-        vector<string> kv = stringio::split(part, '=');
-        if (kv.size() == 2)
-          if (kv[0] == "id_ref")
-            sp_rec->id_ref = kv[1];
-      }
+      parseDescription(*sp_rec);
+      if (pack)
+        sp_rec->pack();
       records.push_back(sp_rec);
       header = line;
       seq = "";
@@ -79,22 +90,448 @@ int writeFasta(
     // seq description confuses ART (mismatch of SAM header with REF field)
     //output << str(boost::format(">%s id_ref=%s\n") % rec.id % rec.id_ref);
     output << stringio::format(">%s\n", rec->id.c_str()).c_str();
-    string::const_iterator it_seq = rec->seq.begin();
-    while (it_seq != rec->seq.end()) {
-      for (int i=0; i<line_width && it_seq!=rec->seq.end(); ++i)
-        output << *it_seq++;
-      output << endl;
+    string line;
+    for (TCoord pos=0; pos<rec->length(); pos+=line_width) {
+      rec->getSubSeq(pos, line_width, line);
+      output << line << '\n';
     }
     recCount++;
   }
   return recCount;
 }
 
-void indexFasta(const char *filename) {
-  // TODO: implement this function
-  string fn(filename);
-  string cmd = "samtools faidx " + fn;
-  system(cmd.c_str());
+/** Number of FASTA lines buffered by writeFastaRecord(). */
+static const size_t FASTA_BUF_LINES = 1024;
+
+void writeFastaRecord(
+  const string& id,
+  const SeqView& view,
+  ostream& output,
+  const TCoord padding,
+  const char chr_pad,
+  int line_width)
+{
+  output << stringio::format(">%s\n", id.c_str()).c_str();
+
+  // record consists of three parts: padding, sequence, padding
+  const TCoord len_rec = 2*padding + view.length();
+  const size_t len_buf = FASTA_BUF_LINES * (line_width+1);
+  vector<char> buf(len_buf);
+  size_t pos_buf = 0;
+  TCoord pos_rec = 0;
+  while (pos_rec < len_rec) {
+    // fill current line
+    TCoord len_line = min(TCoord(line_width), len_rec - pos_rec);
+    TCoord end_line = pos_rec + len_line;
+    while (pos_rec < end_line) {
+      TCoord n;
+      if (pos_rec < padding) {
+        n = min(end_line, padding) - pos_rec;
+        fill_n(&buf[pos_buf], n, chr_pad);
+      } else if (pos_rec < padding + view.length()) {
+        n = view.copy(pos_rec - padding, end_line - pos_rec, &buf[pos_buf]);
+      } else {
+        n = end_line - pos_rec;
+        fill_n(&buf[pos_buf], n, chr_pad);
+      }
+      pos_buf += n;
+      pos_rec += n;
+    }
+    buf[pos_buf++] = '\n';
+    // flush buffer if next line might not fit
+    if (pos_buf + line_width + 1 > len_buf) {
+      output.write(buf.data(), pos_buf);
+      pos_buf = 0;
+    }
+  }
+  output.write(buf.data(), pos_buf);
+}
+
+/*------------------------------------*/
+/*       FASTA index (.fai) files     */
+/*------------------------------------*/
+
+/**
+ * Scan a (memory-mapped) FASTA file and generate index entries.
+ * Follows the rules of `samtools faidx`: all sequence lines of a record
+ * need to have the same length, except for the last one.
+ */
+static bool
+buildFastaIndex (
+  const MappedFile& file,
+  vector<FaiRecord>& index
+) {
+  const char* d = file.data;
+  const size_t n = file.size;
+  size_t i = 0;
+  while (i < n) {
+    // find end of current line
+    const char* p_eol = static_cast<const char*>(memchr(d+i, '\n', n-i));
+    size_t e = p_eol ? p_eol - d : n;
+    if (d[i] != '>') {
+      // only blank lines are allowed outside of records
+      if (e - i > 1 || (e - i == 1 && d[i] != '\r')) {
+        fprintf(stderr, "[ERROR] (seqio::indexFasta) '%s': expected FASTA header at byte %lu.\n", file.filename.c_str(), i);
+        return false;
+      }
+      i = e + 1;
+      continue;
+    }
+    // parse header line
+    FaiRecord rec;
+    size_t j = i + 1;
+    while (j < e && !isspace(d[j]))
+      ++j;
+    rec.name = string(d+i+1, j-i-1);
+    i = e + 1;
+    rec.offset = i;
+
+    // parse sequence lines
+    bool is_last_line = false;
+    while (i < n && d[i] != '>') {
+      p_eol = static_cast<const char*>(memchr(d+i, '\n', n-i));
+      e = p_eol ? p_eol - d : n;
+      size_t num_bytes = p_eol ? e - i + 1 : e - i;
+      size_t num_bases = e - i;
+      if (num_bases > 0 && d[e-1] == '\r')
+        num_bases--;
+      i = e + 1;
+      if (num_bases == 0) { // blank line ends sequence
+        is_last_line = true;
+        continue;
+      }
+      if (rec.line_bases == 0) {
+        rec.line_bases = num_bases;
+        rec.line_width = num_bytes;
+      }
+      else if (is_last_line || num_bases > rec.line_bases ||
+               (num_bases == rec.line_bases && p_eol && num_bytes != rec.line_width)) {
+        fprintf(stderr, "[ERROR] (seqio::indexFasta) '%s': different line length in sequence '%s'.\n", file.filename.c_str(), rec.name.c_str());
+        return false;
+      }
+      if (num_bases < rec.line_bases)
+        is_last_line = true;
+      rec.length += num_bases;
+    }
+    index.push_back(rec);
+  }
+
+  return true;
+}
+
+bool indexFasta(const char *filename) {
+  MappedFile file;
+  if (!file.open(filename))
+    return false;
+  vector<FaiRecord> index;
+  if (!buildFastaIndex(file, index))
+    return false;
+  return writeFastaIndex(index, string(filename) + ".fai");
+}
+
+bool readFastaIndex(const char* filename, vector<FaiRecord>& index) {
+  ifstream ifs(filename);
+  if (!ifs.good())
+    return false;
+  string line;
+  while (stringio::safeGetline(ifs, line)) {
+    if (line.length() == 0)
+      continue;
+    vector<string> cols = stringio::split(line, '\t');
+    if (cols.size() < 5) {
+      fprintf(stderr, "[ERROR] (seqio::readFastaIndex) '%s': invalid line '%s'.\n", filename, line.c_str());
+      return false;
+    }
+    FaiRecord rec;
+    rec.name = cols[0];
+    rec.length = stoul(cols[1]);
+    rec.offset = stoull(cols[2]);
+    rec.line_bases = stoul(cols[3]);
+    rec.line_width = stoul(cols[4]);
+    index.push_back(rec);
+  }
+  return true;
+}
+
+bool writeFastaIndex(const vector<FaiRecord>& index, const string filename) {
+  ofstream ofs(filename);
+  if (!ofs.good()) {
+    fprintf(stderr, "[WARN] (seqio::writeFastaIndex) cannot write to file '%s'.\n", filename.c_str());
+    return false;
+  }
+  for (auto const & rec : index) {
+    ofs << rec.name << '\t' << rec.length << '\t' << rec.offset << '\t'
+        << rec.line_bases << '\t' << rec.line_width << '\n';
+  }
+  return ofs.good();
+}
+
+bool
+readFastaMapped (
+  const char* filename,
+  vector<shared_ptr<SeqRecord>>& records
+) {
+  shared_ptr<MappedFile> sp_file = make_shared<MappedFile>();
+  if (!sp_file->open(filename))
+    return false;
+
+  // use existing index if it is up to date, generate it otherwise
+  string fn_fai = string(filename) + ".fai";
+  vector<FaiRecord> index;
+  struct stat st_fa, st_fai;
+  bool has_fai = ( stat(filename, &st_fa) == 0 && stat(fn_fai.c_str(), &st_fai) == 0 &&
+                   st_fai.st_mtime >= st_fa.st_mtime && readFastaIndex(fn_fai.c_str(), index) );
+  if (!has_fai) {
+    index.clear();
+    if (!buildFastaIndex(*sp_file, index))
+      return false;
+    writeFastaIndex(index, fn_fai);
+  }
+
+  for (auto const & fai : index) {
+    // sanity check: index must match FASTA file
+    if ( (fai.offset > sp_file->size) || 
+         (fai.length > 0 && (fai.line_bases == 0 || fai.getOffset(fai.length-1) >= sp_file->size)) ) {
+      fprintf(stderr, "[ERROR] (seqio::readFastaMapped) index '%s' does not match FASTA file.\n", fn_fai.c_str());
+      records.clear();
+      return false;
+    }
+    // recover header line preceding the first base
+    size_t pos_end = fai.offset;
+    while (pos_end > 0 && (sp_file->data[pos_end-1] == '\n' || sp_file->data[pos_end-1] == '\r'))
+      --pos_end;
+    size_t pos_start = pos_end;
+    while (pos_start > 0 && sp_file->data[pos_start-1] != '\n')
+      --pos_start;
+    string header(sp_file->data + pos_start, pos_end - pos_start);
+    size_t space_pos = header.find(' ');
+    string seq_desc = (space_pos == string::npos) ? "" : header.substr(space_pos+1);
+
+    shared_ptr<SeqRecord> sp_rec(new SeqRecord(fai.name, seq_desc, ""));
+    parseDescription(*sp_rec);
+    sp_rec->map(sp_file, fai);
+    records.push_back(sp_rec);
+  }
+
+  return true;
+}
+
+/*------------------------------------*/
+/*          UCSC .2bit format         */
+/*------------------------------------*/
+
+/** Magic number at the start of each .2bit file. */
+static const uint32_t TWOBIT_SIGNATURE = 0x1A412743;
+
+static uint32_t swapBytes32(const uint32_t x) {
+  return (x >> 24) | ((x >> 8) & 0x0000FF00) | ((x << 8) & 0x00FF0000) | (x << 24);
+}
+
+/** 
+ * Lookup tables translating one byte of .2bit packed DNA (4 bases, first
+ * base in highest bits, T=0,C=1,A=2,G=3) into one byte of PackedSequence
+ * codes (4 bases, first base in lowest bits, A=0,C=1,G=2,T=3) and back.
+ */
+struct TwoBitTables {
+  uint8_t decode[256];
+  uint8_t encode[256];
+  TwoBitTables() {
+    const uint8_t from_2bit[4] = { 3, 1, 0, 2 };
+    const uint8_t to_2bit[4]   = { 2, 1, 3, 0 };
+    for (unsigned b=0; b<256; ++b) {
+      decode[b] = from_2bit[(b>>6)&3] | from_2bit[(b>>4)&3]<<2 | from_2bit[(b>>2)&3]<<4 | from_2bit[b&3]<<6;
+      encode[b] = to_2bit[b&3]<<6 | to_2bit[(b>>2)&3]<<4 | to_2bit[(b>>4)&3]<<2 | to_2bit[(b>>6)&3];
+    }
+  }
+};
+
+static const TwoBitTables&
+getTwoBitTables () {
+  static const TwoBitTables tables;
+  return tables;
+}
+
+bool
+readTwoBit (
+  const char* filename,
+  vector<shared_ptr<SeqRecord>>& records
+) {
+  ifstream ifs(filename, ios::in | ios::binary);
+  if (!ifs.good()) {
+    fprintf(stderr, "[ERROR] (seqio::readTwoBit) cannot open file '%s'.\n", filename);
+    return false;
+  }
+
+  bool do_swap = false;
+  auto read32 = [&ifs, &do_swap]() -> uint32_t {
+    uint32_t x = 0;
+    ifs.read(reinterpret_cast<char*>(&x), sizeof(x));
+    return do_swap ? swapBytes32(x) : x;
+  };
+
+  // parse header
+  uint32_t signature = read32();
+  if (signature == swapBytes32(TWOBIT_SIGNATURE)) {
+    do_swap = true;
+  }
+  else if (signature != TWOBIT_SIGNATURE) {
+    fprintf(stderr, "[ERROR] (seqio::readTwoBit) '%s' is not a .2bit file.\n", filename);
+    return false;
+  }
+  uint32_t version = read32();
+  uint32_t num_seqs = read32();
+  read32(); // reserved
+  if (version > 1) {
+    fprintf(stderr, "[ERROR] (seqio::readTwoBit) unsupported .2bit version %u.\n", version);
+    return false;
+  }
+
+  // parse sequence index (version 1 uses 64-bit offsets)
+  vector<pair<string, uint64_t>> vec_name_offset;
+  for (uint32_t i=0; i<num_seqs; ++i) {
+    unsigned char name_len = 0;
+    ifs.read(reinterpret_cast<char*>(&name_len), 1);
+    string name(name_len, ' ');
+    ifs.read(&name[0], name_len);
+    uint64_t offset = read32();
+    if (version == 1) {
+      uint64_t hi = read32();
+      offset = do_swap ? (offset << 32) | hi : offset | (hi << 32);
+    }
+    vec_name_offset.push_back(make_pair(name, offset));
+  }
+  if (!ifs.good()) {
+    fprintf(stderr, "[ERROR] (seqio::readTwoBit) premature end of file '%s'.\n", filename);
+    return false;
+  }
+
+  // parse sequence records
+  const uint8_t* decode = getTwoBitTables().decode;
+  vector<char> buf;
+  for (auto const & name_offset : vec_name_offset) {
+    ifs.seekg(name_offset.second);
+    shared_ptr<SeqRecord> sp_rec(new SeqRecord(name_offset.first, "", ""));
+    PackedSequence& ps = sp_rec->seq_packed;
+    ps.resize(read32());
+    // runs of 'N' and soft-masked runs share the same layout
+    for (auto p_runs : { &ps.n_runs, &ps.mask_runs }) {
+      uint32_t num_blocks = read32();
+      vector<uint32_t> vec_start(num_blocks);
+      for (uint32_t j=0; j<num_blocks; ++j)
+        vec_start[j] = read32();
+      for (uint32_t j=0; j<num_blocks; ++j)
+        p_runs->push_back(PackedSequence::TRun(vec_start[j], read32()));
+    }
+    read32(); // reserved
+    // translate packed DNA, 8 bytes per 64-bit word
+    size_t num_bytes = (ps.length + 3) / 4;
+    buf.resize(num_bytes);
+    ifs.read(buf.data(), num_bytes);
+    if (!ifs.good()) {
+      fprintf(stderr, "[ERROR] (seqio::readTwoBit) premature end of file '%s'.\n", filename);
+      return false;
+    }
+    for (size_t k=0; k<num_bytes; ++k)
+      ps.words[k >> 3] |= uint64_t(decode[uint8_t(buf[k])]) << ((k & 7) << 3);
+    sp_rec->is_packed = true;
+    records.push_back(sp_rec);
+  }
+
+  return true;
+}
+
+bool
+writeTwoBit (
+  const vector<shared_ptr<SeqRecord>>& records,
+  const string filename
+) {
+  // records need to be packed for output
+  vector<const PackedSequence*> vec_packed;
+  vector<PackedSequence> vec_tmp(records.size());
+  for (size_t i=0; i<records.size(); ++i) {
+    const shared_ptr<SeqRecord>& rec = records[i];
+    if (rec->id.length() > 255 || rec->length() > UINT32_MAX) {
+      fprintf(stderr, "[ERROR] (seqio::writeTwoBit) sequence '%s' cannot be stored in .2bit format.\n", rec->id.c_str());
+      return false;
+    }
+    if (rec->is_packed) {
+      vec_packed.push_back(&rec->seq_packed);
+    }
+    else {
+      string seq;
+      rec->getSubSeq(0, rec->length(), seq);
+      vec_tmp[i].assign(seq);
+      vec_packed.push_back(&vec_tmp[i]);
+    }
+  }
+
+  // calculate record offsets, switch to 64-bit offsets if needed (version 1)
+  uint64_t len_idx = 0;
+  for (auto const & rec : records)
+    len_idx += 1 + rec->id.length() + sizeof(uint32_t);
+  vector<uint64_t> vec_offset;
+  uint64_t offset = 4*sizeof(uint32_t) + len_idx;
+  for (auto p_seq : vec_packed) {
+    vec_offset.push_back(offset);
+    offset += sizeof(uint32_t)*(4 + 2*p_seq->n_runs.size() + 2*p_seq->mask_runs.size());
+    offset += (p_seq->length + 3) / 4;
+  }
+  uint32_t version = 0;
+  if (offset > UINT32_MAX) {
+    version = 1;
+    // each index entry grows by 4 bytes
+    for (size_t i=0; i<vec_offset.size(); ++i)
+      vec_offset[i] += records.size() * sizeof(uint32_t);
+  }
+
+  ofstream ofs(filename, ios::out | ios::binary);
+  if (!ofs.good()) {
+    fprintf(stderr, "[ERROR] (seqio::writeTwoBit) cannot open file '%s'.\n", filename.c_str());
+    return false;
+  }
+  auto write32 = [&ofs](const uint32_t x) {
+    ofs.write(reinterpret_cast<const char*>(&x), sizeof(x));
+  };
+
+  // write header and index
+  write32(TWOBIT_SIGNATURE);
+  write32(version);
+  write32(records.size());
+  write32(0); // reserved
+  for (size_t i=0; i<records.size(); ++i) {
+    unsigned char name_len = records[i]->id.length();
+    ofs.write(reinterpret_cast<const char*>(&name_len), 1);
+    ofs.write(records[i]->id.data(), name_len);
+    write32(vec_offset[i] & 0xFFFFFFFF);
+    if (version == 1)
+      write32(vec_offset[i] >> 32);
+  }
+
+  // write sequence records
+  const uint8_t* encode = getTwoBitTables().encode;
+  vector<char> buf;
+  for (auto p_seq : vec_packed) {
+    write32(p_seq->length);
+    for (auto p_runs : { &p_seq->n_runs, &p_seq->mask_runs }) {
+      write32(p_runs->size());
+      for (auto const & run : *p_runs)
+        write32(run.first);
+      for (auto const & run : *p_runs)
+        write32(run.second);
+    }
+    write32(0); // reserved
+    size_t num_bytes = (p_seq->length + 3) / 4;
+    buf.resize(num_bytes);
+    for (size_t k=0; k<num_bytes; ++k)
+      buf[k] = encode[(p_seq->words[k >> 3] >> ((k & 7) << 3)) & 0xFF];
+    // padding bases in last byte are zero
+    unsigned num_last = p_seq->length % 4;
+    if (num_last > 0)
+      buf[num_bytes-1] &= char(0xFF << (2*(4-num_last)));
+    ofs.write(buf.data(), num_bytes);
+  }
+
+  return ofs.good();
 }
 
 unsigned long 
@@ -118,6 +555,31 @@ generateRandomDnaSeq (
   return gen_len;
 }
 
+TCoord
+generateRandomDnaSeq (
+  PackedSequence &seq,
+  const TCoord total_len,
+  const vector<double>& nuc_freqs,
+  RandomNumberGenerator &rng
+) {
+  AliasTable tbl_nuc(nuc_freqs);
+  assert( tbl_nuc.size() == 4 );
+  seq.clear();
+  seq.resize(total_len);
+
+  // generate random sequence, filling 2-bit words in order
+  uint64_t word = 0;
+  for (TCoord pos = 0; pos < total_len; pos++) {
+    uint64_t nuc = tbl_nuc.sample(rng.generator);
+    unsigned shift = (pos & 31) << 1;
+    if (shift == 0)
+      word = 0;
+    word |= nuc << shift;
+    seq.words[pos >> 5] = word;
+  }
+  return total_len;
+}
+
 unsigned long 
 generateRandomDnaSeq (
   string &seq,
@@ -125,27 +587,46 @@ generateRandomDnaSeq (
   const KmerProfile& kmer_prof,
   RandomNumberGenerator &rng
 ) {
-  unsigned idx;
-  string kmer;
+  PackedSequence seq_packed;
+  TCoord gen_len = generateRandomDnaSeq(seq_packed, total_len, kmer_prof, rng);
+  seq = seq_packed.str();
+  return gen_len;
+}
 
-  // pick first kmer at random
-  idx = rng.getRandomIndexWeighted(kmer_prof.m_vec_weight)();
-  kmer = kmer_prof.m_vec_kmers[idx];
-  seq = kmer;
-  unsigned long gen_len = kmer.length();
+TCoord
+generateRandomDnaSeq (
+  PackedSequence &seq,
+  const TCoord total_len,
+  const KmerProfile& kmer_prof,
+  RandomNumberGenerator &rng
+) {
+  assert( kmer_prof.has_idx_pfx );
+  assert( kmer_prof.kmer_length > 0 && kmer_prof.kmer_length <= 32 );
+  const unsigned k = kmer_prof.kmer_length;
+  const uint64_t mask_pfx = (uint64_t(1) << (2*(k-1))) - 1;
+  seq.clear();
+  seq.resize(total_len);
 
-  // generate random sequence
-  while (gen_len < total_len) {
-    // get last k-1 characters from previous kmer
-    string sfx = kmer.substr(1);
-    // pick random kmer starting with last k-1 characters
-    idx = rng.getRandomIndexWeighted(kmer_prof.m_idx_pfx.at(sfx).m_vec_weight)();
-    kmer = kmer_prof.m_idx_pfx.at(sfx).m_vec_kmers[idx];
-    // add last character in kmer to genomic sequence
-    seq += kmer.substr(kmer.length()-1);
-    gen_len++;
+  // pick first kmer at random
+  uint64_t code_kmer = kmer_prof.m_alias_kmer.sample(rng.generator);
+  TCoord gen_len = min(TCoord(k), total_len);
+  for (TCoord i=0; i<gen_len; i++)
+    seq.setCode(i, (code_kmer >> 2*(k-1-i)) & 3);
+  uint64_t code_pfx = code_kmer & mask_pfx;
+
+  // generate random sequence, filling 2-bit words in order
+  uint64_t word = (gen_len > 0) ? seq.words[0] : 0;
+  for (TCoord pos = gen_len; pos < total_len; pos++) {
+    // pick random nucleotide following last k-1 characters
+    uint64_t nuc = kmer_prof.m_alias_pfx[code_pfx].sample(rng.generator);
+    code_pfx = ((code_pfx << 2) | nuc) & mask_pfx;
+    unsigned shift = (pos & 31) << 1;
+    if (shift == 0)
+      word = 0;
+    word |= nuc << shift;
+    seq.words[pos >> 5] = word;
   }
-  return gen_len;
+  return total_len;
 }
 
 /** Simulate allelic dropout (ADO) events
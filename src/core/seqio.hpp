@@ -1,14 +1,19 @@
 #ifndef SEQIO_H
 #define SEQIO_H
 
+#include "seqio/CopyNumberProfile.hpp"
+#include "seqio/FaiRecord.hpp"
 #include "seqio/KmerProfile.hpp"
+#include "seqio/MappedFile.hpp"
 #include "seqio/SegmentCopy.hpp"
+#include "seqio/SegmentIdAllocator.hpp"
+#include "seqio/SegmentIndex.hpp"
 #include "seqio/SeqRecord.hpp"
+#include "seqio/SeqView.hpp"
 #include "seqio/types.hpp"
 #include "random.hpp"
 #include "stringio.hpp"
 #include <algorithm>
-#include <boost/circular_buffer.hpp>
 #include <cassert>
 #include <fstream>
 #include <functional>
@@ -76,16 +81,52 @@ inline std::string rev_comp (std::string dna) {
   return dna;
 }
 
-/** Reads sequences from file. */
-void readFasta(const char*, std::vector<std::shared_ptr<SeqRecord>>&);
-/** Reads sequences from istream. */
-void readFasta(std::istream&, std::vector<std::shared_ptr<SeqRecord>>&);
+/** Reads sequences from file (optionally packing each record as it is read). */
+void readFasta(const char*, std::vector<std::shared_ptr<SeqRecord>>&, const bool pack = false);
+/** Reads sequences from istream (optionally packing each record as it is read). */
+void readFasta(std::istream&, std::vector<std::shared_ptr<SeqRecord>>&, const bool pack = false);
 /** Writes sequences to file. */
 int writeFasta(const std::vector<std::shared_ptr<SeqRecord>>&, const std::string fn, int len_line = 60);
 /** Writes sequences to ostream. */
 int writeFasta(const std::vector<std::shared_ptr<SeqRecord>>&, std::ostream& os, int len_line = 60);
-/** Generate an index for a FASTA file containing multiple sequences */
-void indexFasta(const char*);
+/**
+ * Writes a single FASTA record for a SeqView to ostream, padded on both ends.
+ * Sequence is decoded into a fixed-size buffer chunk by chunk (memory use does not depend on sequence length).
+ */
+void writeFastaRecord(const std::string& id, const SeqView& view, std::ostream& os, const TCoord padding = 0, const char chr_pad = 'A', int len_line = 60);
+/** Generate an index for a FASTA file containing multiple sequences (written to <filename>.fai). */
+bool indexFasta(const char*);
+/** Reads FASTA index entries from a .fai file. */
+bool readFastaIndex(const char*, std::vector<FaiRecord>&);
+/** Writes FASTA index entries to a .fai file. */
+bool writeFastaIndex(const std::vector<FaiRecord>&, const std::string);
+/**
+ * Reads sequences lazily from a memory-mapped FASTA file.
+ * Records are located using the FASTA index (<filename>.fai), which is
+ * generated if it does not exist or is older than the FASTA file.
+ *
+ * \param filename  path to (uncompressed) FASTA file
+ * \param records   output parameter, receives sequence records
+ * \returns         true on success, false on error
+ */
+bool readFastaMapped(const char* filename, std::vector<std::shared_ptr<SeqRecord>>& records);
+/** 
+ * Reads sequences from UCSC .2bit file.
+ * Records are kept in 2-bit packed form (see SeqRecord::pack()).
+ *
+ * \param filename  path to .2bit file
+ * \param records   output parameter, receives sequence records
+ * \returns         true on success, false on error
+ */
+bool readTwoBit(const char* filename, std::vector<std::shared_ptr<SeqRecord>>& records);
+/** 
+ * Writes sequences to UCSC .2bit file.
+ *
+ * \param records   sequence records to write
+ * \param filename  path to output file
+ * \returns         true on success, false on error
+ */
+bool writeTwoBit(const std::vector<std::shared_ptr<SeqRecord>>& records, const std::string filename);
 
 /** Generate random DNA sequence with defined nucleotide frequencies. 
  *  \param seq        output parameter; receives the sequence that is generated.
@@ -101,6 +142,20 @@ generateRandomDnaSeq (
   const std::vector<double> nuc_freqs,
   RandomNumberGenerator &rng);
 
+/** Generate random DNA sequence with defined nucleotide frequencies into packed storage.
+ *  \param seq        output parameter; receives the sequence that is generated.
+ *  \param total_len  length of sequence to generate.
+ *  \param nuc_freqs  nucleotide frequencies (A,C,G,T).
+ *  \param rng        random number generator.
+ *  \returns          length of generated sequence.
+ */
+TCoord
+generateRandomDnaSeq (
+  PackedSequence &seq,
+  const TCoord total_len,
+  const std::vector<double>& nuc_freqs,
+  RandomNumberGenerator &rng);
+
 /** Generate random DNA sequence with defined kmer frequencies. 
  *  \param seq        output parameter; receives the sequence that is generated.
  *  \param total_len  length of sequence to generate.
@@ -115,6 +170,21 @@ generateRandomDnaSeq (
   const KmerProfile& kmer_prof,
   RandomNumberGenerator &rng);
 
+/** Generate random DNA sequence with defined kmer frequencies into packed storage.
+ *  Each base is drawn from a precomputed alias table for the preceding k-1 bases.
+ *  \param seq        output parameter; receives the sequence that is generated.
+ *  \param total_len  length of sequence to generate.
+ *  \param kmer_prof  Kmer frequency profile (with indexed prefixes).
+ *  \param rng        random number generator.
+ *  \returns          length of generated sequence.
+ */
+TCoord
+generateRandomDnaSeq (
+  PackedSequence &seq,
+  const TCoord total_len,
+  const KmerProfile& kmer_prof,
+  RandomNumberGenerator &rng);
+
 /** Simulate allelic dropout events, masking parts of genome as 'N's. */
 void simulateADO_old(const std::string, const float, const int, std::function<double()>&);
 /** Simulate allelic dropout events, masking parts of genome as 'N's. */
@@ -0,0 +1,78 @@
+#ifndef BINARYIO_H
+#define BINARYIO_H
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace seqio {
+
+/** 64-bit FNV-1a hash, can be updated incrementally. */
+inline uint64_t
+hashFnv1a (
+  const char* data,
+  const size_t len,
+  uint64_t hash = 0xcbf29ce484222325ULL
+) {
+  for (size_t i=0; i<len; ++i) {
+    hash ^= uint8_t(data[i]);
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+/** Writes values to binary stream, keeping track of a checksum. */
+struct BinaryWriter {
+  std::ostream& os;
+  uint64_t hash;
+  BinaryWriter(std::ostream& s) : os(s), hash(0xcbf29ce484222325ULL) {}
+  void write(const void* p, const size_t len) {
+    os.write(static_cast<const char*>(p), len);
+    hash = hashFnv1a(static_cast<const char*>(p), len, hash);
+  }
+  void write64(const uint64_t x) { write(&x, sizeof(x)); }
+  void writeStr(const std::string& s) { write64(s.length()); write(s.data(), s.length()); }
+  template <typename T>
+  void writeVec(const std::vector<T>& v) {
+    write64(v.size());
+    write(v.data(), v.size()*sizeof(T));
+  }
+};
+
+/** Reads values from memory buffer (e.g. mapped file), checking bounds. */
+struct BinaryReader {
+  const char* data;
+  size_t len;
+  size_t pos;
+  bool ok;
+  BinaryReader(const char* d, const size_t n) : data(d), len(n), pos(0), ok(true) {}
+  void read(void* p, const size_t n) {
+    if (!ok || n > len - pos) {
+      ok = false;
+      return;
+    }
+    memcpy(p, data + pos, n);
+    pos += n;
+  }
+  uint64_t read64() { uint64_t x = 0; read(&x, sizeof(x)); return x; }
+  std::string readStr() {
+    uint64_t n = read64();
+    if (!ok || n > len - pos) { ok = false; return ""; }
+    std::string s(data + pos, n);
+    pos += n;
+    return s;
+  }
+  template <typename T>
+  void readVec(std::vector<T>& v) {
+    uint64_t n = read64();
+    if (!ok || n > (len - pos)/sizeof(T)) { ok = false; return; }
+    v.resize(n);
+    read(v.data(), n*sizeof(T));
+  }
+};
+
+} // namespace seqio
+
+#endif // BINARYIO_H
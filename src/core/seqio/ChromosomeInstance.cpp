@@ -6,28 +6,55 @@ using boost::icl::interval;
 
 namespace seqio {
 
-ChromosomeInstance::ChromosomeInstance() : length(0) {}
+ChromosomeInstance::ChromosomeInstance() : length(0), is_shared(false), id_seg_owned(0) {}
 
 ChromosomeInstance::ChromosomeInstance (
   const ChromosomeReference ref,
-  const char gl_allele
+  const char gl_allele,
+  shared_ptr<SegmentIdAllocator> sp_ids,
+  shared_ptr<SegmentTree::Arena> sp_arena
 )
-: length(ref.length) {
+: length(ref.length), segments(sp_arena), sp_ids(sp_ids), is_shared(false), id_seg_owned(0) {
   // inititally chromosome consists of a single SegmentCopy
-  SegmentCopy seg_copy(0, this->length, gl_allele);
-  this->lst_segments.push_back(seg_copy);
+  SegmentCopy seg_copy(sp_ids->next(), 0, this->length, gl_allele);
+  this->segments.push_back(seg_copy);
 }
 
-vector<SegmentCopy> ChromosomeInstance::getSegmentCopiesAt(unsigned long ref_pos) {
+vector<SegmentCopy> ChromosomeInstance::getSegmentCopiesAt(TCoord ref_pos) {
   vector<SegmentCopy> res_segments;
-  for (auto const & seg : this->lst_segments) {
-    if ( ref_pos >= seg.ref_start && ref_pos < seg.ref_end ) {
-      res_segments.push_back(seg);
-    }
-  }
+  this->segments.getSegmentCopiesAt(ref_pos, res_segments);
   return res_segments;
 }
 
+bool
+ChromosomeInstance::hasSegmentCopy (
+  const SegmentCopy& seg
+) const
+{
+  return this->segments.contains(seg);
+}
+
+TSegId
+ChromosomeInstance::unshareSegmentCopy (
+  const SegmentCopy& seg,
+  vector<seg_mod_t>& out_vec_seg_mod
+)
+{
+  assert( !this->is_shared );
+  // SegmentCopies created by this ChromosomeInstance can be modified in place
+  if (seg.id >= this->id_seg_owned)
+    return seg.id;
+
+  TSegId id_new = this->sp_ids->next();
+  bool is_found = this->segments.replaceId(seg, id_new);
+  assert( is_found ); // SegmentCopy must be part of this ChromosomeInstance
+  if (!is_found)
+    return seg.id;
+  out_vec_seg_mod.push_back(make_tuple(id_new, seg.id, seg.ref_start, seg.ref_end));
+
+  return id_new;
+}
+
 vector<seg_mod_t> ChromosomeInstance::amplifyRegion (
   double start_rel,
   double len_rel,
@@ -35,13 +62,6 @@ vector<seg_mod_t> ChromosomeInstance::amplifyRegion (
   bool is_telomeric
 ) {
   vector<seg_mod_t> vec_seg_mod;
-  // iterators pointing to SegmentCopy
-  list<SegmentCopy>::iterator it_seg_bkp_left, it_seg_bkp_right;
-  list<SegmentCopy> lst_seg_new;
-  bool is_left_bkp = false;
-  //bool is_right_bkp = false; // has the end of insertion been reached?
-  // NOTE: start_rel value may be changed to match other parameters
-  //len_rel = min(len_rel, is_forward ? 1.0-start_rel : start_rel);
   // perform some sanity checks
   assert( len_rel > 0.0 && len_rel <= 1.0 );
   if (is_forward)
@@ -49,10 +69,10 @@ vector<seg_mod_t> ChromosomeInstance::amplifyRegion (
   else
     assert( start_rel - len_rel >= 0.0 );
   // physical start, length of event
-  unsigned long start_bp = start_rel * this->length;
-  unsigned long len_bp = len_rel * this->length;
+  TCoord start_bp = start_rel * this->length;
+  TCoord len_bp = len_rel * this->length;
   // physical coordinates
-  unsigned long bkp_start, bkp_end;
+  TCoord bkp_start, bkp_end;
   if (is_forward) {
     bkp_start = start_bp;
     bkp_end = is_telomeric ? this->length : start_bp+len_bp;
@@ -63,127 +83,52 @@ vector<seg_mod_t> ChromosomeInstance::amplifyRegion (
   // make sure insert length is exact
   len_bp = (bkp_end - bkp_start);
 
-  // identify first affected SegmentCopy
-  unsigned long pos_bp = 0; // current position
-  unsigned long seg_len = 0; // length of current SegmentCopy
-  char seg_allele = 'A'; // reference source allele of current SegmentCopy
-  auto it_seg = this->lst_segments.begin();
-  // NOTE: after break, pos_bp stores the start coordinate of the current SegmentCopy
-  while (it_seg != this->lst_segments.end()) {
-    seg_len = it_seg->ref_end - it_seg->ref_start;
-    if (pos_bp+seg_len > bkp_start) break;
-    pos_bp += seg_len;
-    it_seg++;
-  }
-  assert( it_seg != this->lst_segments.end() );
-
-  // breakpoint after beginning of current SegmentCopy?
-  if (bkp_start >= pos_bp) {
-    is_left_bkp = true;
-    seg_len = it_seg->ref_end - it_seg->ref_start;
-    seg_allele = it_seg->gl_allele;
-    //is_right_bkp = (bkp_end <= pos_bp+seg_len);
-    // create new SegmentCopy
-    unsigned long seg_new_start = it_seg->ref_start + (bkp_start - pos_bp);
-    unsigned long seg_new_end = pos_bp+seg_len <= bkp_end ? it_seg->ref_end : seg_new_start+len_bp;
+  // create copies of amplified region (each refers to the SegmentCopy it originates from)
+  vector<tuple<SegmentCopy, TCoord, TCoord>> vec_pieces;
+  this->segments.getPieces(bkp_start, bkp_end, vec_pieces);
+  vector<SegmentCopy> vec_seg_new;
+  vec_seg_new.reserve(vec_pieces.size());
+  for (auto const & piece : vec_pieces) {
+    const SegmentCopy& seg_src = get<0>(piece);
+    TCoord seg_new_start = get<1>(piece);
+    TCoord seg_new_end = get<2>(piece);
     assert( seg_new_start < seg_new_end );
-    SegmentCopy seg_new(seg_new_start, seg_new_end, seg_allele);
-    lst_seg_new.push_back(seg_new);
-    vec_seg_mod.push_back(make_tuple(seg_new.id, it_seg->id, seg_new_start, seg_new_end));
-
-    // will new SegmentCopies be inserted at first breakpoint?
-    if (!is_forward ) {
-      if ( bkp_start > pos_bp) { // split this SegmentCopy at breakpoint
-        // head of SegmentCopy
-        TCoord head_len = bkp_start - pos_bp;
-        TCoord head_start = it_seg->ref_start;
-        TCoord head_end = it_seg->ref_start + head_len;
-        SegmentCopy seg_head(head_start, head_end, seg_allele);
-        vec_seg_mod.push_back(make_tuple(seg_head.id, it_seg->id, head_start, head_end));
-        // tail of SegmentCopy
-        TCoord tail_start = head_end;
-        TCoord tail_end = it_seg->ref_end;
-        SegmentCopy seg_tail(tail_start, tail_end, seg_allele);
-        vec_seg_mod.push_back(make_tuple(seg_tail.id, it_seg->id, tail_start, tail_end));
-
-        // replace existing SegmentCopy
-        it_seg = this->lst_segments.erase(it_seg);
-        this->lst_segments.insert(it_seg, seg_head);
-        it_seg_bkp_left = this->lst_segments.insert(it_seg, seg_tail);
-        // continue processing with new tail SegmentCopy
-        it_seg = it_seg_bkp_left;
-        pos_bp += head_len;
-      } else { // start of SegmentCopy coincides with first breakpoint, no need to split
-        // new SegmentCopies will be inserted before current one
-        it_seg_bkp_left = it_seg;
-      }
-    }
-  }
-
-  // skip over SegmentCopies that are affected entirely
-  while (it_seg != this->lst_segments.end()) {
-    seg_len = it_seg->ref_end - it_seg->ref_start;
-    if (pos_bp+seg_len >= bkp_end) break;
-    // right breakpoint is after end of SegmentCopy
-    if (!is_left_bkp) {
-      SegmentCopy seg_copy(it_seg->ref_start, it_seg->ref_end, it_seg->gl_allele);
-      lst_seg_new.push_back(seg_copy);
-      vec_seg_mod.push_back(make_tuple(seg_copy.id, it_seg->id, it_seg->ref_start, it_seg->ref_end));
-    } else {
-      is_left_bkp = false;
-    }
-    // proceed to next SegmentCopy
-    pos_bp += seg_len;
-    it_seg++;
+    SegmentCopy seg_new(sp_ids->next(), seg_new_start, seg_new_end, seg_src.gl_allele);
+    vec_seg_new.push_back(seg_new);
+    vec_seg_mod.push_back(make_tuple(seg_new.id, seg_src.id, seg_new_start, seg_new_end));
   }
-
-  // breakpoint before end of current SegmentCopy?
-  if (it_seg != this->lst_segments.end() && bkp_end <= pos_bp+seg_len) {
-    // new SegmentCopy needed only if this one does not contain left breakpoint
-    // (otherwise the whole duplication has already been handled)
-    if (!is_left_bkp) {
-      TCoord seg_new_start = it_seg->ref_start;
-      TCoord seg_new_end = seg_new_start + (bkp_end-pos_bp);
-      char seg_new_allele = it_seg->gl_allele;
-      assert( seg_new_start < seg_new_end );
-      SegmentCopy seg_new(seg_new_start, seg_new_end, seg_new_allele);
-      lst_seg_new.push_back(seg_new);
-      vec_seg_mod.push_back(make_tuple(seg_new.id, it_seg->id, seg_new_start, seg_new_end));
-    }
-    if (is_forward ) {
-      if (bkp_end < pos_bp+seg_len) { // split this SegmentCopy at breakpoint
-        // head of SegmentCopy
-        TCoord head_len = bkp_end - pos_bp;
-        TCoord head_start = it_seg->ref_start;
-        TCoord head_end = it_seg->ref_start + head_len;
-        SegmentCopy seg_head(head_start, head_end, it_seg->gl_allele);
-        vec_seg_mod.push_back(make_tuple(seg_head.id, it_seg->id, head_start, head_end));
-
-        // tail of SegmentCopy
-        TCoord tail_start = head_end;
-        TCoord tail_end = it_seg->ref_end;
-        SegmentCopy seg_tail(tail_start, tail_end, it_seg->gl_allele);
-        vec_seg_mod.push_back(make_tuple(seg_tail.id, it_seg->id, tail_start, tail_end));
-
-        // replace existing SegmentCopy
-        it_seg = this->lst_segments.erase(it_seg);
-        this->lst_segments.insert(it_seg, seg_head);
-        it_seg_bkp_right = this->lst_segments.insert(it_seg, seg_tail);
-      } else { // amplification includes end of SegmentCopy
-        it_seg_bkp_right = ++it_seg;
-      }
-    }
-  }
-
-  // insert new SegmentCopies
-  if (is_forward) {
-    this->lst_segments.insert(it_seg_bkp_right, lst_seg_new.begin(), lst_seg_new.end());
-  } else {
-    this->lst_segments.insert(it_seg_bkp_left, lst_seg_new.begin(), lst_seg_new.end());
+  SegmentTree tree_new(this->segments.sp_arena);
+  tree_new.build(vec_seg_new);
+
+  // new SegmentCopies are inserted after (forward) or before (reverse) amplified region
+  TCoord pos_ins = is_forward ? bkp_end : bkp_start;
+  SegmentTree tree_left, tree_right;
+  SegmentCopy seg_mid;
+  TCoord off_mid = 0;
+  if (this->segments.split(pos_ins, tree_left, tree_right, seg_mid, off_mid)) {
+    // split SegmentCopy at breakpoint
+    // head of SegmentCopy
+    TCoord head_start = seg_mid.ref_start;
+    TCoord head_end = seg_mid.ref_start + off_mid;
+    SegmentCopy seg_head(sp_ids->next(), head_start, head_end, seg_mid.gl_allele);
+    vec_seg_mod.push_back(make_tuple(seg_head.id, seg_mid.id, head_start, head_end));
+    tree_left.push_back(seg_head);
+    tree_left.append(tree_new);
+    // tail of SegmentCopy
+    TCoord tail_start = head_end;
+    TCoord tail_end = seg_mid.ref_end;
+    SegmentCopy seg_tail(sp_ids->next(), tail_start, tail_end, seg_mid.gl_allele);
+    vec_seg_mod.push_back(make_tuple(seg_tail.id, seg_mid.id, tail_start, tail_end));
+    tree_left.push_back(seg_tail);
+  } else { // breakpoint coincides with SegmentCopy boundary, no need to split
+    tree_left.append(tree_new);
   }
+  tree_left.append(tree_right);
+  this->segments = tree_left;
 
   // update ChromosomeInstance length
   this->length += len_bp;
+  assert( this->length == this->segments.length() );
 
   return vec_seg_mod;
 }
@@ -195,9 +140,6 @@ vector<seg_mod_t> ChromosomeInstance::deleteRegion(
   bool is_telomeric
 ) {
   vector<seg_mod_t> vec_seg_mod;
-  // iterators pointing to SegmentCopoe
-  list<SegmentCopy>::iterator it_rm_from, it_rm_to;
-  list<SegmentCopy> lst_seg_new;
   // perform some sanity checks
   assert( len_rel > 0.0 && len_rel <= 1.0 );
   if (is_forward)
@@ -219,78 +161,68 @@ vector<seg_mod_t> ChromosomeInstance::deleteRegion(
   // make sure insert length is exact
   len_bp = (bkp_end - bkp_start);
 
-  // identify first affected SegmentCopy
-  TCoord pos_bp = 0; // current position
-  TCoord seg_len = 0; // length of current SegmentCopy
-  auto it_seg = this->lst_segments.begin();
-  // NOTE: after break, pos_bp stores the start coordinate of the current SegmentCopy
-  while (it_seg != this->lst_segments.end()) {
-    seg_len = it_seg->ref_end - it_seg->ref_start;
-    if (pos_bp+seg_len >= bkp_start) break;
-    pos_bp += seg_len;
-    it_seg++;
-  }
-  assert( it_seg != this->lst_segments.end() );
-
-  // current SegmentCopy will be removed
-  // (if only part of SegmentCopy is affected, a new SegmentCopy will be introduced)
-  it_rm_from = it_seg;
-
-  // does deletion start after beginning of current SegmentCopy?
-  if (bkp_start > pos_bp) {
+  // SegmentCopies left of deleted region
+  SegmentTree tree_left, tree_tmp;
+  SegmentCopy seg_left, seg_right;
+  TCoord off_left = 0, off_right = 0;
+  bool is_split_left = this->segments.split(bkp_start, tree_left, tree_tmp, seg_left, off_left);
+  // SegmentCopies right of deleted region
+  SegmentTree tree_right;
+  bool is_split_right = this->segments.split(bkp_end, tree_tmp, tree_right, seg_right, off_right);
+
+  // does deletion start after beginning of a SegmentCopy?
+  if (is_split_left) {
     // head of SegmentCopy will be conserved
-    TCoord head_len = bkp_start - pos_bp;
-    TCoord head_start = it_seg->ref_start;
-    TCoord head_end = it_seg->ref_start + head_len;
+    TCoord head_start = seg_left.ref_start;
+    TCoord head_end = seg_left.ref_start + off_left;
     assert( head_start < head_end );
-    SegmentCopy seg_head(head_start, head_end, it_seg->gl_allele);
-    lst_seg_new.push_back(seg_head);
-    vec_seg_mod.push_back(make_tuple(seg_head.id, it_seg->id, head_start, head_end));
-  }
-
-  // skip over SegmentCopies to be removed completely
-  while (it_seg != this->lst_segments.end()) {
-    seg_len = it_seg->ref_end - it_seg->ref_start;
-    if (pos_bp+seg_len >= bkp_end) break;
-    pos_bp += seg_len;
-    it_seg++;
+    SegmentCopy seg_head(sp_ids->next(), head_start, head_end, seg_left.gl_allele);
+    tree_left.push_back(seg_head);
+    vec_seg_mod.push_back(make_tuple(seg_head.id, seg_left.id, head_start, head_end));
   }
 
-  // does deletion end before end of current SegmentCopy?
-  if (bkp_end < pos_bp+seg_len) {
+  // does deletion end before end of a SegmentCopy?
+  if (is_split_right) {
     // tail of SegmentCopy will be conserved
-    TCoord tail_len = pos_bp + seg_len - bkp_end;
-    TCoord tail_start = it_seg->ref_end - tail_len;
-    TCoord tail_end = it_seg->ref_end;
+    TCoord tail_start = seg_right.ref_start + off_right;
+    TCoord tail_end = seg_right.ref_end;
     assert( tail_start < tail_end );
-    SegmentCopy seg_tail(tail_start, tail_end, it_seg->gl_allele);
-    lst_seg_new.push_back(seg_tail);
-    vec_seg_mod.push_back(make_tuple(seg_tail.id, it_seg->id, tail_start, tail_end));
+    SegmentCopy seg_tail(sp_ids->next(), tail_start, tail_end, seg_right.gl_allele);
+    tree_left.push_back(seg_tail);
+    vec_seg_mod.push_back(make_tuple(seg_tail.id, seg_right.id, tail_start, tail_end));
   }
 
-  // remove affected SegmentCopies [it_rm_from, it_rm_to)
-  it_rm_to = ++it_seg;
-  this->lst_segments.erase(it_rm_from, it_rm_to);
-  // insert new SegmentCopies
-  this->lst_segments.insert(it_rm_to, lst_seg_new.begin(), lst_seg_new.end());
+  tree_left.append(tree_right);
+  this->segments = tree_left;
   // update ChromosomeInstance length
   this->length -= len_bp;
+  assert( this->length == this->segments.length() );
 
   return vec_seg_mod;
 }
 
 void ChromosomeInstance::copy(shared_ptr<ChromosomeInstance> ci_old, vector<seg_mod_t>& out_vec_seg_mod) {
+  if (!this->sp_ids)
+    this->sp_ids = ci_old->sp_ids;
+  if (!this->segments.sp_arena)
+    this->segments.sp_arena = ci_old->segments.sp_arena;
+  // all SegmentCopies will be created anew
+  this->id_seg_owned = this->sp_ids->next_id;
   this->length = ci_old->length;
-  for (auto const & seg_old : ci_old->lst_segments) {
-    SegmentCopy seg_new(seg_old.ref_start, seg_old.ref_end, seg_old.gl_allele);
-    this->lst_segments.push_back(seg_new);
+  vector<SegmentCopy> vec_seg_new;
+  vec_seg_new.reserve(ci_old->segments.size());
+  for (auto const & seg_old : ci_old->segments) {
+    SegmentCopy seg_new(sp_ids->next(), seg_old.ref_start, seg_old.ref_end, seg_old.gl_allele);
+    vec_seg_new.push_back(seg_new);
     out_vec_seg_mod.push_back(make_tuple(seg_new.id, seg_old.id, seg_old.ref_start, seg_old.ref_end));
   }
+  // tree is built in one pass (no intermediate nodes)
+  this->segments.build(vec_seg_new);
 }
 
 ostream& operator<<(ostream& lhs, const ChromosomeInstance& ci) {
   lhs << "    ChromosomeInstance<length=" << ci.length << ">" << endl;
-  for (auto const & seg : ci.lst_segments) {
+  for (auto const & seg : ci.segments) {
     lhs << "      " << seg;
   }
   return lhs;
@@ -302,11 +234,12 @@ ChromosomeInstance::indexSegmentCopies (
 ) const
 {
   typedef set<SegmentCopy> TSegSet;
-  for (const SegmentCopy seg : lst_segments) {
+  for (const SegmentCopy & seg : segments) {
     TCoord p1 = seg.ref_start;
     TCoord p2 = seg.ref_end;
     imap_segments += make_pair(interval<TCoord>::right_open(p1,p2), TSegSet({seg}));
   }
+  return true;
 }
 
 } // namespace seqio
\ No newline at end of file
@@ -3,10 +3,11 @@
 
 #include "ChromosomeReference.hpp"
 #include "SegmentCopy.hpp"
+#include "SegmentIdAllocator.hpp"
+#include "SegmentTree.hpp"
 #include "types.hpp"
 #include <boost/icl/interval.hpp>
 #include <boost/icl/interval_map.hpp>
-#include <list>
 
 namespace seqio {
 
@@ -26,13 +27,21 @@ TSegSet;
 /** Represents a physical representation of a chromosome.
  *
  *  Structurally a ChromosomeInstance is a chain of SegmentCopies,
- *  which represent regions of the reference sequence.
+ *  which represent regions of the reference sequence. The chain is kept
+ *  in a persistent SegmentTree: breakpoints are located and regions spliced
+ *  in O(log n), copies of a ChromosomeInstance share the tree.
  */
 struct ChromosomeInstance {
   /** Real length (in bp) of ChromosomeInstance */
-  unsigned long length;
-  /** SegmentCopies that are associated with this ChromosomeInstance */
-  std::list<SegmentCopy> lst_segments;
+  TCoord length;
+  /** SegmentCopies that are associated with this ChromosomeInstance (in physical order) */
+  SegmentTree segments;
+  /** Source of identifiers for newly created SegmentCopies. */
+  std::shared_ptr<SegmentIdAllocator> sp_ids;
+  /** Is this ChromosomeInstance shared by several GenomeInstances? (copy before modifying) */
+  bool is_shared;
+  /** SegmentCopies with smaller ids have been inherited and may be shared with other ChromosomeInstances. */
+  TSegId id_seg_owned;
   
   /** default c'tor */
   ChromosomeInstance();
@@ -41,10 +50,14 @@ struct ChromosomeInstance {
    *  A single SegmentCopy will be created comprising the whole chromosome.
    *  \param chr_ref    Reference chromosome of which to create an instance.
    *  \param gl_allele  Germline source allele, will be assigned to segment copies.
+   *  \param sp_ids     Allocator for SegmentCopy identifiers.
+   *  \param sp_arena   Arena for SegmentTree nodes (default: create new one).
    */
   ChromosomeInstance (
     const ChromosomeReference chr_ref,
-    const char gl_allele
+    const char gl_allele,
+    std::shared_ptr<SegmentIdAllocator> sp_ids,
+    std::shared_ptr<SegmentTree::Arena> sp_arena = nullptr
   );
 
   /** Identify SegmentCopies overlapping a given locus. */
@@ -53,6 +66,24 @@ struct ChromosomeInstance {
     TCoord ref_pos
   );
 
+  /** Check if ChromosomeInstance contains a given SegmentCopy. */
+  bool
+  hasSegmentCopy (
+    const SegmentCopy& seg
+  ) const;
+
+  /** Make sure a SegmentCopy is not shared with other ChromosomeInstances.
+   *  An inherited SegmentCopy is replaced by one with a new id (same coordinates).
+   *  \param seg             SegmentCopy to be modified.
+   *  \param out_seg_mods    Output parameter: SegmentCopy modifications (id_new, id_old, start_old, end_old)
+   *  \returns               id of SegmentCopy (unchanged if it was not shared).
+   */
+  TSegId
+  unshareSegmentCopy (
+    const SegmentCopy& seg,
+    std::vector<seg_mod_t>& out_seg_mods
+  );
+
   /** Amplify a region of this ChromosomeInstance by creating new SegmentCopies
    *  \param start_rel    Relative start coordinate of deletion (fraction of chromosome length).
    *  \param len_rel      Relative length of region to delete (fraction of chromosome length).
@@ -84,7 +115,9 @@ struct ChromosomeInstance {
 
   /** Create a copy of an existing ChromosomeInstance.
    *
-   *  Copies each SegmentCopy comprising the existing ChromosomeInstance.
+   *  Copies each SegmentCopy comprising the existing ChromosomeInstance
+   *  (replacing SegmentCopies of this ChromosomeInstance, if any).
+   *  Unless set beforehand, the identifier allocator and node Arena are shared with ci_old.
    *  \param ci_old Existing ChromosomeInstance to be copied
    *  \param out_seg_mods Output parameter: Tuples of modifications to SegmentCopies (id_new, id_old, start_old, end_old)
    */
@@ -4,4 +4,16 @@ namespace seqio {
 
 ChromosomeReference::ChromosomeReference() : id(""), length(0) {}
 
+char ChromosomeReference::getNucAt(const TCoord pos) const {
+  // last sequence record starting at or before position
+  auto it = map_start_rec.upper_bound(pos);
+  if (it == map_start_rec.begin())
+    return 'N';
+  --it;
+  TCoord pos_rec = pos - it->first;
+  if (pos_rec >= it->second->length())
+    return 'N';
+  return it->second->getNucAt(pos_rec);
+}
+
 } // namespace seqio
\ No newline at end of file
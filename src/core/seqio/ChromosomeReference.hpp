@@ -17,15 +17,15 @@ struct ChromosomeReference {
    /** chromosome identifier in reference genome. */
    std::string id;
    /** total length */
-   unsigned long length;
+   TCoord length;
    /** sequence records belonging to this chromosome, indexed by start position */
    std::map<TCoord, std::shared_ptr<SeqRecord>> map_start_rec;
 
    /** default c'tor */
    ChromosomeReference();
 
-   /** Get nucleotide at position */
-   char getNucAt(TCoord pos);
+   /** Get nucleotide at position ('N' if not covered by a sequence record) */
+   char getNucAt(const TCoord pos) const;
  };
 
 } // namespace seqio
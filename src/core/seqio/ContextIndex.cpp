@@ -0,0 +1,207 @@
+#include "../seqio.hpp"
+#include "ContextIndex.hpp"
+
+using namespace std;
+
+namespace seqio {
+
+const unsigned ContextIndex::NUM_CONTEXTS;
+const unsigned ContextIndex::BLOCK_LEN;
+const unsigned ContextIndex::BLOCKS_PER_SUPERBLOCK;
+
+/**
+ * Find last entry in [lo, hi) having a cumulative count <= k.
+ * Entries are rows of a [row][context] table.
+ */
+template <typename T>
+static TCoord
+findLastLeq (
+  const vector<T>& vec_cnt,
+  TCoord lo,
+  TCoord hi,
+  const unsigned ctx,
+  const TCoord k
+) {
+  while (hi - lo > 1) {
+    TCoord mid = lo + (hi - lo)/2;
+    if (vec_cnt[mid*ContextIndex::NUM_CONTEXTS + ctx] <= k)
+      lo = mid;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
+ContextIndex::ContextIndex() {}
+
+void ContextIndex::clear() {
+  vector<TCoord>().swap(m_rec_start);
+  vector<TCoord>().swap(m_rec_sb);
+  vector<TCoord>().swap(m_rec_blk);
+  vector<TCoord>().swap(m_cnt_rec);
+  vector<TCoord>().swap(m_cnt_sb);
+  vector<uint16_t>().swap(m_cnt_blk);
+}
+
+void ContextIndex::scanRecord(const SeqRecord& rec, RecordScan& scan) {
+  const TCoord len_chunk = 1 << 16;
+  TCoord len = rec.length();
+  TCoord num_blk = (len + BLOCK_LEN - 1) / BLOCK_LEN;
+  vector<unsigned> blk_occ(num_blk * NUM_CONTEXTS, 0); // context occurrences per block
+  scan.length = len;
+  scan.num_blk = num_blk;
+  scan.vec_unmasked.clear();
+
+  // count occurrences, keeping a rolling code for the last three bases
+  string chunk;
+  unsigned code_3mer = 0;
+  TCoord len_run = 0; // number of consecutive unmasked bases
+  for (TCoord pos_chunk = 0; pos_chunk < len; pos_chunk += len_chunk) {
+    rec.getSubSeq(pos_chunk, len_chunk, chunk);
+    for (TCoord i = 0; i < chunk.length(); ++i) {
+      TCoord p = pos_chunk + i;
+      short nuc = nuc2idx(chunk[i]);
+      if (nuc == -1) {
+        if (len_run > 0)
+          scan.vec_unmasked.push_back(make_pair(p - len_run, len_run));
+        len_run = 0;
+        continue;
+      }
+      blk_occ[(p/BLOCK_LEN)*NUM_CONTEXTS + nuc]++;
+      code_3mer = ((code_3mer << 2) | nuc) & 63;
+      len_run++;
+      if (len_run >= 3)
+        blk_occ[((p-2)/BLOCK_LEN)*NUM_CONTEXTS + 4 + code_3mer]++;
+    }
+  }
+  if (len_run > 0)
+    scan.vec_unmasked.push_back(make_pair(len - len_run, len_run));
+
+  // sample cumulative counts at superblock and block starts
+  scan.cnt_sb.clear();
+  scan.cnt_blk.clear();
+  scan.cnt_blk.reserve(num_blk * NUM_CONTEXTS);
+  vector<TCoord> cnt_sb(NUM_CONTEXTS, 0);
+  vector<TCoord> cnt_blk(NUM_CONTEXTS, 0);
+  for (TCoord b = 0; b < num_blk; ++b) {
+    if (b % BLOCKS_PER_SUPERBLOCK == 0) {
+      for (unsigned c = 0; c < NUM_CONTEXTS; ++c) {
+        cnt_sb[c] += cnt_blk[c];
+        cnt_blk[c] = 0;
+      }
+      scan.cnt_sb.insert(scan.cnt_sb.end(), cnt_sb.begin(), cnt_sb.end());
+    }
+    scan.cnt_blk.insert(scan.cnt_blk.end(), cnt_blk.begin(), cnt_blk.end());
+    for (unsigned c = 0; c < NUM_CONTEXTS; ++c)
+      cnt_blk[c] += blk_occ[b*NUM_CONTEXTS + c];
+  }
+  scan.cnt_total.resize(NUM_CONTEXTS);
+  for (unsigned c = 0; c < NUM_CONTEXTS; ++c)
+    scan.cnt_total[c] = cnt_sb[c] + cnt_blk[c];
+}
+
+void ContextIndex::merge(vector<RecordScan>& vec_scan) {
+  this->clear();
+  m_rec_start.push_back(0);
+  m_rec_sb.push_back(0);
+  m_rec_blk.push_back(0);
+  m_cnt_rec.assign(NUM_CONTEXTS, 0);
+
+  // reserve space for concatenated tables
+  TCoord num_sb = 0, num_blk = 0;
+  for (auto const & scan : vec_scan) {
+    num_sb += scan.cnt_sb.size();
+    num_blk += scan.cnt_blk.size();
+  }
+  m_cnt_sb.reserve(num_sb);
+  m_cnt_blk.reserve(num_blk);
+
+  vector<TCoord> cnt_total(NUM_CONTEXTS, 0);
+  for (auto & scan : vec_scan) {
+    m_cnt_sb.insert(m_cnt_sb.end(), scan.cnt_sb.begin(), scan.cnt_sb.end());
+    m_cnt_blk.insert(m_cnt_blk.end(), scan.cnt_blk.begin(), scan.cnt_blk.end());
+    for (unsigned c = 0; c < NUM_CONTEXTS; ++c)
+      cnt_total[c] += scan.cnt_total[c];
+    m_cnt_rec.insert(m_cnt_rec.end(), cnt_total.begin(), cnt_total.end());
+    m_rec_start.push_back(m_rec_start.back() + scan.length);
+    m_rec_blk.push_back(m_rec_blk.back() + scan.num_blk);
+    m_rec_sb.push_back(m_rec_sb.back() + scan.cnt_sb.size()/NUM_CONTEXTS);
+    // release scan tables early
+    vector<TCoord>().swap(scan.cnt_sb);
+    vector<uint16_t>().swap(scan.cnt_blk);
+  }
+}
+
+TCoord ContextIndex::count(const unsigned ctx) const {
+  assert( ctx < NUM_CONTEXTS );
+  if (m_rec_start.size() == 0)
+    return 0;
+  return m_cnt_rec[(m_rec_start.size()-1)*NUM_CONTEXTS + ctx];
+}
+
+TCoord ContextIndex::select(
+  const unsigned ctx,
+  const TCoord k,
+  const vector<shared_ptr<SeqRecord>>& records
+) const
+{
+  assert( k < this->count(ctx) );
+  // locate record, superblock and block containing the k-th occurrence
+  TCoord num_rec = m_rec_start.size() - 1;
+  TCoord idx_rec = findLastLeq(m_cnt_rec, 0, num_rec, ctx, k);
+  TCoord k_rec = k - m_cnt_rec[idx_rec*NUM_CONTEXTS + ctx];
+  TCoord idx_sb = findLastLeq(m_cnt_sb, m_rec_sb[idx_rec], m_rec_sb[idx_rec+1], ctx, k_rec);
+  TCoord k_sb = k_rec - m_cnt_sb[idx_sb*NUM_CONTEXTS + ctx];
+  TCoord blk_lo = m_rec_blk[idx_rec] + (idx_sb - m_rec_sb[idx_rec])*BLOCKS_PER_SUPERBLOCK;
+  TCoord blk_hi = min(blk_lo + BLOCKS_PER_SUPERBLOCK, m_rec_blk[idx_rec+1]);
+  TCoord idx_blk = findLastLeq(m_cnt_blk, blk_lo, blk_hi, ctx, k_sb);
+  TCoord k_blk = k_sb - m_cnt_blk[idx_blk*NUM_CONTEXTS + ctx];
+
+  // scan block (plus two positions to complete trinucleotides)
+  TCoord pos_blk = (idx_blk - m_rec_blk[idx_rec]) * BLOCK_LEN;
+  string seq;
+  records[idx_rec]->getSubSeq(pos_blk, BLOCK_LEN+2, seq);
+  TCoord num_pos = min(TCoord(BLOCK_LEN), TCoord(seq.length()));
+  for (TCoord i = 0; i < num_pos; ++i) {
+    short nuc = nuc2idx(seq[i]);
+    if (nuc == -1)
+      continue;
+    bool is_match = false;
+    if (ctx < 4) {
+      is_match = (unsigned(nuc) == ctx);
+    }
+    else if (i+2 < seq.length()) {
+      short nuc2 = nuc2idx(seq[i+1]);
+      short nuc3 = nuc2idx(seq[i+2]);
+      is_match = (nuc2 > -1 && nuc3 > -1 && unsigned(4 + 16*nuc + 4*nuc2 + nuc3) == ctx);
+    }
+    if (is_match) {
+      if (k_blk == 0)
+        return m_rec_start[idx_rec] + pos_blk + i;
+      k_blk--;
+    }
+  }
+
+  // should not happen: index does not match sequence records
+  assert( false );
+  return m_rec_start[idx_rec] + pos_blk;
+}
+
+int ContextIndex::getTrinucContext(const string& trinuc) {
+  if (trinuc.length() != 3)
+    return -1;
+  short n1 = nuc2idx(trinuc[0]);
+  short n2 = nuc2idx(trinuc[1]);
+  short n3 = nuc2idx(trinuc[2]);
+  if (n1 == -1 || n2 == -1 || n3 == -1)
+    return -1;
+  return 4 + 16*n1 + 4*n2 + n3;
+}
+
+size_t ContextIndex::getMemoryUsage() const {
+  return (m_rec_start.capacity() + m_rec_sb.capacity() + m_rec_blk.capacity()
+          + m_cnt_rec.capacity() + m_cnt_sb.capacity())*sizeof(TCoord)
+       + m_cnt_blk.capacity()*sizeof(uint16_t);
+}
+
+} // namespace seqio
@@ -0,0 +1,104 @@
+#ifndef CONTEXTINDEX_H
+#define CONTEXTINDEX_H
+
+#include "SeqRecord.hpp"
+#include "types.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace seqio {
+
+/**
+ * Occurrence index of sequence contexts (nucleotides, trinucleotides).
+ *
+ * Answers "where is the k-th occurrence of context X?" without storing
+ * positions explicitly. Occurrence counts are sampled at regular intervals
+ * (superblocks, subdivided into blocks); a query locates the block by
+ * binary search and scans at most one block of sequence.
+ *
+ * Contexts are identified by integer codes:
+ *   - 0..3:  nucleotides A, C, G, T (cf. nuc2idx())
+ *   - 4..67: trinucleotides AAA, AAC, ..., TTT (4 + 16*n1 + 4*n2 + n3)
+ * A trinucleotide occurrence is located at its first position. Masked
+ * positions ('N') are not part of any context.
+ */
+struct ContextIndex
+{
+  /** number of indexed contexts */
+  static const unsigned NUM_CONTEXTS = 68;
+  /** number of positions per block */
+  static const unsigned BLOCK_LEN = 1024;
+  /** number of blocks per superblock */
+  static const unsigned BLOCKS_PER_SUPERBLOCK = 64;
+
+  /** global start positions of records (num_records+1 entries) */
+  std::vector<TCoord> m_rec_start;
+  /** index of first superblock for each record (num_records+1 entries) */
+  std::vector<TCoord> m_rec_sb;
+  /** index of first block for each record (num_records+1 entries) */
+  std::vector<TCoord> m_rec_blk;
+  /** cumulative counts at record starts, layout: [record][context] */
+  std::vector<TCoord> m_cnt_rec;
+  /** cumulative counts at superblock starts (relative to record), layout: [superblock][context] */
+  std::vector<TCoord> m_cnt_sb;
+  /** cumulative counts at block starts (relative to superblock), layout: [block][context] */
+  std::vector<uint16_t> m_cnt_blk;
+
+  /**
+   * Results of scanning a single sequence record.
+   * Records can be scanned independently (e.g., in parallel) and merged.
+   */
+  struct RecordScan {
+    /** number of bases in record */
+    TCoord length;
+    /** number of blocks in record */
+    TCoord num_blk;
+    /** cumulative counts at superblock starts (relative to record) */
+    std::vector<TCoord> cnt_sb;
+    /** cumulative counts at block starts (relative to superblock) */
+    std::vector<uint16_t> cnt_blk;
+    /** total counts in record */
+    std::vector<TCoord> cnt_total;
+    /** unmasked regions, structure: (start, length) */
+    std::vector<std::pair<TCoord, TCoord>> vec_unmasked;
+  };
+
+  /** default c'tor */
+  ContextIndex();
+
+  /** Scan a sequence record in a single pass (thread-safe). */
+  static void scanRecord(const SeqRecord& rec, RecordScan& scan);
+  /** Build index from scanned records (consumes scan results). */
+  void merge(std::vector<RecordScan>& vec_scan);
+  /** Release all storage. */
+  void clear();
+
+  /** Get total number of occurrences of a context. */
+  TCoord count(const unsigned ctx) const;
+  /**
+   * Locate the k-th occurrence of a context.
+   *
+   * \param ctx      context code
+   * \param k        occurrence rank (0-based, must be less than count(ctx))
+   * \param records  sequence records the index was built from
+   * \returns        global position of occurrence
+   */
+  TCoord select(
+    const unsigned ctx,
+    const TCoord k,
+    const std::vector<std::shared_ptr<SeqRecord>>& records
+  ) const;
+
+  /** Get context code for a nucleotide index. */
+  static unsigned getNucContext(const short idx_nuc) { return idx_nuc; }
+  /** Get context code for a trinucleotide (-1 if invalid). */
+  static int getTrinucContext(const std::string& trinuc);
+  /** Number of bytes occupied by index. */
+  size_t getMemoryUsage() const;
+};
+
+} // namespace seqio
+
+#endif // CONTEXTINDEX_H
@@ -0,0 +1,127 @@
+#include "CopyNumberProfile.hpp"
+#include <algorithm>
+#include <cassert>
+#include <tuple>
+
+using namespace std;
+
+namespace seqio {
+
+CopyNumberProfile::CopyNumberProfile () {}
+
+void
+CopyNumberProfile::append (
+  const TCoord end,
+  const double count_A,
+  const double count_B
+)
+{
+  assert( m_bkp.size() > 0 && end > m_bkp.back() );
+  if (numIntervals() > 0 && m_count_A.back() == count_A && m_count_B.back() == count_B) {
+    m_bkp.back() = end;
+    return;
+  }
+  m_bkp.push_back(end);
+  m_count_A.push_back(count_A);
+  m_count_B.push_back(count_B);
+}
+
+void
+CopyNumberProfile::build (
+  const vector<SegmentCopy>& segments
+)
+{
+  m_bkp.clear();
+  m_count_A.clear();
+  m_count_B.clear();
+  if (segments.size() == 0)
+    return;
+
+  // SegmentCopy boundaries, structure: (position, change of A count, change of B count)
+  vector<tuple<TCoord, int, int>> vec_evt;
+  vec_evt.reserve(2*segments.size());
+  for (auto const & seg : segments) {
+    assert( seg.ref_start < seg.ref_end );
+    int is_A = (seg.gl_allele == 'A') ? 1 : 0;
+    vec_evt.push_back(make_tuple(seg.ref_start, is_A, 1-is_A));
+    vec_evt.push_back(make_tuple(seg.ref_end, -is_A, is_A-1));
+  }
+  sort(vec_evt.begin(), vec_evt.end());
+
+  // sweep over boundaries, keeping track of allele counts
+  int count_A = 0, count_B = 0;
+  m_bkp.push_back(get<0>(vec_evt[0]));
+  size_t i = 0;
+  while (i < vec_evt.size()) {
+    TCoord pos = get<0>(vec_evt[i]);
+    if (pos > m_bkp.back())
+      append(pos, count_A, count_B);
+    for (; i < vec_evt.size() && get<0>(vec_evt[i]) == pos; ++i) {
+      count_A += get<1>(vec_evt[i]);
+      count_B += get<2>(vec_evt[i]);
+    }
+  }
+  assert( count_A == 0 && count_B == 0 );
+}
+
+void
+CopyNumberProfile::build (
+  const vector<const CopyNumberProfile*>& vec_profile,
+  const vector<double>& vec_weight
+)
+{
+  assert( vec_profile.size() == vec_weight.size() );
+  m_bkp.clear();
+  m_count_A.clear();
+  m_count_B.clear();
+
+  // union of breakpoints
+  vector<TCoord> vec_bkp;
+  for (auto const p : vec_profile)
+    vec_bkp.insert(vec_bkp.end(), p->m_bkp.begin(), p->m_bkp.end());
+  sort(vec_bkp.begin(), vec_bkp.end());
+  vec_bkp.erase(unique(vec_bkp.begin(), vec_bkp.end()), vec_bkp.end());
+  if (vec_bkp.size() < 2)
+    return;
+
+  // sweep over elementary intervals, keeping current interval of each profile
+  vector<size_t> vec_idx(vec_profile.size(), 0);
+  m_bkp.push_back(vec_bkp[0]);
+  for (size_t j = 0; j+1 < vec_bkp.size(); ++j) {
+    TCoord pos = vec_bkp[j];
+    double count_A = 0.0, count_B = 0.0;
+    for (size_t k = 0; k < vec_profile.size(); ++k) {
+      const CopyNumberProfile& p = *vec_profile[k];
+      if (p.numIntervals() == 0 || pos < p.m_bkp.front() || pos >= p.m_bkp.back())
+        continue;
+      while (p.m_bkp[vec_idx[k]+1] <= pos)
+        ++vec_idx[k];
+      count_A += vec_weight[k] * p.m_count_A[vec_idx[k]];
+      count_B += vec_weight[k] * p.m_count_B[vec_idx[k]];
+    }
+    append(vec_bkp[j+1], count_A, count_B);
+  }
+}
+
+size_t
+CopyNumberProfile::find (
+  const TCoord pos
+) const
+{
+  if (numIntervals() == 0 || pos < m_bkp.front() || pos >= m_bkp.back())
+    return numIntervals();
+  return upper_bound(m_bkp.begin(), m_bkp.end(), pos) - m_bkp.begin() - 1;
+}
+
+TCoord
+CopyNumberProfile::getAbsoluteLength () const
+{
+  TCoord len = 0;
+  for (size_t i = 0; i < numIntervals(); ++i) {
+    TCoord itvl_len = m_bkp[i+1] - m_bkp[i];
+    len += TCoord(itvl_len * (m_count_A[i] + m_count_B[i]));
+  }
+  return len;
+}
+
+} // namespace seqio
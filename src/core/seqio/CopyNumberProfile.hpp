@@ -0,0 +1,64 @@
+#ifndef COPYNUMBERPROFILE_H
+#define COPYNUMBERPROFILE_H
+
+#include "SegmentCopy.hpp"
+#include "types.hpp"
+#include <vector>
+
+namespace seqio {
+
+/** Allele-specific copy number state along a chromosome.
+ *
+ *  The reference is partitioned into intervals at SegmentCopy boundaries,
+ *  copy numbers of the maternal (A) and paternal (B) allele are stored for
+ *  each interval in flat arrays. Neighbouring intervals with identical copy
+ *  numbers are joined. Regions not covered by any SegmentCopy are kept as
+ *  intervals with zero copy number (cf. isCovered()) to keep breakpoints
+ *  contiguous.
+ */
+struct CopyNumberProfile {
+  /** interval boundaries: interval i is [m_bkp[i], m_bkp[i+1]) */
+  std::vector<TCoord> m_bkp;
+  /** copy number of maternal allele for each interval */
+  std::vector<double> m_count_A;
+  /** copy number of paternal allele for each interval */
+  std::vector<double> m_count_B;
+
+  /** default c'tor */
+  CopyNumberProfile();
+
+  /** Count SegmentCopies of each allele (replaces existing content). */
+  void build(const std::vector<SegmentCopy>& segments);
+
+  /** Build weighted sum of copy number profiles (replaces existing content).
+   *  \param vec_profile  Copy number profiles (e.g. of clones).
+   *  \param vec_weight   Weight of each profile (e.g. cell fraction of clone).
+   */
+  void
+  build (
+    const std::vector<const CopyNumberProfile*>& vec_profile,
+    const std::vector<double>& vec_weight
+  );
+
+  /** Number of intervals. */
+  size_t numIntervals() const { return m_count_A.size(); }
+
+  /** Is interval covered by SegmentCopies (i.e., has non-zero copy number)? */
+  bool isCovered(const size_t i) const { return m_count_A[i] != 0.0 || m_count_B[i] != 0.0; }
+
+  /** Find interval containing a reference position.
+   *  \returns index of interval, numIntervals() if position is outside profile.
+   */
+  size_t find(const TCoord pos) const;
+
+  /** Sum of interval lengths, each multiplied by its total copy number. */
+  TCoord getAbsoluteLength() const;
+
+private:
+  /** Append interval (joined with last interval if copy numbers are equal). */
+  void append(const TCoord end, const double count_A, const double count_B);
+};
+
+} // namespace seqio
+
+#endif // COPYNUMBERPROFILE_H
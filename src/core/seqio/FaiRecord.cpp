@@ -0,0 +1,8 @@
+#include "FaiRecord.hpp"
+
+namespace seqio {
+
+FaiRecord::FaiRecord()
+: name(""), length(0), offset(0), line_bases(0), line_width(0) {}
+
+} // namespace seqio
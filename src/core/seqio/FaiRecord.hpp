@@ -0,0 +1,30 @@
+#ifndef FAIRECORD_H
+#define FAIRECORD_H
+
+#include "types.hpp"
+#include <cstdint>
+#include <string>
+
+namespace seqio {
+
+/** Entry of a FASTA index (.fai), compatible with `samtools faidx`. */
+struct FaiRecord
+{
+  std::string name;     /** sequence name (up to first whitespace) */
+  TCoord   length;      /** number of bases */
+  uint64_t offset;      /** byte offset of first base in FASTA file */
+  unsigned line_bases;  /** number of bases per line */
+  unsigned line_width;  /** number of bytes per line (incl. newline) */
+
+  /** default c'tor */
+  FaiRecord();
+
+  /** Byte offset of a sequence position in FASTA file. */
+  inline uint64_t getOffset(const TCoord pos) const {
+    return offset + (pos / line_bases) * line_width + (pos % line_bases);
+  }
+};
+
+} // namespace seqio
+
+#endif // FAIRECORD_H
@@ -6,19 +6,24 @@ using boost::icl::interval;
 
 namespace seqio {
 
-GenomeInstance::GenomeInstance () {}
+GenomeInstance::GenomeInstance ()
+: sp_ids(new SegmentIdAllocator()) {}
 
 GenomeInstance::GenomeInstance (
-  const GenomeReference& g_ref
+  const GenomeReference& g_ref,
+  shared_ptr<SegmentIdAllocator> sp_ids
 )
+: sp_ids(sp_ids ? sp_ids : make_shared<SegmentIdAllocator>())
 {
+  // SegmentTree nodes of all derived genomes are kept in a common arena
+  shared_ptr<SegmentTree::Arena> sp_arena = make_shared<SegmentTree::Arena>();
   for (auto const & kv : g_ref.chromosomes) {
     ChromosomeReference chr_ref = *(kv.second);
     // initial genome state is diploid -> generate two instances of each chromosome
-    shared_ptr<ChromosomeInstance> sp_chr_inst1(new ChromosomeInstance(chr_ref, 'A'));
+    shared_ptr<ChromosomeInstance> sp_chr_inst1(new ChromosomeInstance(chr_ref, 'A', this->sp_ids, sp_arena));
     this->vec_chr.push_back(sp_chr_inst1);
     this->vec_chr_len.push_back(sp_chr_inst1->length);
-    shared_ptr<ChromosomeInstance> sp_chr_inst2(new ChromosomeInstance(chr_ref, 'B'));
+    shared_ptr<ChromosomeInstance> sp_chr_inst2(new ChromosomeInstance(chr_ref, 'B', this->sp_ids, sp_arena));
     this->vec_chr.push_back(sp_chr_inst2);
     this->vec_chr_len.push_back(sp_chr_inst2->length);
     // sanity check: chromsome IDs should be unique
@@ -30,27 +35,82 @@ GenomeInstance::GenomeInstance (
 }
 
 GenomeInstance::GenomeInstance (
-  const GenomeInstance& g_inst, 
-  vector<seg_mod_t>& out_vec_seg_mod
+  const GenomeInstance& g_inst
 )
+: vec_chr(g_inst.vec_chr),
+  vec_chr_len(g_inst.vec_chr_len),
+  map_id_chr(g_inst.map_id_chr),
+  map_chr_seg(g_inst.map_chr_seg),
+  sp_ids(g_inst.sp_ids)
 {
-  // copy chromosome lengths
-  this->vec_chr_len = g_inst.vec_chr_len;
+  // ChromosomeInstances are now referenced by both GenomeInstances
+  // (only flag private ones, shared ones may be read concurrently)
+  for (auto const & sp_chr : this->vec_chr) {
+    if (!sp_chr->is_shared)
+      sp_chr->is_shared = true;
+  }
+}
 
-  // copy chromosome instances and index by name
-  for (auto const & id_chr : g_inst.map_id_chr) {
-    string id = id_chr.first;
-    
-    // update chromosome name index
-    this->map_id_chr[id] = vector<shared_ptr<ChromosomeInstance>>();
-
-    for (const shared_ptr<ChromosomeInstance> ci_old : id_chr.second) {
-      ChromosomeInstance ci_new;
-      ci_new.copy(ci_old, out_vec_seg_mod);
-      this->vec_chr.push_back(make_shared<ChromosomeInstance>(ci_new));
-      this->map_id_chr[id].push_back(make_shared<ChromosomeInstance>(ci_new));
+GenomeInstance&
+GenomeInstance::operator= (
+  const GenomeInstance& g_inst
+)
+{
+  if (this != &g_inst) {
+    this->vec_chr = g_inst.vec_chr;
+    this->vec_chr_len = g_inst.vec_chr_len;
+    this->map_id_chr = g_inst.map_id_chr;
+    this->map_chr_seg = g_inst.map_chr_seg;
+    this->sp_ids = g_inst.sp_ids;
+    for (auto const & sp_chr : this->vec_chr) {
+      if (!sp_chr->is_shared)
+        sp_chr->is_shared = true;
+    }
+  }
+  return *this;
+}
+
+shared_ptr<ChromosomeInstance>
+GenomeInstance::unshareChromosome (
+  const string& id_chr,
+  const size_t idx_chr
+)
+{
+  assert( this->map_id_chr.count(id_chr) > 0 );
+  assert( idx_chr < this->map_id_chr[id_chr].size() );
+  shared_ptr<ChromosomeInstance> sp_chr = this->map_id_chr[id_chr][idx_chr];
+  if (!sp_chr->is_shared)
+    return sp_chr;
+
+  // replace shared ChromosomeInstance by a private copy (retaining SegmentCopies)
+  shared_ptr<ChromosomeInstance> sp_chr_new(new ChromosomeInstance(*sp_chr));
+  sp_chr_new->sp_ids = this->sp_ids;
+  sp_chr_new->is_shared = false;
+  sp_chr_new->id_seg_owned = this->sp_ids->next_id;
+  this->map_id_chr[id_chr][idx_chr] = sp_chr_new;
+  replace(this->vec_chr.begin(), this->vec_chr.end(), sp_chr, sp_chr_new);
+
+  return sp_chr_new;
+}
+
+TSegId
+GenomeInstance::unshareSegmentCopy (
+  const string& id_chr,
+  const SegmentCopy& seg,
+  vector<seg_mod_t>& out_vec_seg_mod
+)
+{
+  assert( this->map_id_chr.count(id_chr) > 0 );
+  const vector<shared_ptr<ChromosomeInstance>>& vec_ci = this->map_id_chr[id_chr];
+  for (size_t i=0; i<vec_ci.size(); ++i) {
+    if (vec_ci[i]->hasSegmentCopy(seg)) {
+      shared_ptr<ChromosomeInstance> sp_chr = this->unshareChromosome(id_chr, i);
+      return sp_chr->unshareSegmentCopy(seg, out_vec_seg_mod);
     }
   }
+
+  assert( false ); // SegmentCopy not part of this GenomeInstance
+  return seg.id;
 }
 
 void
@@ -98,6 +158,7 @@ GenomeInstance::duplicate (
     // copy all chromosomes under current chromosome ID
     for (auto const & ci_old : kv.second) {
       shared_ptr<ChromosomeInstance> ci_new(new ChromosomeInstance());
+      ci_new->sp_ids = this->sp_ids;
       ci_new->copy(ci_old, out_vec_seg_mod);
       vec_tpl_id_ci.push_back(make_tuple(kv.first, ci_new));
     }
@@ -135,12 +196,12 @@ GenomeInstance::getCopyNumberStates(
   // for all chromosomes
   for ( auto const & id_chr : this->map_id_chr ) {
     string id = id_chr.first;
-    interval_map<unsigned long, int> imap_reg_cn;
+    interval_map<TCoord, int> imap_reg_cn;
     // for all ChromosomeInstances
     for ( auto const & sp_chr : id_chr.second ) {
       // for all SegmentCopies
-      for ( auto const & seg : sp_chr->lst_segments ) {
-        auto i_reg = interval<unsigned long>::right_open(seg.ref_start, seg.ref_end);
+      for ( auto const & seg : sp_chr->segments ) {
+        auto i_reg = interval<TCoord>::right_open(seg.ref_start, seg.ref_end);
         imap_reg_cn += make_pair(i_reg, 1);
       }
     }
@@ -170,7 +231,7 @@ GenomeInstance::getCopyNumberStateByChr (
     // infer segment-wise copy number for each ChromosomeInstance
     for ( auto const chr : id_chr.second ) {
       // each SegmentCopy increases the CN state for the corresponding region
-      for ( auto const & seg : chr->lst_segments ) {
+      for ( auto const & seg : chr->segments ) {
         // NOTE: if this ever fails: switch start and end coordinates (or can interval_map deal with that?)
         assert( seg.ref_start < seg.ref_end );
         auto i = interval<TCoord>::right_open(seg.ref_start, seg.ref_end);
@@ -194,7 +255,7 @@ GenomeInstance::getCopyNumberStateByChr (
     // infer segment-wise copy number for each ChromosomeInstance
     for ( auto const chr : id_chr.second ) {
       // each SegmentCopy increases the CN state for the corresponding region
-      for ( auto const & seg : chr->lst_segments ) {
+      for ( auto const & seg : chr->segments ) {
         // NOTE: if this ever fails: switch start and end coordinates (or can interval_map deal with that?)
         assert( seg.ref_start < seg.ref_end );
         auto i = interval<TCoord>::right_open(seg.ref_start, seg.ref_end);
@@ -211,6 +272,18 @@ GenomeInstance::getCopyNumberStateByChr (
   }
 }
 
+void
+GenomeInstance::getCopyNumberProfiles (
+  map<string, CopyNumberProfile>& out_map_chr_cn
+) const
+{
+  for ( auto const & id_chr : map_id_chr ) {
+    vector<SegmentCopy> vec_seg;
+    for ( auto const & chr : id_chr.second )
+      vec_seg.insert(vec_seg.end(), chr->segments.begin(), chr->segments.end());
+    out_map_chr_cn[id_chr.first].build(vec_seg);
+  }
+}
 
 bool
 GenomeInstance::indexSegmentCopies ()
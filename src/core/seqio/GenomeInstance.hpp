@@ -2,6 +2,7 @@
 #define GENOMEINSTANCE_H
 
 #include "AlleleSpecCopyNum.hpp"
+#include "CopyNumberProfile.hpp"
 #include "GenomeReference.hpp"
 #include "ChromosomeInstance.hpp"
 
@@ -11,16 +12,22 @@ namespace seqio {
  *
  *  A GenomeInstance consists of a set of ChromosomeInstances,
  *  which in turn consist of SegmentCopies.
+ *
+ *  Copies of a GenomeInstance share their ChromosomeInstances (and
+ *  SegmentCopies) until they are modified (copy-on-write). Modifications
+ *  therefore must go through unshareChromosome() / unshareSegmentCopy().
  */
 struct GenomeInstance {
   /** Stores the ChromosomeInstances that make up this GenomeInstance. */
   std::vector<std::shared_ptr<ChromosomeInstance>> vec_chr;
   /** Stores for each ChromosomeInstance its real length. Used to randomly select a chromosome by length. */
-  std::vector<unsigned long> vec_chr_len;
+  std::vector<TCoord> vec_chr_len;
   /** ChromosomeInstances indexed by reference id. */
   std::map<std::string, std::vector<std::shared_ptr<ChromosomeInstance>>> map_id_chr;
   /** SegmentCopy interval maps indexed by chromosome id. */
   std::map<std::string, TSegMap> map_chr_seg;
+  /** Allocator for SegmentCopy identifiers (shared by genomes derived from each other). */
+  std::shared_ptr<SegmentIdAllocator> sp_ids;
 
   /** default c'tor */
   GenomeInstance();
@@ -28,19 +35,28 @@ struct GenomeInstance {
   /** Create GenomeInstance from GenomeReference object
    *
    *  Create a diploid genome by initializing 2 ChromosomeInstances
-   *  for each ChromosomeReference.
+   *  for each ChromosomeReference. Their SegmentCopies (and those of all
+   *  genomes derived from this one) are stored in a common SegmentTree::Arena,
+   *  which is released once the last of these genomes is destroyed.
+   *  \param g_ref   Reference genome.
+   *  \param sp_ids  Allocator for SegmentCopy identifiers (default: create new one).
    */
-  GenomeInstance(const GenomeReference& g_ref);
+  GenomeInstance(
+    const GenomeReference& g_ref,
+    std::shared_ptr<SegmentIdAllocator> sp_ids = nullptr
+  );
 
   /**
    * Create GenomeInstance as copy of existing object.
-   * \param g_inst          Existing GenomeInstance to be copied.
-   * \param out_vec_seg_mod Output param: mapping from original to new segment copy IDs.
+   * ChromosomeInstances are shared with g_inst until either one modifies them.
+   * New SegmentCopies draw their identifiers from the allocator of g_inst.
+   * \param g_inst  Existing GenomeInstance to be copied.
    */
-  GenomeInstance(
-    const GenomeInstance& g_inst,
-    std::vector<seg_mod_t>& out_vec_seg_mod
-  );
+  GenomeInstance(const GenomeInstance& g_inst);
+
+  /** Assign copy of existing GenomeInstance (cf. copy c'tor). */
+  GenomeInstance&
+  operator= (const GenomeInstance& g_inst);
 
   /** Adds a ChromosomeInstance to this GenomeInstance.
    *  \param sp_chr shared pointer to ChromosomeInstance
@@ -71,11 +87,37 @@ struct GenomeInstance {
   void
   duplicate(std::vector<seg_mod_t>& out_vec_seg_mod);
 
+  /** Get ChromosomeInstance for modification.
+   *  A ChromosomeInstance shared with other GenomeInstances is replaced by a private copy.
+   *  \param id_chr  reference ID of chromosome
+   *  \param idx_chr index of ChromosomeInstance among instances of id_chr
+   *  \returns       ChromosomeInstance that can be modified
+   */
+  std::shared_ptr<ChromosomeInstance>
+  unshareChromosome (
+    const std::string& id_chr,
+    const size_t idx_chr
+  );
+
+  /** Get SegmentCopy for modification (e.g., adding an SNV).
+   *  A SegmentCopy inherited from another GenomeInstance is replaced by one with a new id.
+   *  \param id_chr          reference ID of chromosome containing SegmentCopy
+   *  \param seg             SegmentCopy to be modified
+   *  \param out_vec_seg_mod Output parameter: SegmentCopy modifications (id_new, id_old, start_old, end_old)
+   *  \returns               id of SegmentCopy that can be modified
+   */
+  TSegId
+  unshareSegmentCopy (
+    const std::string& id_chr,
+    const SegmentCopy& seg,
+    std::vector<seg_mod_t>& out_vec_seg_mod
+  );
+
   /** Identify SequenceCopies overlapping a given locus. */
   std::vector<SegmentCopy>
   getSegmentCopiesAt (
     std::string id_chromosome,
-    unsigned long ref_pos
+    TCoord ref_pos
   );
 
   /**DEPRECATED!
@@ -107,6 +149,14 @@ struct GenomeInstance {
     const double scale = 1.0
   ) const;
 
+  /** Compute allele-specific copy number profile for each chromosome.
+   *  \param out_map_chr_cn  Output param: copy number profiles by chromosome id.
+   */
+  void
+  getCopyNumberProfiles (
+    std::map<std::string, CopyNumberProfile>& out_map_chr_cn
+  ) const;
+
   /** Build interval map of SegmentCopies for each chromosome.
    *  Used to answer questions like: 
    *    "Which SegmentCopies overlap interval 'chr1:10,000-10,500'?"
@@ -1,6 +1,10 @@
 #include "../seqio.hpp"
+#include "BinaryIO.hpp"
 #include "GenomeReference.hpp"
+#include <algorithm> // upper_bound()
 #include <cmath> // floor()
+#include <cstring>
+#include <sys/stat.h>
 
 using namespace std;
 
@@ -16,8 +20,18 @@ GenomeReference::GenomeReference(const char* filename) : length(0), masked_lengt
   for (int i=0; i<4; i++)
     nuc_freq[i] = 0;
 
-  // read records from file
-  readFasta(filename, this->records);
+  // read records from file:
+  //  - .2bit: sequences are kept 2-bit packed
+  //  - FASTA: file is memory-mapped, sequences are accessed via index (.fai)
+  //           (fall back to parsing and packing if FASTA cannot be indexed)
+  string fn(filename);
+  if (fn.length() > 5 && fn.substr(fn.length()-5) == ".2bit") {
+    readTwoBit(filename, this->records);
+  }
+  else if (!readFastaMapped(filename, this->records)) {
+    this->records.clear();
+    readFasta(filename, this->records, true);
+  }
   // scan records for segmented sequence (naming convention: "CHR:START-END")
   for (auto & rec : this->records) {
     // TODO: does it make sense to expect genomic fragments in FASTA?
@@ -40,7 +54,7 @@ GenomeReference::GenomeReference(const char* filename) : length(0), masked_lengt
     // }
     shared_ptr<ChromosomeReference> p_chr_ref(new ChromosomeReference());
     p_chr_ref->id = rec->id;
-    p_chr_ref->length = rec->seq.length();
+    p_chr_ref->length = rec->length();
     p_chr_ref->map_start_rec[0] = rec;
     // sanity check: chromosome IDs should be unique
     assert(this->chromosomes.count(p_chr_ref->id) == 0);
@@ -56,7 +70,7 @@ void GenomeReference::addChromosome(shared_ptr<ChromosomeReference> sp_chr) {
 }
 
 void GenomeReference::generate_nucfreqs (
-  const unsigned long total_len,
+  const TCoord total_len,
   const vector<double> nuc_freqs,
   RandomNumberGenerator &rng
 ) {
@@ -72,23 +86,23 @@ void GenomeReference::generate_nucfreqs (
  * \param object to generate random numbers
  */
 void GenomeReference::generate_nucfreqs (
-  const unsigned long total_len,
+  const TCoord total_len,
   const unsigned short num_chr,
   const vector<double> nuc_freqs,
   RandomNumberGenerator &rng
 ) {
   // generate random genomic sequence
   string seq;
-  unsigned long gen_len = 0;
+  TCoord gen_len = 0;
   gen_len = generateRandomDnaSeq(seq, total_len, nuc_freqs, rng);
 
   // generate chromosome limits
-  vector<unsigned long> chr_ends = { 0 };
+  vector<TCoord> chr_ends = { 0 };
   if (num_chr > 1) {
-    unsigned long zero = 0;
-    function<unsigned long()> rpos = rng.getRandomFunctionInt(zero, total_len);
+    TCoord zero = 0;
+    function<TCoord()> rpos = rng.getRandomFunctionInt(zero, total_len);
     for (auto i=0; i<num_chr-1; ++i) {
-      unsigned long p = rpos();
+      TCoord p = rpos();
       chr_ends.push_back(p);
     }
     sort(chr_ends.begin(), chr_ends.end());
@@ -96,7 +110,7 @@ void GenomeReference::generate_nucfreqs (
   chr_ends.push_back(total_len);
 
   // split genome into chromosome sequences
-  unsigned long cum_start = 0;
+  TCoord cum_start = 0;
   string::iterator it_start = seq.begin();
   string::iterator it_end = seq.begin();
   for (auto i=0; i<num_chr; ++i) {
@@ -104,6 +118,7 @@ void GenomeReference::generate_nucfreqs (
     advance(it_end, chr_ends[i+1]-chr_ends[i]);
     string id_chr = stringio::format("chr%d", i);
     shared_ptr<SeqRecord> sp_rec(new SeqRecord(id_chr, "random sequence", string(it_start, it_end)));
+    sp_rec->pack();
     this->records.push_back(sp_rec);
     // instantiate new referennce chromosome
     shared_ptr<ChromosomeReference> sp_chr(new ChromosomeReference());
@@ -119,35 +134,43 @@ void GenomeReference::generate_nucfreqs (
 /** generate random genome by given number of fragments, mean len, sd len, nuc freqs */
 void GenomeReference::generate_nucfreqs (
   const unsigned num_seqs,
-  const unsigned long mean_len,
-  const unsigned long sd_len,
+  const TCoord mean_len,
+  const TCoord sd_len,
   const vector<double> nuc_freqs,
   RandomNumberGenerator& rng)
 {
   // set sequence lengths
-  vector<unsigned long> vec_seq_len(num_seqs);
+  vector<TCoord> vec_seq_len(num_seqs);
   if (sd_len > 0) { // sample from Gamma distribution
     function<double()> rlen = rng.getRandomFunctionGammaMeanSd(mean_len, sd_len);
     generate(vec_seq_len.begin(), vec_seq_len.end(), rlen);
-    sort(vec_seq_len.begin(), vec_seq_len.end(), std::greater<unsigned long>());
+    sort(vec_seq_len.begin(), vec_seq_len.end(), std::greater<TCoord>());
   }
   else { // fixed length for all sequences
     fill(vec_seq_len.begin(), vec_seq_len.end(), mean_len);
   }
 
-  // simulate sequences
-  unsigned idx_chr = 1;
-  for (auto l : vec_seq_len) {
-    string seq;
-    generateRandomDnaSeq(seq, l, nuc_freqs, rng);
-    string id_chr = stringio::format("chr%d", idx_chr++);
-    shared_ptr<SeqRecord> sp_rec(new SeqRecord(id_chr, "random sequence", seq));
-    sp_rec->id_ref = sp_rec->id;
+  // simulate sequences in parallel
+  // (each sequence uses its own random stream, result is independent of thread count)
+  uint64_t seed_chr = rng.getStreamSeed();
+  vector<shared_ptr<SeqRecord>> vec_rec(num_seqs);
+  #pragma omp parallel for schedule(dynamic)
+  for (long i = 0; i < long(num_seqs); ++i) {
+    RandomNumberGenerator rng_chr(seed_chr, i);
+    string id_chr = stringio::format("chr%ld", i+1);
+    vec_rec[i] = make_shared<SeqRecord>(id_chr, "random sequence", "");
+    vec_rec[i]->id_ref = id_chr;
+    generateRandomDnaSeq(vec_rec[i]->seq_packed, vec_seq_len[i], nuc_freqs, rng_chr);
+    vec_rec[i]->is_packed = true;
+  }
+
+  // add sequences in order
+  for (auto sp_rec : vec_rec) {
     this->records.push_back(sp_rec);
     // instantiate new referennce chromosome
     shared_ptr<ChromosomeReference> sp_chr(new ChromosomeReference());
-    sp_chr->id = id_chr;
-    sp_chr->length = seq.length();
+    sp_chr->id = sp_rec->id;
+    sp_chr->length = sp_rec->length();
     sp_chr->map_start_rec[0] = sp_rec;
     this->addChromosome(sp_chr);
   }
@@ -163,9 +186,9 @@ void GenomeReference::generate_nucfreqs (
  */
 bool GenomeReference::generate_kmer (
   const unsigned num_seqs,
-  const unsigned long mean_len,
-  const unsigned long sd_len,
-  const KmerProfile kmer_prof,
+  const TCoord mean_len,
+  const TCoord sd_len,
+  const KmerProfile& kmer_prof,
   RandomNumberGenerator& rng)
 {
   // make sure KmerProfile has prefixes indexed
@@ -175,29 +198,37 @@ bool GenomeReference::generate_kmer (
   //---------------------------------------------------------------------------
 
   // set sequence lengths
-  vector<unsigned long> vec_seq_len(num_seqs);
+  vector<TCoord> vec_seq_len(num_seqs);
   if (sd_len > 0) { // sample from Gamma distribution
     function<double()> rlen = rng.getRandomFunctionGammaMeanSd(mean_len, sd_len);
     generate(vec_seq_len.begin(), vec_seq_len.end(), rlen);
-    sort(vec_seq_len.begin(), vec_seq_len.end(), std::greater<unsigned long>());
+    sort(vec_seq_len.begin(), vec_seq_len.end(), std::greater<TCoord>());
   }
   else { // fixed length for all sequences
     fill(vec_seq_len.begin(), vec_seq_len.end(), mean_len);
   }
 
-  // simulate sequences
-  unsigned idx_chr = 1;
-  for (auto l : vec_seq_len) {
-    string seq;
-    generateRandomDnaSeq(seq, l, kmer_prof, rng);
-    string id_chr = stringio::format("chr%d", idx_chr++);
-    shared_ptr<SeqRecord> sp_rec(new SeqRecord(id_chr, "random sequence", seq));
-    sp_rec->id_ref = sp_rec->id;
+  // simulate sequences in parallel, directly into packed storage
+  // (each sequence uses its own random stream, result is independent of thread count)
+  uint64_t seed_chr = rng.getStreamSeed();
+  vector<shared_ptr<SeqRecord>> vec_rec(num_seqs);
+  #pragma omp parallel for schedule(dynamic)
+  for (long i = 0; i < long(num_seqs); ++i) {
+    RandomNumberGenerator rng_chr(seed_chr, i);
+    string id_chr = stringio::format("chr%ld", i+1);
+    vec_rec[i] = make_shared<SeqRecord>(id_chr, "random sequence", "");
+    vec_rec[i]->id_ref = id_chr;
+    generateRandomDnaSeq(vec_rec[i]->seq_packed, vec_seq_len[i], kmer_prof, rng_chr);
+    vec_rec[i]->is_packed = true;
+  }
+
+  // add sequences in order
+  for (auto sp_rec : vec_rec) {
     this->records.push_back(sp_rec);
     // instantiate new referennce chromosome
     shared_ptr<ChromosomeReference> sp_chr(new ChromosomeReference());
-    sp_chr->id = id_chr;
-    sp_chr->length = seq.length();
+    sp_chr->id = sp_rec->id;
+    sp_chr->length = sp_rec->length();
     sp_chr->map_start_rec[0] = sp_rec;
     this->addChromosome(sp_chr);
   }
@@ -207,72 +238,53 @@ bool GenomeReference::generate_kmer (
 }
 
 /** Scan genome and store structural information.
+  *  Records are scanned in parallel, results are merged in record order.
   *  1) index chromosomes (start positions in genome)
   *  2) index unmasked regions (start positions in genome)
   *  3) count nucleotide frequencies
-  *  4) index bp positions into buckets by nucleotide
+  *  4) index positions of nucleotides and tri-nucleotides
   */
 void GenomeReference::indexRecords() {
-  // initialize data structures
-  vector<unsigned> nuc_count(4, 0); // nucleotide counter
-  nuc_pos = vector<vector<long> >(4); // nucleotide buckets
-  unsigned cum_start = 0; // global start position
+  // scan records in parallel (one pass per record)
+  long num_rec = records.size();
+  vector<ContextIndex::RecordScan> vec_scan(num_rec);
+  #pragma omp parallel for schedule(dynamic)
+  for (long i = 0; i < num_rec; ++i)
+    ContextIndex::scanRecord(*records[i], vec_scan[i]);
+
+  // merge per-record results (in record order) into global indices
+  TCoord cum_start = 0; // global start position
   vec_start_chr.clear(); // start positions of sequences
-  boost::circular_buffer<string> trinuc(3);  // next trinucleotide to index
-  // 3mer index
-  map_3mer_pos.clear();
-  char nucs[4] = { 'A', 'C', 'G', 'T' };
-  for (auto n1 : nucs) {
-    for (auto n2 : nucs) {
-      for (auto n3 : nucs) {
-        string key = string(1, n1) + string(1, n2) + string(1, n3);
-        map_3mer_pos[key] = vector<long>();
-      }
-    }
-  }
-
   vec_start_chr.push_back(cum_start);
-  for (auto const & rec : records) {
-    unsigned seq_len = rec->seq.length();
+  vec_start_masked.clear();
+  vec_cumlen_masked.clear();
+  masked_length = 0;
+  for (auto const & scan : vec_scan) {
     // index unmasked regions (those that are not 'N')
-    unsigned p = 0;
-    bool is_new_region = false;
-    string::const_iterator it = rec->seq.begin();
-    while (it!=rec->seq.end()) {
-      short nuc = nuc2idx(*it);
-      // skip to next unmasked position
-      while (it!=rec->seq.end() && nuc == -1) { it++; p++; nuc=nuc2idx(*it); }
-      trinuc.clear(); // clear out previous trinucleotide
-      // process seq until next masked position
-      while (it!=rec->seq.end() && nuc > -1) {
-        if (!is_new_region) {
-          is_new_region = true;
-          vec_start_masked.push_back(cum_start + p);
-        }
-        nuc_count[nuc]++;
-        nuc_pos[nuc].push_back(cum_start + p);
-        trinuc.push_back(string(1, *it)); // new nuc will push out oldest one from circular buffer
-        if (trinuc.size() == 3) {
-          string tn = trinuc[0] + trinuc[1] + trinuc[2];
-          map_3mer_pos[tn].push_back(cum_start + p - 2);
-        }
-        it++; p++; masked_length++;
-        nuc = nuc2idx(*it);
-      }
-      if (is_new_region) {
-        vec_cumlen_masked.push_back(masked_length);
-        is_new_region = false;
-      }
+    for (auto const & region : scan.vec_unmasked) {
+      vec_start_masked.push_back(cum_start + region.first);
+      masked_length += region.second;
+      vec_cumlen_masked.push_back(masked_length);
     }
-    cum_start += seq_len;
+    cum_start += scan.length;
     vec_start_chr.push_back(cum_start);
   }
   length = vec_start_chr[num_records];
+
+  // index positions of nucleotides and tri-nucleotides
+  idx_context.merge(vec_scan);
+  this->updateNucFreqs();
+}
+
+void GenomeReference::updateNucFreqs() {
+  vector<TCoord> nuc_count(4, 0); // nucleotide counter
+  for (short i=0; i<4; ++i)
+    nuc_count[i] = countNuc(i);
 fprintf(stderr, "\nGenome stats:\n");
 fprintf(stderr, "  records:\t\t%u\n", num_records);
-fprintf(stderr, "  length:\t\t%u\n", length);
-fprintf(stderr, "  length (masked):\t%u\n", masked_length);
-fprintf(stderr, "Nucleotide counts:\n  A:%u\n  C:%u\n  G:%u\n  T:%u\n", nuc_count[0], nuc_count[1], nuc_count[2], nuc_count[3]);
+fprintf(stderr, "  length:\t\t%lu\n", length);
+fprintf(stderr, "  length (masked):\t%lu\n", masked_length);
+fprintf(stderr, "Nucleotide counts:\n  A:%lu\n  C:%lu\n  G:%lu\n  T:%lu\n", nuc_count[0], nuc_count[1], nuc_count[2], nuc_count[3]);
   // calculate nucleotide frequencies (ACGT)
   double num_acgt = nuc_count[0] + nuc_count[1] + nuc_count[2] + nuc_count[3];
   nuc_freq[0] = nuc_count[0]/num_acgt;
@@ -282,78 +294,332 @@ fprintf(stderr, "Nucleotide counts:\n  A:%u\n  C:%u\n  G:%u\n  T:%u\n", nuc_coun
 fprintf(stderr, "Nucleotide freqs:\n  A:%0.4f\n  C:%0.4f\n  G:%0.4f\n  T:%0.4f\n", nuc_freq[0], nuc_freq[1], nuc_freq[2], nuc_freq[3]);
 }
 
-Locus GenomeReference::getLocusByGlobalPos(long global_pos) const {
-  int idx_seq = 0;
-  while (global_pos >= vec_start_chr[idx_seq+1])
-    idx_seq++;
+/*------------------------------------*/
+/*          Index cache files         */
+/*------------------------------------*/
+
+/** Identifies index cache files. */
+static const char IDX_CACHE_MAGIC[8] = { 'T', 'G', 'S', 'R', 'E', 'F', 'I', 'X' };
+/** Format version of index cache files (increment on layout changes). */
+static const uint32_t IDX_CACHE_VERSION = 1;
+/** Size of cache file header: magic, version, reserved, checksum. */
+static const size_t IDX_CACHE_HEADER_LEN = 8 + 4 + 4 + 8;
+
+void GenomeReference::indexRecords(const string& fn_source) {
+  string fn_cache = fn_source + ".gidx";
+  if (this->readIndexCache(fn_cache, fn_source)) {
+    fprintf(stderr, "[INFO] Loaded reference index from file '%s'.\n", fn_cache.c_str());
+    this->updateNucFreqs();
+    return;
+  }
+  this->indexRecords();
+  if (this->writeIndexCache(fn_cache, fn_source))
+    fprintf(stderr, "[INFO] Wrote reference index to file '%s'.\n", fn_cache.c_str());
+}
+
+bool GenomeReference::writeIndexCache(const string& fn_cache, const string& fn_source) const {
+  struct stat st;
+  if (stat(fn_source.c_str(), &st) != 0) {
+    fprintf(stderr, "[WARN] (GenomeReference::writeIndexCache) cannot access file '%s'.\n", fn_source.c_str());
+    return false;
+  }
+  ofstream ofs(fn_cache, ios::out | ios::binary);
+  if (!ofs.good()) {
+    fprintf(stderr, "[WARN] (GenomeReference::writeIndexCache) cannot write to file '%s'.\n", fn_cache.c_str());
+    return false;
+  }
+
+  // header (checksum is filled in after payload has been written)
+  uint32_t version = IDX_CACHE_VERSION;
+  uint32_t reserved = 0;
+  uint64_t checksum = 0;
+  ofs.write(IDX_CACHE_MAGIC, sizeof(IDX_CACHE_MAGIC));
+  ofs.write(reinterpret_cast<const char*>(&version), sizeof(version));
+  ofs.write(reinterpret_cast<const char*>(&reserved), sizeof(reserved));
+  ofs.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+
+  BinaryWriter out(ofs);
+  // source file properties
+  out.write64(st.st_size);
+  out.write64(st.st_mtime);
+  // index layout
+  out.write64(ContextIndex::NUM_CONTEXTS);
+  out.write64(ContextIndex::BLOCK_LEN);
+  out.write64(ContextIndex::BLOCKS_PER_SUPERBLOCK);
+  // sequence records
+  out.write64(records.size());
+  for (auto const & rec : records) {
+    out.writeStr(rec->id);
+    out.write64(rec->length());
+  }
+  // genome coordinates
+  out.write64(length);
+  out.write64(masked_length);
+  out.writeVec(vec_start_chr);
+  out.writeVec(vec_start_masked);
+  out.writeVec(vec_cumlen_masked);
+  // context index
+  out.writeVec(idx_context.m_rec_start);
+  out.writeVec(idx_context.m_rec_sb);
+  out.writeVec(idx_context.m_rec_blk);
+  out.writeVec(idx_context.m_cnt_rec);
+  out.writeVec(idx_context.m_cnt_sb);
+  out.writeVec(idx_context.m_cnt_blk);
+
+  ofs.seekp(sizeof(IDX_CACHE_MAGIC) + sizeof(version) + sizeof(reserved));
+  ofs.write(reinterpret_cast<const char*>(&out.hash), sizeof(out.hash));
+
+  return ofs.good();
+}
+
+bool GenomeReference::readIndexCache(const string& fn_cache, const string& fn_source) {
+  struct stat st_src, st_cache;
+  if (stat(fn_source.c_str(), &st_src) != 0 || stat(fn_cache.c_str(), &st_cache) != 0)
+    return false;
+  MappedFile file;
+  if (!file.open(fn_cache))
+    return false;
+
+  // check header and payload checksum
+  if (file.size < IDX_CACHE_HEADER_LEN || memcmp(file.data, IDX_CACHE_MAGIC, sizeof(IDX_CACHE_MAGIC)) != 0) {
+    fprintf(stderr, "[WARN] (GenomeReference::readIndexCache) '%s' is not an index file.\n", fn_cache.c_str());
+    return false;
+  }
+  uint32_t version = 0;
+  uint64_t checksum = 0;
+  memcpy(&version, file.data + 8, sizeof(version));
+  memcpy(&checksum, file.data + 16, sizeof(checksum));
+  if (version != IDX_CACHE_VERSION) {
+    fprintf(stderr, "[INFO] Index file '%s' has outdated format (v%u), rebuilding.\n", fn_cache.c_str(), version);
+    return false;
+  }
+  const char* payload = file.data + IDX_CACHE_HEADER_LEN;
+  size_t len_payload = file.size - IDX_CACHE_HEADER_LEN;
+  if (hashFnv1a(payload, len_payload) != checksum) {
+    fprintf(stderr, "[WARN] (GenomeReference::readIndexCache) checksum mismatch in '%s', rebuilding.\n", fn_cache.c_str());
+    return false;
+  }
+
+  // check that cache matches source file and sequence records
+  BinaryReader in(payload, len_payload);
+  bool is_valid = ( in.read64() == uint64_t(st_src.st_size) );
+  is_valid &= ( in.read64() == uint64_t(st_src.st_mtime) );
+  is_valid &= ( in.read64() == ContextIndex::NUM_CONTEXTS );
+  is_valid &= ( in.read64() == ContextIndex::BLOCK_LEN );
+  is_valid &= ( in.read64() == ContextIndex::BLOCKS_PER_SUPERBLOCK );
+  is_valid &= ( in.read64() == records.size() );
+  for (size_t i=0; is_valid && i<records.size(); ++i) {
+    is_valid &= ( in.readStr() == records[i]->id );
+    is_valid &= ( in.read64() == records[i]->length() );
+  }
+  if (!in.ok || !is_valid) {
+    fprintf(stderr, "[INFO] Index file '%s' does not match '%s', rebuilding.\n", fn_cache.c_str(), fn_source.c_str());
+    return false;
+  }
+
+  // load indices
+  vector<TCoord> vec_start_chr_in, vec_start_masked_in, vec_cumlen_masked_in;
+  ContextIndex idx_in;
+  uint64_t length_in = in.read64();
+  uint64_t masked_length_in = in.read64();
+  in.readVec(vec_start_chr_in);
+  in.readVec(vec_start_masked_in);
+  in.readVec(vec_cumlen_masked_in);
+  in.readVec(idx_in.m_rec_start);
+  in.readVec(idx_in.m_rec_sb);
+  in.readVec(idx_in.m_rec_blk);
+  in.readVec(idx_in.m_cnt_rec);
+  in.readVec(idx_in.m_cnt_sb);
+  in.readVec(idx_in.m_cnt_blk);
+  if (!in.ok) {
+    fprintf(stderr, "[WARN] (GenomeReference::readIndexCache) premature end of file '%s'.\n", fn_cache.c_str());
+    return false;
+  }
+
+  length = length_in;
+  masked_length = masked_length_in;
+  vec_start_chr.swap(vec_start_chr_in);
+  vec_start_masked.swap(vec_start_masked_in);
+  vec_cumlen_masked.swap(vec_cumlen_masked_in);
+  idx_context = std::move(idx_in);
+
+  return true;
+}
+
+TCoord GenomeReference::countNuc(const short idx_nuc) const {
+  return idx_context.count(ContextIndex::getNucContext(idx_nuc));
+}
+
+TCoord GenomeReference::getNucPos(const short idx_nuc, const TCoord k) const {
+  return idx_context.select(ContextIndex::getNucContext(idx_nuc), k, records);
+}
+
+TCoord GenomeReference::countTrinuc(const string& trinuc) const {
+  int ctx = ContextIndex::getTrinucContext(trinuc);
+  if (ctx == -1) {
+    fprintf(stderr, "[ERROR] (GenomeReference::countTrinuc) invalid tri-nucleotide '%s'.\n", trinuc.c_str());
+    return 0;
+  }
+  return idx_context.count(ctx);
+}
+
+TCoord GenomeReference::getTrinucPos(const string& trinuc, const TCoord k) const {
+  int ctx = ContextIndex::getTrinucContext(trinuc);
+  assert( ctx > -1 );
+  return idx_context.select(ctx, k, records);
+}
+
+unsigned GenomeReference::getRecordIndex(const TCoord global_pos) const {
+  assert( global_pos < length );
+  // last record starting at or before global position
+  auto it = upper_bound(vec_start_chr.begin(), vec_start_chr.begin()+num_records, global_pos);
+  return (it - vec_start_chr.begin()) - 1;
+}
+
+Locus GenomeReference::getLocusByGlobalPos(const TCoord global_pos) const {
+  unsigned idx_seq = getRecordIndex(global_pos);
 
   // compile locus info
-  Locus *loc = new Locus();
-  loc->idx_record = idx_seq;
-  loc->id_ref = records[idx_seq]->id_ref;
-  loc->start = global_pos - vec_start_chr[idx_seq];
-  loc->end = loc->start + 1;
+  Locus loc;
+  loc.idx_record = idx_seq;
+  loc.id_ref = records[idx_seq]->id_ref;
+  loc.start = global_pos - vec_start_chr[idx_seq];
+  loc.end = loc.start + 1;
 
-  return *loc;
+  return loc;
 }
 
-Locus GenomeReference::getAbsoluteLocusMasked(double rel_pos) const {
+void GenomeReference::getLociByGlobalPos(
+  const vector<TCoord>& vec_pos,
+  vector<Locus>& vec_loc
+) const
+{
+  assert( is_sorted(vec_pos.begin(), vec_pos.end()) );
+  vec_loc.resize(vec_pos.size());
+  unsigned idx_seq = 0;
+  for (size_t i = 0; i < vec_pos.size(); ++i) {
+    assert( vec_pos[i] < length );
+    // advance to record containing position
+    while (vec_pos[i] >= vec_start_chr[idx_seq+1])
+      idx_seq++;
+    Locus& loc = vec_loc[i];
+    loc.idx_record = idx_seq;
+    loc.id_ref = records[idx_seq]->id_ref;
+    loc.start = vec_pos[i] - vec_start_chr[idx_seq];
+    loc.end = loc.start + 1;
+  }
+}
+
+Locus GenomeReference::getAbsoluteLocusMasked(const double rel_pos) const {
   long double pos = rel_pos * masked_length;
-  unsigned abs_pos_masked = floor(pos);
-  // identify genomic region
-  int idx_region = 0;
-  while (abs_pos_masked > vec_cumlen_masked[idx_region])
-    idx_region++;
+  TCoord abs_pos_masked = min(TCoord(floor(pos)), TCoord(masked_length-1));
+  // identify genomic region (first one ending after position)
+  auto it = upper_bound(vec_cumlen_masked.begin(), vec_cumlen_masked.end(), abs_pos_masked);
+  size_t idx_region = it - vec_cumlen_masked.begin();
   // calculate relative position within region
-  unsigned rel_pos_in_region = abs_pos_masked;
+  TCoord rel_pos_in_region = abs_pos_masked;
   if (idx_region > 0)
     rel_pos_in_region -= vec_cumlen_masked[idx_region-1];
   // identify genomic sequence
-  unsigned abs_start_region = vec_start_masked[idx_region];
-  int idx_seq = 0;
-  while (abs_start_region >= vec_start_chr[idx_seq+1])
-    idx_seq++;
+  TCoord abs_start_region = vec_start_masked[idx_region];
+  unsigned idx_seq = getRecordIndex(abs_start_region);
   // compile locus info
-  Locus *loc = new Locus();
-  loc->idx_record = idx_seq;
-  loc->start = rel_pos_in_region + (abs_start_region - vec_start_chr[idx_seq]);
-  loc->end = loc->start + 1;
+  Locus loc;
+  loc.idx_record = idx_seq;
+  loc.id_ref = records[idx_seq]->id_ref;
+  loc.start = rel_pos_in_region + (abs_start_region - vec_start_chr[idx_seq]);
+  loc.end = loc.start + 1;
 
-  return *loc;
+  return loc;
 }
 
-void GenomeReference::getSequence (
-  const string id_chr,
+void GenomeReference::getAbsoluteLociMasked(
+  const vector<double>& vec_rel_pos,
+  vector<Locus>& vec_loc
+) const
+{
+  assert( is_sorted(vec_rel_pos.begin(), vec_rel_pos.end()) );
+  vec_loc.resize(vec_rel_pos.size());
+  size_t idx_region = 0;
+  unsigned idx_seq = 0;
+  for (size_t i = 0; i < vec_rel_pos.size(); ++i) {
+    long double pos = vec_rel_pos[i] * masked_length;
+    TCoord abs_pos_masked = min(TCoord(floor(pos)), TCoord(masked_length-1));
+    // advance to region and record containing position
+    while (abs_pos_masked >= vec_cumlen_masked[idx_region])
+      idx_region++;
+    TCoord rel_pos_in_region = abs_pos_masked;
+    if (idx_region > 0)
+      rel_pos_in_region -= vec_cumlen_masked[idx_region-1];
+    TCoord abs_start_region = vec_start_masked[idx_region];
+    while (abs_start_region >= vec_start_chr[idx_seq+1])
+      idx_seq++;
+    Locus& loc = vec_loc[i];
+    loc.idx_record = idx_seq;
+    loc.id_ref = records[idx_seq]->id_ref;
+    loc.start = rel_pos_in_region + (abs_start_region - vec_start_chr[idx_seq]);
+    loc.end = loc.start + 1;
+  }
+}
+
+bool
+GenomeReference::getSequenceViews (
+  const string& id_chr,
   const TCoord start,
   const TCoord end,
-  map<TCoord, string>& seqs
+  vector<SeqView>& views
 ) const
 {
   // perform sanity checks
   assert( chromosomes.count(id_chr) > 0 ); // chromosome exists
   assert( start < end );
+  views.clear();
 
-  shared_ptr<ChromosomeReference> chr = chromosomes.at(id_chr);
+  const ChromosomeReference& chr = *chromosomes.at(id_chr);
   // do coordinates exceed chromosome limits? (should not happen)
-  assert( (start >= 0) && (end <= chr->length) );
+  assert( end <= chr.length );
 
-  // skip over SeqRecords located upstream of target range
-  auto it_start_rec = chr->map_start_rec.begin();
-  while ( (it_start_rec != chr->map_start_rec.end()) &&
-          (it_start_rec->first+it_start_rec->second->seq.length() < start) )
-    ++it_start_rec;
+  // start with last SeqRecord starting at or before target range
+  auto it_start_rec = chr.map_start_rec.upper_bound(start);
+  if (it_start_rec != chr.map_start_rec.begin())
+    --it_start_rec;
 
   // add SeqRecords within target range
-  while ( (it_start_rec != chr->map_start_rec.end()) &&
-          (it_start_rec->first < end) ) {
-    ulong rec_start = it_start_rec->first;
-    // determine local start and end (within current sequence)
-    ulong loc_start = start-rec_start;
-    ulong loc_len_max = it_start_rec->second->seq.length();
-    ulong loc_len = min(end-max(rec_start, start), loc_len_max);
-    seqs[loc_start] = it_start_rec->second->seq.substr(loc_start, loc_len);
-    ++it_start_rec;
+  for (; it_start_rec != chr.map_start_rec.end() && it_start_rec->first < end; ++it_start_rec) {
+    TCoord rec_start = it_start_rec->first;
+    TCoord rec_end = rec_start + it_start_rec->second->length();
+    if (rec_end <= start)
+      continue;
+    // overlap with target range (chromosome coordinates)
+    TCoord ovl_start = max(rec_start, start);
+    TCoord ovl_end = min(rec_end, end);
+    views.push_back(SeqView(it_start_rec->second.get(), ovl_start - rec_start, ovl_end - ovl_start, ovl_start));
   }
+
+  return views.size() > 0;
+}
+
+char
+GenomeReference::getNucAt (
+  const string& id_chr,
+  const TCoord pos
+) const
+{
+  assert( chromosomes.count(id_chr) > 0 ); // chromosome exists
+  return chromosomes.at(id_chr)->getNucAt(pos);
+}
+
+void GenomeReference::getSequence (
+  const string id_chr,
+  const TCoord start,
+  const TCoord end,
+  map<TCoord, string>& seqs
+) const
+{
+  vector<SeqView> views;
+  this->getSequenceViews(id_chr, start, end, views);
+  for (auto const & view : views)
+    view.str(seqs[view.pos_chr]);
 }
 
 bool
@@ -367,14 +633,15 @@ GenomeReference::getSequence (
   // init return variable
   seq.clear();
 
-  map<TCoord, string> map_start_seq;
-  this->getSequence(id_chr, pos_start, pos_end, map_start_seq);
-  if ( map_start_seq.size() == 0 ) // locus was not found in genome
+  vector<SeqView> views;
+  if ( !this->getSequenceViews(id_chr, pos_start, pos_end, views) ) // locus was not found in genome
     return false;
 
   // concatenate sequences for output
-  for (auto start_seq : map_start_seq) {
-    seq += start_seq.second;
+  for (auto const & view : views) {
+    size_t len_seq = seq.length();
+    seq.resize(len_seq + view.length());
+    view.copy(0, view.length(), &seq[len_seq]);
   }
 
   return true;
@@ -3,9 +3,11 @@
 
 #include "../random.hpp"
 #include "ChromosomeReference.hpp"
+#include "ContextIndex.hpp"
 #include "KmerProfile.hpp"
 #include "Locus.hpp"
 #include "SeqRecord.hpp"
+#include "SeqView.hpp"
 #include <map>
 #include <memory> // unique_ptr, shared_ptr, weak_ptr
 #include <string>
@@ -17,8 +19,8 @@ namespace seqio {
 struct GenomeReference
 {
   unsigned num_records;
-  unsigned length;                        /** total length of all sequences */
-  unsigned masked_length;                 /** length of unmasked (non-'N') positions */
+  TCoord length;                          /** total length of all sequences */
+  TCoord masked_length;                   /** length of unmasked (non-'N') positions */
   // TODO: remove ploidy (modeled on SegmentCopy level)
   short ploidy;                           /** number of copies for each chromosome */
   // TODO: move SeqRecords below ChromosomeReference level
@@ -30,15 +32,12 @@ struct GenomeReference
   /** Vector of chromosome lengths (paired with chromosome ID vector) */
   std::vector<TCoord> vec_chr_len;
 
-  std::vector<unsigned> vec_start_chr;    /** cumulative start positions of sequences */
-  std::vector<unsigned> vec_start_masked; /** cumulative start positions of unmasked regions */
-  std::vector<unsigned> vec_cumlen_masked; /** cumulative lengths of unmasked regions */
+  std::vector<TCoord> vec_start_chr;     /** cumulative start positions of sequences */
+  std::vector<TCoord> vec_start_masked;  /** cumulative start positions of unmasked regions */
+  std::vector<TCoord> vec_cumlen_masked; /** cumulative lengths of unmasked regions */
   double nuc_freq[4];                     /** nucleotide frequencies */
-  /** absolute bp positions indexed by nucleotide */
-  //std::map<char, std::vector<long> > map_nuc_pos;
-  std::vector<std::vector<long> > nuc_pos;
-  /** absolute bp positions indexed by tri-nucleotides */
-  std::map<std::string, std::vector<long> > map_3mer_pos;
+  /** occurrence index for nucleotides and tri-nucleotides */
+  ContextIndex idx_context;
 
   /** default c'tor */
   GenomeReference();
@@ -50,7 +49,7 @@ struct GenomeReference
 
   /** Simulate DNA seq of given length and nuc freqs. */
   void generate_nucfreqs (
-    const unsigned long,
+    const TCoord,
     const std::vector<double>,
     RandomNumberGenerator&
   );
@@ -64,7 +63,7 @@ struct GenomeReference
    * \param object to generate random numbers
    */
   void generate_nucfreqs (
-    const unsigned long,
+    const TCoord,
     const unsigned short,
     const std::vector<double>,
     RandomNumberGenerator&
@@ -81,8 +80,8 @@ struct GenomeReference
     */
   void generate_nucfreqs (
     const unsigned num_frags,
-    const unsigned long mean_len,
-    const unsigned long sd_len,
+    const TCoord mean_len,
+    const TCoord sd_len,
     const std::vector<double> nuc_freqs,
     RandomNumberGenerator& rng
   );
@@ -100,9 +99,9 @@ struct GenomeReference
     */
   bool generate_kmer (
     const unsigned num_frags,
-    const unsigned long mean_len,
-    const unsigned long sd_len,
-    const KmerProfile kmer_prof,
+    const TCoord mean_len,
+    const TCoord sd_len,
+    const KmerProfile& kmer_prof,
     RandomNumberGenerator& rng
   );
 
@@ -117,15 +116,82 @@ struct GenomeReference
    */
   void indexRecords();
 
+  /**
+   * Index genome, reusing a cache file stored next to the source file.
+   *
+   * If a valid cache (<fn_source>.gidx) exists, indices are loaded from it;
+   * otherwise the genome is scanned and the cache is (re-)written.
+   *
+   * \param fn_source  file the reference sequences were loaded from
+   */
+  void indexRecords(const std::string& fn_source);
+
+  /**
+   * Load indices from a cache file.
+   *
+   * The cache is rejected if its format version or checksum do not match,
+   * or if it was generated from a different version of the source file.
+   *
+   * \param fn_cache   path to cache file
+   * \param fn_source  file the reference sequences were loaded from
+   * \returns          true on success, false if the cache is missing or invalid
+   */
+  bool readIndexCache(const std::string& fn_cache, const std::string& fn_source);
+
+  /**
+   * Write indices to a cache file.
+   *
+   * \param fn_cache   path to cache file
+   * \param fn_source  file the reference sequences were loaded from
+   * \returns          true on success, false on error
+   */
+  bool writeIndexCache(const std::string& fn_cache, const std::string& fn_source) const;
+
+  /** Calculate nucleotide frequencies from index and report genome stats. */
+  void updateNucFreqs();
+
+  /** Get number of positions having a given nucleotide (see ::Nuc). */
+  TCoord countNuc(const short idx_nuc) const;
+
+  /** Get global position of the k-th (0-based) occurrence of a nucleotide. */
+  TCoord getNucPos(const short idx_nuc, const TCoord k) const;
+
+  /** Get number of positions at which a given tri-nucleotide starts. */
+  TCoord countTrinuc(const std::string& trinuc) const;
+
+  /** Get global start position of the k-th (0-based) occurrence of a tri-nucleotide. */
+  TCoord getTrinucPos(const std::string& trinuc, const TCoord k) const;
+
+  /** Get index of record containing a global position (binary search). */
+  unsigned getRecordIndex(const TCoord global_pos) const;
+
   /**
    * Get chromosome and local position for global position
    */
-  Locus getLocusByGlobalPos(long) const;
+  Locus getLocusByGlobalPos(const TCoord global_pos) const;
+
+  /**
+   * Get chromosome and local positions for multiple global positions.
+   * Positions must be sorted, loci are resolved in a single sweep.
+   */
+  void getLociByGlobalPos(
+    const std::vector<TCoord>& vec_pos,
+    std::vector<Locus>& vec_loc
+  ) const;
 
   /**
    * Get absolute coordinates for a relative position in unmasked part of the genome
    */
-  Locus getAbsoluteLocusMasked(double) const;
+  Locus getAbsoluteLocusMasked(const double rel_pos) const;
+
+  /**
+   * Get absolute coordinates for multiple relative positions in unmasked part of the genome.
+   * Positions must be sorted, loci are resolved in a single sweep.
+   */
+  void getAbsoluteLociMasked(
+    const std::vector<double>& vec_rel_pos,
+    std::vector<Locus>& vec_loc
+  ) const;
 
   /** 
    * Get DNA sequence for a genomic region.
@@ -146,6 +212,29 @@ struct GenomeReference
      std::map<TCoord, std::string>& seqs
    ) const;
 
+   /**
+    * Get views of the sequence records covering a genomic region.
+    *
+    * Views refer to the underlying storage, no sequence data is copied.
+    * Consecutive calls reusing the output vector do not allocate.
+    *
+    * \param id_chr  reference chromosome id
+    * \param start   start coordinate (inclusive)
+    * \param end     end coordinate (exclusive)
+    * \param views   output parameter, views ordered by position
+    * \returns       true if region is covered by at least one sequence record
+    */
+   bool
+   getSequenceViews (
+     const std::string& id_chr,
+     const TCoord start,
+     const TCoord end,
+     std::vector<SeqView>& views
+   ) const;
+
+   /** Get nucleotide at a position of a reference chromosome. */
+   char getNucAt(const std::string& id_chr, const TCoord pos) const;
+
    /** 
     * Get nucleotide sequence at given locus.
     *
@@ -1,3 +1,4 @@
+#include "../seqio.hpp"
 #include "KmerProfile.hpp"
 #include <cmath>
 
@@ -94,8 +95,41 @@ KmerProfile::indexPrefixes () {
     m_idx_pfx[pfx].m_vec_weight.push_back(m_vec_weight[i]);
     m_idx_pfx[pfx].num_kmers++;
   }
+
+  // alias tables indexed by integer codes
+  unsigned num_pfx = num_kmers / 4;
+  vector<double> vec_weight_kmer(num_kmers, 0.0);
+  for (unsigned i=0; i<num_kmers; i++) {
+    long code = getKmerCode(m_vec_kmers[i]);
+    if ( code == -1 || code >= long(num_kmers) ) {
+      fprintf(stderr, "[ERROR] (KmerProfile::indexPrefixes) invalid kmer '%s'.\n", m_vec_kmers[i].c_str());
+      return false;
+    }
+    vec_weight_kmer[code] = m_vec_weight[i];
+  }
+  m_alias_kmer = AliasTable(vec_weight_kmer);
+  m_alias_pfx.resize(num_pfx);
+  for (unsigned pfx=0; pfx<num_pfx; pfx++) {
+    vector<double> vec_weight_nuc(vec_weight_kmer.begin() + 4*pfx, vec_weight_kmer.begin() + 4*pfx + 4);
+    m_alias_pfx[pfx] = AliasTable(vec_weight_nuc);
+  }
+
   has_idx_pfx = true;
   return true;
 }
 
+long
+KmerProfile::getKmerCode (
+  const string& kmer
+) {
+  long code = 0;
+  for (char c : kmer) {
+    short nuc = nuc2idx(c);
+    if (nuc == -1)
+      return -1;
+    code = (code << 2) | nuc;
+  }
+  return code;
+}
+
 } // namespace seqio
\ No newline at end of file
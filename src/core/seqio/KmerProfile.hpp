@@ -1,6 +1,7 @@
 #ifndef KMERPROFILE_H
 #define KMERPROFILE_H
 
+#include "../random.hpp"
 #include "../stringio.hpp"
 #include <map>
 #include <string>
@@ -27,7 +28,11 @@ std::vector<double>
 /** Stores weights for prefixes of length k-1. */
 std::map<std::string, KmerProfile> m_idx_pfx;
 /** Flag indicating that prefices have been indexed. */
-bool has_idx_pfx;
+bool has_idx_pfx = false;
+/** Samples a kmer (by integer code, cf. getKmerCode()). */
+AliasTable m_alias_kmer;
+/** Samples the nucleotide following a k-1 prefix, indexed by integer prefix code. */
+std::vector<AliasTable> m_alias_pfx;
 
 /** default c'tor */
 KmerProfile();
@@ -40,9 +45,12 @@ readCSV (
   const std::string filename
 );
 
-/** Calculate sub-indices for k-1 prefixes. */
+/** Calculate sub-indices for k-1 prefixes (incl. alias tables). */
 bool indexPrefixes ();
 
+/** Get integer code of a kmer (2 bits per nucleotide, -1 if invalid). */
+static long getKmerCode (const std::string& kmer);
+
 }; // struct KmerProfile
 
 } // namespace seqio
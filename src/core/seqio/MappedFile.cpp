@@ -0,0 +1,50 @@
+#include "MappedFile.hpp"
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+namespace seqio {
+
+MappedFile::MappedFile() : data(nullptr), size(0) {}
+
+MappedFile::~MappedFile() {
+  this->close();
+}
+
+bool MappedFile::open(const string& fn) {
+  this->close();
+  int fd = ::open(fn.c_str(), O_RDONLY);
+  if (fd == -1) {
+    fprintf(stderr, "[ERROR] (MappedFile::open) cannot open file '%s'.\n", fn.c_str());
+    return false;
+  }
+  struct stat st;
+  if (fstat(fd, &st) == -1 || st.st_size == 0) {
+    fprintf(stderr, "[ERROR] (MappedFile::open) cannot map empty file '%s'.\n", fn.c_str());
+    ::close(fd);
+    return false;
+  }
+  void* p = mmap(nullptr, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (p == MAP_FAILED) {
+    fprintf(stderr, "[ERROR] (MappedFile::open) mmap failed for file '%s'.\n", fn.c_str());
+    return false;
+  }
+  filename = fn;
+  data = static_cast<char*>(p);
+  size = st.st_size;
+  return true;
+}
+
+void MappedFile::close() {
+  if (data != nullptr)
+    munmap(data, size);
+  data = nullptr;
+  size = 0;
+}
+
+} // namespace seqio
@@ -0,0 +1,42 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace seqio {
+
+/**
+ * Memory-mapped file.
+ *
+ * The file is mapped privately: pages are loaded lazily by the OS and
+ * writes go to private copies, never back to the file.
+ */
+struct MappedFile
+{
+  std::string filename; /** path of mapped file */
+  char* data;           /** start of mapped region (nullptr if not mapped) */
+  size_t size;          /** size of mapped region in bytes */
+
+  /** default c'tor */
+  MappedFile();
+  /** unmaps file */
+  ~MappedFile();
+  // mapped regions are not copyable
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /**
+   * Map file into memory.
+   *
+   * \param fn  path to file
+   * \returns   true on success, false on error
+   */
+  bool open(const std::string& fn);
+  /** Unmap file. */
+  void close();
+};
+
+} // namespace seqio
+
+#endif // MAPPEDFILE_H
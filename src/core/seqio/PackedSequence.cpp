@@ -0,0 +1,186 @@
+#include "../seqio.hpp"
+#include "PackedSequence.hpp"
+#include <algorithm>
+#include <cctype>
+
+using namespace std;
+
+namespace seqio {
+
+typedef PackedSequence::TRun TRun;
+
+/** Returns iterator to the first run ending after the given position. */
+static vector<TRun>::const_iterator
+findRun (
+  const vector<TRun>& runs,
+  const TCoord pos
+) {
+  return lower_bound(runs.begin(), runs.end(), pos,
+    [](const TRun& r, const TCoord p) { return r.first + r.second <= p; });
+}
+
+/** Checks if a position is covered by a run. */
+static bool
+isInRun (
+  const vector<TRun>& runs,
+  const TCoord pos
+) {
+  auto it = findRun(runs, pos);
+  return (it != runs.end() && it->first <= pos);
+}
+
+/** Adds a position to the last run (or starts a new run). */
+static void
+appendRun (
+  vector<TRun>& runs,
+  const TCoord pos
+) {
+  if (runs.size() > 0 && runs.back().first + runs.back().second == pos)
+    runs.back().second++;
+  else
+    runs.push_back(TRun(pos, 1));
+}
+
+/** Adds a position to (or removes it from) a list of runs. */
+static void
+setRunMembership (
+  vector<TRun>& runs,
+  const TCoord pos,
+  const bool is_member
+) {
+  size_t i = findRun(runs, pos) - runs.begin();
+  bool in_run = (i < runs.size() && runs[i].first <= pos);
+  if (in_run == is_member) // nothing to do
+    return;
+
+  if (is_member) {
+    // position lies between runs[i-1] and runs[i]
+    bool join_prev = (i > 0 && runs[i-1].first + runs[i-1].second == pos);
+    bool join_next = (i < runs.size() && runs[i].first == pos+1);
+    if (join_prev && join_next) {
+      runs[i-1].second += 1 + runs[i].second;
+      runs.erase(runs.begin() + i);
+    }
+    else if (join_prev) {
+      runs[i-1].second++;
+    }
+    else if (join_next) {
+      runs[i].first--;
+      runs[i].second++;
+    }
+    else {
+      runs.insert(runs.begin() + i, TRun(pos, 1));
+    }
+  }
+  else {
+    // split run, dropping the given position
+    TCoord run_end = runs[i].first + runs[i].second;
+    runs[i].second = pos - runs[i].first;
+    if (pos+1 < run_end)
+      runs.insert(runs.begin() + i + 1, TRun(pos+1, run_end-pos-1));
+    if (runs[i].second == 0)
+      runs.erase(runs.begin() + i);
+  }
+}
+
+PackedSequence::PackedSequence() : length(0) {}
+
+PackedSequence::PackedSequence(const string& seq) : length(0) {
+  this->assign(seq);
+}
+
+void PackedSequence::assign(const string& seq) {
+  this->resize(seq.length());
+  for (TCoord i=0; i<length; ++i) {
+    char c = seq[i];
+    short code = nuc2idx(c);
+    if (code < 0)
+      appendRun(n_runs, i);
+    else
+      words[i >> 5] |= uint64_t(code) << ((i & 31) << 1);
+    if (islower(c))
+      appendRun(mask_runs, i);
+  }
+}
+
+void PackedSequence::resize(const TCoord len) {
+  length = len;
+  words.assign((len + 31) >> 5, 0);
+  n_runs.clear();
+  mask_runs.clear();
+}
+
+void PackedSequence::clear() {
+  length = 0;
+  vector<uint64_t>().swap(words);
+  vector<TRun>().swap(n_runs);
+  vector<TRun>().swap(mask_runs);
+}
+
+char PackedSequence::getNucAt(const TCoord pos) const {
+  assert( pos < length );
+  char nuc = isInRun(n_runs, pos) ? 'N' : idx2nuc(getCode(pos));
+  if (mask_runs.size() > 0 && isInRun(mask_runs, pos))
+    nuc = tolower(nuc);
+  return nuc;
+}
+
+void PackedSequence::setNucAt(const TCoord pos, const char nuc) {
+  assert( pos < length );
+  short code = nuc2idx(nuc);
+  if (code > -1)
+    setCode(pos, code);
+  setRunMembership(n_runs, pos, code < 0);
+  setRunMembership(mask_runs, pos, islower(nuc));
+}
+
+void PackedSequence::extract(
+  const TCoord start,
+  const TCoord len,
+  string& out
+) const
+{
+  out.resize(start < length ? min(len, length - start) : 0);
+  this->copy(start, len, &out[0]);
+}
+
+TCoord PackedSequence::copy(
+  const TCoord start,
+  const TCoord len,
+  char* out
+) const
+{
+  if (start >= length)
+    return 0;
+  TCoord n = min(len, length - start);
+  TCoord end = start + n;
+  for (TCoord i=0; i<n; ++i)
+    out[i] = idx2nuc(getCode(start+i));
+  // overlay unknown bases
+  for (auto it = findRun(n_runs, start); it != n_runs.end() && it->first < end; ++it) {
+    TCoord s = max(it->first, start);
+    TCoord e = min(it->first + it->second, end);
+    fill(out + (s-start), out + (e-start), 'N');
+  }
+  // overlay soft-masked bases
+  for (auto it = findRun(mask_runs, start); it != mask_runs.end() && it->first < end; ++it) {
+    TCoord s = max(it->first, start);
+    TCoord e = min(it->first + it->second, end);
+    transform(out + (s-start), out + (e-start), out + (s-start),
+              [](char c) { return char(tolower(c)); });
+  }
+  return n;
+}
+
+string PackedSequence::str() const {
+  string seq;
+  this->extract(0, length, seq);
+  return seq;
+}
+
+size_t PackedSequence::getMemoryUsage() const {
+  return words.capacity()*sizeof(uint64_t)
+       + (n_runs.capacity() + mask_runs.capacity())*sizeof(TRun);
+}
+
+} // namespace seqio
@@ -0,0 +1,86 @@
+#ifndef PACKEDSEQUENCE_H
+#define PACKEDSEQUENCE_H
+
+#include "types.hpp"
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace seqio {
+
+/**
+ * Nucleotide sequence stored at 2 bits per base.
+ *
+ * Bases are encoded as A=0, C=1, G=2, T=3 (cf. nuc2idx()), 32 bases per
+ * 64-bit word, lowest bits first. Characters that have no 2-bit code
+ * (N and other IUPAC symbols) are recorded as runs of 'N'; soft-masked
+ * (lowercase) stretches are recorded as mask runs. This is the same
+ * information that a UCSC .2bit file stores for each sequence.
+ */
+struct PackedSequence
+{
+  /** Run of positions, structure: (start, length) */
+  typedef std::pair<TCoord, TCoord> TRun;
+
+  /** number of bases */
+  TCoord length;
+  /** 2-bit nucleotide codes */
+  std::vector<uint64_t> words;
+  /** sorted, non-overlapping runs of unknown bases ('N') */
+  std::vector<TRun> n_runs;
+  /** sorted, non-overlapping runs of soft-masked (lowercase) bases */
+  std::vector<TRun> mask_runs;
+
+  /** default c'tor */
+  PackedSequence();
+  /** pack a plain text sequence */
+  PackedSequence(const std::string& seq);
+
+  /** Replace contents by a plain text sequence. */
+  void assign(const std::string& seq);
+  /** Set length, all bases initialized to 'A'. */
+  void resize(const TCoord len);
+  /** Release all storage. */
+  void clear();
+
+  /** Get 2-bit code at position (ignores runs of 'N'). */
+  inline short getCode(const TCoord pos) const {
+    return (words[pos >> 5] >> ((pos & 31) << 1)) & 3;
+  }
+  /** Set 2-bit code at position (does not touch runs of 'N'). */
+  inline void setCode(const TCoord pos, const short code) {
+    uint64_t shift = (pos & 31) << 1;
+    words[pos >> 5] = (words[pos >> 5] & ~(uint64_t(3) << shift)) | (uint64_t(code & 3) << shift);
+  }
+
+  /** Get nucleotide char at position. */
+  char getNucAt(const TCoord pos) const;
+  /** Set nucleotide char at position. */
+  void setNucAt(const TCoord pos, const char nuc);
+  /**
+   * Decode a subsequence.
+   *
+   * \param start  start position (0-based)
+   * \param len    number of bases to decode (truncated at sequence end)
+   * \param out    output parameter, receives decoded sequence
+   */
+  void extract(const TCoord start, const TCoord len, std::string& out) const;
+  /**
+   * Decode a subsequence into a caller-provided buffer.
+   *
+   * \param start  start position (0-based)
+   * \param len    number of bases to decode (truncated at sequence end)
+   * \param out    output buffer (must hold at least len chars)
+   * \returns      number of decoded bases
+   */
+  TCoord copy(const TCoord start, const TCoord len, char* out) const;
+  /** Decode whole sequence. */
+  std::string str() const;
+  /** Number of bytes occupied by packed sequence. */
+  size_t getMemoryUsage() const;
+};
+
+} // namespace seqio
+
+#endif // PACKEDSEQUENCE_H
@@ -5,25 +5,24 @@ using namespace std;
 namespace seqio {
 
 SegmentCopy::SegmentCopy ()
-: id(boost::uuids::random_generator()()) {}
-
-SegmentCopy::SegmentCopy (int i) {}
+: id(0), ref_start(0), ref_end(0), gl_allele('A') {}
 
 SegmentCopy::~SegmentCopy () {}
 
 SegmentCopy::SegmentCopy (
+  const TSegId seg_id,
   const TCoord start, 
   const TCoord end,
   const char allele
 )
-: id(boost::uuids::random_generator()()), 
+: id(seg_id), 
   ref_start(start), 
   ref_end(end),
   gl_allele(allele)
 {}
 
 ostream& operator<<(ostream& lhs, const SegmentCopy& seg) {
-  lhs << "SegmentCopy<uuid=" << seg.id << "> ";
+  lhs << "SegmentCopy<id=" << seg.id << "> ";
   lhs << "[" << seg.ref_start << ", " << seg.ref_end << ")";
   lhs << endl;
   return lhs;
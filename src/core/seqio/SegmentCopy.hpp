@@ -2,9 +2,7 @@
 #define SEGMENTCOPY_H
 
 #include "types.hpp"
-#include <boost/uuid/uuid.hpp>
-#include <boost/uuid/uuid_generators.hpp>
-#include <boost/uuid/uuid_io.hpp>
+#include <ostream>
 
 namespace seqio {
 
@@ -14,8 +12,8 @@ namespace seqio {
  *  the reference sequence. Further segment copies arise from CNV events.
  */
 struct SegmentCopy {
-  /** Universally-unique identifier to globally refer to the object. */
-  boost::uuids::uuid id;
+  /** Unique identifier to globally refer to the object (cf. SegmentIdAllocator). */
+  TSegId id;
   /** Start position (0-based, inclusive) in reference chromosome */
   TCoord ref_start;
   /** End position (0-based, exclusive) in reference chromosome */
@@ -25,17 +23,17 @@ struct SegmentCopy {
 
   /** default c'tor */
   SegmentCopy();
-  /** dummy c'tor to avoid UUID init (to avoid performance overhead) */
-  SegmentCopy(int);
   /** default d'tor */
   ~SegmentCopy();
 
   /** Create SegmentCopy for given coordinates.
+   *  \param id         Unique identifier of segment copy.
    *  \param start      Reference bp position where segment copy begins.
    *  \param end        Reference bp position where segment copy ends.
    *  \param gl_allele  Germline source allele ('A','B') from which segment copy originates.
    */
   SegmentCopy (
+    const TSegId id,
     const TCoord start, 
     const TCoord end,
     const char gl_allele
@@ -48,7 +46,7 @@ struct SegmentCopy {
 bool operator==(const SegmentCopy& lhs, const SegmentCopy& rhs);
 
 /** Compare two segment copies (order).
- *  Order by UUID (necessary to avoid collisions in boost::icl::set).
+ *  Order by ID (necessary to avoid collisions in boost::icl::set).
  */
 bool operator<(const SegmentCopy& lhs, const SegmentCopy& rhs);
 
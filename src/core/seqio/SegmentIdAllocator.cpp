@@ -0,0 +1,42 @@
+#include "SegmentIdAllocator.hpp"
+#include <cassert>
+
+using namespace std;
+
+namespace seqio {
+
+SegmentIdAllocator::SegmentIdAllocator (
+  const TSegId first,
+  const TSegId end
+)
+: next_id(first),
+  end_id(end)
+{
+  assert( first <= end );
+}
+
+TSegId
+SegmentIdAllocator::next ()
+{
+  assert( next_id < end_id );
+  return next_id++;
+}
+
+shared_ptr<SegmentIdAllocator>
+SegmentIdAllocator::fork (
+  const TSegId num_ids
+)
+{
+  assert( num_ids <= this->available() );
+  shared_ptr<SegmentIdAllocator> sp_fork(new SegmentIdAllocator(next_id, next_id + num_ids));
+  next_id += num_ids;
+  return sp_fork;
+}
+
+TSegId
+SegmentIdAllocator::available () const
+{
+  return end_id - next_id;
+}
+
+} // namespace seqio
@@ -0,0 +1,44 @@
+#ifndef SEGMENTIDALLOCATOR_H
+#define SEGMENTIDALLOCATOR_H
+
+#include "types.hpp"
+#include <limits>
+#include <memory>
+
+namespace seqio {
+
+/** Hands out unique identifiers for SegmentCopies.
+ *
+ *  Identifiers are drawn in increasing order from the range [next_id, end_id).
+ *  A sub-range can be reserved with fork(), so that independent parts of the
+ *  simulation (e.g. clone genomes built concurrently) can assign identifiers
+ *  without coordination.
+ */
+struct SegmentIdAllocator {
+  /** Next identifier to be handed out. */
+  TSegId next_id;
+  /** End of identifier range (exclusive). */
+  TSegId end_id;
+
+  /** Create allocator for identifier range [first, end). */
+  SegmentIdAllocator (
+    const TSegId first = 0,
+    const TSegId end = std::numeric_limits<TSegId>::max()
+  );
+
+  /** Get next unused identifier. */
+  TSegId next();
+
+  /** Reserve a range of identifiers.
+   *  \param num_ids  Number of identifiers to reserve.
+   *  \returns        Allocator handing out identifiers from reserved range.
+   */
+  std::shared_ptr<SegmentIdAllocator> fork(const TSegId num_ids);
+
+  /** Number of identifiers still available. */
+  TSegId available() const;
+};
+
+} // namespace seqio
+
+#endif // SEGMENTIDALLOCATOR_H
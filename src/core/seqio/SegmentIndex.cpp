@@ -0,0 +1,83 @@
+#include "SegmentIndex.hpp"
+#include <algorithm>
+#include <cassert>
+#include <tuple>
+
+using namespace std;
+
+namespace seqio {
+
+SegmentIndex::SegmentIndex () {}
+
+void
+SegmentIndex::build (
+  const vector<SegmentCopy>& segments
+)
+{
+  m_bkp.clear();
+  m_offset.clear();
+  m_ids.clear();
+
+  // SegmentCopy boundaries, structure: (position, is_start, id)
+  vector<tuple<TCoord, bool, TSegId>> vec_evt;
+  vec_evt.reserve(2*segments.size());
+  for (auto const & seg : segments) {
+    assert( seg.ref_start < seg.ref_end );
+    vec_evt.push_back(make_tuple(seg.ref_start, true, seg.id));
+    vec_evt.push_back(make_tuple(seg.ref_end, false, seg.id));
+  }
+  sort(vec_evt.begin(), vec_evt.end());
+
+  // sweep over boundaries, keeping ids of overlapping SegmentCopies sorted
+  vector<TSegId> vec_active;
+  m_offset.push_back(0);
+  size_t i = 0;
+  while (i < vec_evt.size()) {
+    TCoord pos = get<0>(vec_evt[i]);
+    for (; i < vec_evt.size() && get<0>(vec_evt[i]) == pos; ++i) {
+      TSegId id = get<2>(vec_evt[i]);
+      auto it = lower_bound(vec_active.begin(), vec_active.end(), id);
+      if (get<1>(vec_evt[i]))
+        vec_active.insert(it, id);
+      else if (it != vec_active.end() && *it == id)
+        vec_active.erase(it);
+    }
+    // last boundary closes final interval
+    if (i == vec_evt.size()) {
+      assert( vec_active.empty() );
+      m_bkp.push_back(pos);
+      break;
+    }
+    // join interval with predecessor if both contain the same SegmentCopies
+    if (m_bkp.size() > 0) {
+      size_t off_prev = m_offset[m_offset.size()-2];
+      if (m_ids.size() - off_prev == vec_active.size() &&
+          equal(vec_active.begin(), vec_active.end(), m_ids.begin() + off_prev))
+        continue;
+    }
+    m_bkp.push_back(pos);
+    m_ids.insert(m_ids.end(), vec_active.begin(), vec_active.end());
+    m_offset.push_back(m_ids.size());
+  }
+}
+
+pair<const TSegId*, const TSegId*>
+SegmentIndex::getSegmentIds (
+  const TCoord start,
+  const TCoord end
+) const
+{
+  const TSegId* p_ids = m_ids.data();
+  if (numIntervals() == 0 || start >= end || end <= m_bkp.front() || start >= m_bkp.back())
+    return make_pair(p_ids, p_ids);
+
+  // first interval ending after start, first interval starting at or after end
+  size_t idx_lo = upper_bound(m_bkp.begin(), m_bkp.end(), start) - m_bkp.begin();
+  idx_lo = idx_lo > 0 ? idx_lo-1 : 0;
+  size_t idx_hi = lower_bound(m_bkp.begin(), m_bkp.end(), end) - m_bkp.begin();
+  idx_hi = min(idx_hi, numIntervals());
+
+  return make_pair(p_ids + m_offset[idx_lo], p_ids + m_offset[idx_hi]);
+}
+
+} // namespace seqio
@@ -0,0 +1,53 @@
+#ifndef SEGMENTINDEX_H
+#define SEGMENTINDEX_H
+
+#include "SegmentCopy.hpp"
+#include "types.hpp"
+#include <utility>
+#include <vector>
+
+namespace seqio {
+
+/** Immutable index of SegmentCopies by reference position.
+ *
+ *  The reference is partitioned into elementary intervals at SegmentCopy
+ *  boundaries. For each interval, the ids of overlapping SegmentCopies are
+ *  stored (in ascending order) in a single flat array. As with
+ *  boost::icl::interval_map<TCoord, std::set<SegmentCopy>>, neighbouring
+ *  intervals with identical id sets are joined. Intervals not covered by any
+ *  SegmentCopy are kept (with an empty id set) to keep breakpoints contiguous.
+ *
+ *  Intervals overlapping a query range are consecutive, so their ids form a
+ *  contiguous slice of the flat array, located by binary search.
+ */
+struct SegmentIndex {
+  /** interval boundaries: interval i is [m_bkp[i], m_bkp[i+1]) */
+  std::vector<TCoord> m_bkp;
+  /** interval i owns ids m_ids[m_offset[i]] to m_ids[m_offset[i+1]-1] */
+  std::vector<size_t> m_offset;
+  /** SegmentCopy ids of all intervals */
+  std::vector<TSegId> m_ids;
+
+  /** default c'tor */
+  SegmentIndex();
+
+  /** Build index for a collection of SegmentCopies (replaces existing content). */
+  void build(const std::vector<SegmentCopy>& segments);
+
+  /** Number of elementary intervals. */
+  size_t numIntervals() const { return m_bkp.size() > 0 ? m_bkp.size()-1 : 0; }
+
+  /** Get ids of SegmentCopies overlapping interval [start, end).
+   *  An id occurs once for every elementary interval in which it overlaps.
+   *  \returns range of ids (pointers into index, empty if no overlap)
+   */
+  std::pair<const TSegId*, const TSegId*>
+  getSegmentIds (
+    const TCoord start,
+    const TCoord end
+  ) const;
+};
+
+} // namespace seqio
+
+#endif // SEGMENTINDEX_H
@@ -0,0 +1,430 @@
+#include "SegmentTree.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <limits>
+
+using namespace std;
+
+namespace seqio {
+
+typedef SegmentTree::Node TNode;
+typedef SegmentTree::Arena TArena;
+typedef SegmentTree::TNodeIdx TNodeIdx;
+
+/** Derive treap priority from SegmentCopy id (SplitMix64 finalizer). */
+static uint64_t
+getPriority (
+  const TSegId id
+)
+{
+  uint64_t z = id + 0x9e3779b97f4a7c15ULL;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+/** Create node and compute subtree summaries. */
+static TNodeIdx
+makeNode (
+  TArena& arena,
+  const SegmentCopy& seg,
+  const uint64_t priority,
+  const TNodeIdx left,
+  const TNodeIdx right
+)
+{
+  TNode node;
+  node.seg = seg;
+  node.priority = priority;
+  node.left = left;
+  node.right = right;
+  node.count = 1;
+  node.length = seg.ref_end - seg.ref_start;
+  node.ref_lo = seg.ref_start;
+  node.ref_hi = seg.ref_end;
+  for (const TNodeIdx child : { left, right }) {
+    if (!child) continue;
+    const TNode& c = arena[child];
+    node.count += c.count;
+    node.length += c.length;
+    node.ref_lo = min(node.ref_lo, c.ref_lo);
+    node.ref_hi = max(node.ref_hi, c.ref_hi);
+  }
+  return arena.alloc(node);
+}
+
+/** Create nodes of subtree rooted at vec_seg[i] (children given by index, -1: none). */
+static TNodeIdx
+buildNodes (
+  TArena& arena,
+  const vector<SegmentCopy>& vec_seg,
+  const vector<uint64_t>& vec_prio,
+  const vector<long>& vec_left,
+  const vector<long>& vec_right,
+  const long i
+)
+{
+  if (i < 0) return 0;
+  TNodeIdx left = buildNodes(arena, vec_seg, vec_prio, vec_left, vec_right, vec_left[i]);
+  TNodeIdx right = buildNodes(arena, vec_seg, vec_prio, vec_left, vec_right, vec_right[i]);
+  return makeNode(arena, vec_seg[i], vec_prio[i], left, right);
+}
+
+/** Concatenate two trees (all nodes of a precede those of b). */
+static TNodeIdx
+mergeNodes (
+  TArena& arena,
+  const TNodeIdx a,
+  const TNodeIdx b
+)
+{
+  if (!a) return b;
+  if (!b) return a;
+  const TNode& na = arena[a];
+  const TNode& nb = arena[b];
+  if (na.priority > nb.priority)
+    return makeNode(arena, na.seg, na.priority, na.left, mergeNodes(arena, na.right, b));
+  else
+    return makeNode(arena, nb.seg, nb.priority, mergeNodes(arena, a, nb.left), nb.right);
+}
+
+/** Split tree at physical position (cf. SegmentTree::split()). */
+static bool
+splitNodes (
+  TArena& arena,
+  const TNodeIdx t,
+  const TCoord pos,
+  TNodeIdx& left,
+  TNodeIdx& right,
+  SegmentCopy& seg_mid,
+  TCoord& off_mid
+)
+{
+  if (!t) {
+    left = 0;
+    right = 0;
+    return false;
+  }
+  const TNode& n = arena[t];
+  TCoord seg_start = n.left ? arena[n.left].length : 0;
+  TCoord seg_end = seg_start + (n.seg.ref_end - n.seg.ref_start);
+  bool has_mid = false;
+  TNodeIdx tmp = 0;
+  if (pos <= seg_start) { // node belongs to right part
+    has_mid = splitNodes(arena, n.left, pos, left, tmp, seg_mid, off_mid);
+    right = makeNode(arena, n.seg, n.priority, tmp, n.right);
+  } else if (pos >= seg_end) { // node belongs to left part
+    has_mid = splitNodes(arena, n.right, pos - seg_end, tmp, right, seg_mid, off_mid);
+    left = makeNode(arena, n.seg, n.priority, n.left, tmp);
+  } else { // node contains split position
+    left = n.left;
+    right = n.right;
+    seg_mid = n.seg;
+    off_mid = pos - seg_start;
+    has_mid = true;
+  }
+  return has_mid;
+}
+
+/** Collect SegmentCopy parts covering [start, end) (node subtree begins at offset). */
+static void
+collectPieces (
+  const TArena& arena,
+  const TNodeIdx t,
+  const TCoord offset,
+  const TCoord start,
+  const TCoord end,
+  vector<tuple<SegmentCopy, TCoord, TCoord>>& out_pieces
+)
+{
+  if (!t) return;
+  const TNode& n = arena[t];
+  TCoord seg_start = offset + (n.left ? arena[n.left].length : 0);
+  TCoord seg_end = seg_start + (n.seg.ref_end - n.seg.ref_start);
+  if (start < seg_start)
+    collectPieces(arena, n.left, offset, start, end, out_pieces);
+  if (start < seg_end && end > seg_start) {
+    TCoord ref_start = n.seg.ref_start + (max(start, seg_start) - seg_start);
+    TCoord ref_end = n.seg.ref_start + (min(end, seg_end) - seg_start);
+    out_pieces.push_back(make_tuple(n.seg, ref_start, ref_end));
+  }
+  if (end > seg_end)
+    collectPieces(arena, n.right, seg_end, start, end, out_pieces);
+}
+
+/** Collect SegmentCopies overlapping reference position (in physical order). */
+static void
+collectAt (
+  const TArena& arena,
+  const TNodeIdx t,
+  const TCoord ref_pos,
+  vector<SegmentCopy>& out_segments
+)
+{
+  if (!t) return;
+  const TNode& n = arena[t];
+  if (ref_pos < n.ref_lo || ref_pos >= n.ref_hi) return;
+  collectAt(arena, n.left, ref_pos, out_segments);
+  if (ref_pos >= n.seg.ref_start && ref_pos < n.seg.ref_end)
+    out_segments.push_back(n.seg);
+  collectAt(arena, n.right, ref_pos, out_segments);
+}
+
+/** Find node containing a SegmentCopy (0 if not found). */
+static TNodeIdx
+findNode (
+  const TArena& arena,
+  const TNodeIdx t,
+  const SegmentCopy& seg
+)
+{
+  if (!t) return 0;
+  const TNode& n = arena[t];
+  if (seg.ref_start < n.ref_lo || seg.ref_start >= n.ref_hi) return 0;
+  if (n.seg.id == seg.id) return t;
+  TNodeIdx res = findNode(arena, n.left, seg);
+  return res ? res : findNode(arena, n.right, seg);
+}
+
+/** Copy path to SegmentCopy, assigning new id (0 if not found). */
+static TNodeIdx
+replaceNodeId (
+  TArena& arena,
+  const TNodeIdx t,
+  const SegmentCopy& seg,
+  const TSegId id_new
+)
+{
+  if (!t) return 0;
+  const TNode& n = arena[t];
+  if (seg.ref_start < n.ref_lo || seg.ref_start >= n.ref_hi) return 0;
+  if (n.seg.id == seg.id) {
+    SegmentCopy seg_new = n.seg;
+    seg_new.id = id_new;
+    // keep priority to retain tree shape
+    return makeNode(arena, seg_new, n.priority, n.left, n.right);
+  }
+  TNodeIdx child = replaceNodeId(arena, n.left, seg, id_new);
+  if (child)
+    return makeNode(arena, n.seg, n.priority, child, n.right);
+  child = replaceNodeId(arena, n.right, seg, id_new);
+  if (child)
+    return makeNode(arena, n.seg, n.priority, n.left, child);
+  return 0;
+}
+
+SegmentTree::Arena::Arena ()
+: num_nodes(1) // node 0 is reserved for "no node"
+{
+  for (unsigned i = 0; i < NUM_CHUNKS; ++i)
+    chunks[i].store(nullptr, memory_order_relaxed);
+}
+
+SegmentTree::Arena::~Arena ()
+{
+  for (unsigned i = 0; i < NUM_CHUNKS; ++i) {
+    delete[] chunks[i].load(memory_order_relaxed);
+  }
+}
+
+SegmentTree::TNodeIdx
+SegmentTree::Arena::alloc (
+  const Node& node
+)
+{
+  uint64_t idx = num_nodes.fetch_add(1);
+  if (idx > numeric_limits<TNodeIdx>::max()) {
+    fprintf(stderr, "[ERROR] (SegmentTree::Arena::alloc) node limit (%lu) exceeded.\n", uint64_t(numeric_limits<TNodeIdx>::max()));
+    abort();
+  }
+  unsigned idx_chunk;
+  uint64_t off;
+  locate(idx, idx_chunk, off);
+  Node* chunk = chunks[idx_chunk].load(memory_order_acquire);
+  if (!chunk) {
+    lock_guard<mutex> lock(mtx_chunks);
+    chunk = chunks[idx_chunk].load(memory_order_relaxed);
+    if (!chunk) {
+      chunk = new Node[FIRST_CHUNK_LEN << idx_chunk];
+      chunks[idx_chunk].store(chunk, memory_order_release);
+    }
+  }
+  chunk[off] = node;
+  return TNodeIdx(idx);
+}
+
+SegmentTree::const_iterator::const_iterator (
+  const Arena* arena,
+  const TNodeIdx root
+)
+: arena(arena)
+{
+  for (TNodeIdx t = root; t; t = (*arena)[t].left)
+    stack.push_back(&(*arena)[t]);
+}
+
+SegmentTree::const_iterator&
+SegmentTree::const_iterator::operator++ ()
+{
+  const Node* n = stack.back();
+  if (n->right) {
+    // leftmost node of right subtree
+    for (TNodeIdx t = n->right; t; t = (*arena)[t].left)
+      stack.push_back(&(*arena)[t]);
+  } else {
+    // ascend until coming from a left subtree
+    stack.pop_back();
+    while (!stack.empty() && stack.back()->right && &(*arena)[stack.back()->right] == n) {
+      n = stack.back();
+      stack.pop_back();
+    }
+  }
+  return *this;
+}
+
+SegmentTree::const_iterator
+SegmentTree::const_iterator::operator++ (int)
+{
+  const_iterator it = *this;
+  ++(*this);
+  return it;
+}
+
+SegmentTree::SegmentTree () : root(0) {}
+
+SegmentTree::SegmentTree (
+  shared_ptr<Arena> sp_arena
+)
+: sp_arena(sp_arena), root(0) {}
+
+const SegmentCopy&
+SegmentTree::front () const
+{
+  assert( root );
+  const Arena& arena = *sp_arena;
+  TNodeIdx t = root;
+  while (arena[t].left)
+    t = arena[t].left;
+  return arena[t].seg;
+}
+
+void
+SegmentTree::push_back (
+  const SegmentCopy& seg
+)
+{
+  if (!sp_arena)
+    sp_arena = make_shared<Arena>();
+  TNodeIdx node = makeNode(*sp_arena, seg, getPriority(seg.id), 0, 0);
+  root = mergeNodes(*sp_arena, root, node);
+}
+
+void
+SegmentTree::build (
+  const vector<SegmentCopy>& vec_seg
+)
+{
+  if (!sp_arena)
+    sp_arena = make_shared<Arena>();
+  root = 0;
+  if (vec_seg.empty())
+    return;
+
+  // Cartesian tree by priority (same shape as appending SegmentCopies one by one)
+  size_t n = vec_seg.size();
+  vector<uint64_t> vec_prio(n);
+  vector<long> vec_left(n, -1), vec_right(n, -1);
+  vector<long> stack;
+  for (size_t i = 0; i < n; ++i) {
+    vec_prio[i] = getPriority(vec_seg[i].id);
+    long last = -1;
+    while (!stack.empty() && vec_prio[stack.back()] <= vec_prio[i]) {
+      last = stack.back();
+      stack.pop_back();
+    }
+    vec_left[i] = last;
+    if (!stack.empty())
+      vec_right[stack.back()] = i;
+    stack.push_back(i);
+  }
+  root = buildNodes(*sp_arena, vec_seg, vec_prio, vec_left, vec_right, stack.front());
+}
+
+void
+SegmentTree::append (
+  const SegmentTree& other
+)
+{
+  if (other.empty())
+    return;
+  if (!sp_arena)
+    sp_arena = other.sp_arena;
+  assert( sp_arena == other.sp_arena );
+  root = mergeNodes(*sp_arena, root, other.root);
+}
+
+bool
+SegmentTree::split (
+  const TCoord pos,
+  SegmentTree& left,
+  SegmentTree& right,
+  SegmentCopy& seg_mid,
+  TCoord& off_mid
+) const
+{
+  left.sp_arena = sp_arena;
+  right.sp_arena = sp_arena;
+  left.root = 0;
+  right.root = 0;
+  if (!root)
+    return false;
+  return splitNodes(*sp_arena, root, pos, left.root, right.root, seg_mid, off_mid);
+}
+
+void
+SegmentTree::getPieces (
+  const TCoord start,
+  const TCoord end,
+  vector<tuple<SegmentCopy, TCoord, TCoord>>& out_pieces
+) const
+{
+  if (root)
+    collectPieces(*sp_arena, root, 0, start, end, out_pieces);
+}
+
+void
+SegmentTree::getSegmentCopiesAt (
+  const TCoord ref_pos,
+  vector<SegmentCopy>& out_segments
+) const
+{
+  if (root)
+    collectAt(*sp_arena, root, ref_pos, out_segments);
+}
+
+bool
+SegmentTree::contains (
+  const SegmentCopy& seg
+) const
+{
+  return root && findNode(*sp_arena, root, seg) != 0;
+}
+
+bool
+SegmentTree::replaceId (
+  const SegmentCopy& seg,
+  const TSegId id_new
+)
+{
+  if (!root)
+    return false;
+  TNodeIdx root_new = replaceNodeId(*sp_arena, root, seg, id_new);
+  if (!root_new)
+    return false;
+  root = root_new;
+  return true;
+}
+
+} // namespace seqio
@@ -0,0 +1,213 @@
+#ifndef SEGMENTTREE_H
+#define SEGMENTTREE_H
+
+#include "SegmentCopy.hpp"
+#include "types.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+namespace seqio {
+
+/** Ordered sequence of SegmentCopies, indexed by physical position.
+ *
+ *  Implemented as a persistent treap with implicit keys: each node stores
+ *  the physical length of its subtree, so the SegmentCopy at a given
+ *  position is located in O(log n). Nodes are immutable and shared between
+ *  trees, copying a SegmentTree is O(1) and modifications (split, append)
+ *  only copy the O(log n) nodes along the affected path.
+ *  Additionally, nodes keep the reference interval spanned by their subtree,
+ *  which allows pruning when searching SegmentCopies by reference position.
+ *  Nodes live in an Arena shared by all trees derived from each other and are
+ *  referenced by index. Nodes are never released individually: each
+ *  modification leaves O(log n) replaced nodes behind, which are released
+ *  together with the Arena (i.e. once no tree refers to it anymore).
+ */
+struct SegmentTree {
+  /** Index of a node in the Arena (0: no node). */
+  typedef uint32_t TNodeIdx;
+
+  /** Tree node (immutable once created). */
+  struct Node {
+    /** SegmentCopy stored in this node */
+    SegmentCopy seg;
+    /** heap priority (derived from SegmentCopy id) */
+    uint64_t priority;
+    /** left and right subtrees */
+    TNodeIdx left, right;
+    /** number of SegmentCopies in subtree */
+    size_t count;
+    /** physical length of subtree */
+    TCoord length;
+    /** reference interval [ref_lo, ref_hi) spanned by SegmentCopies in subtree */
+    TCoord ref_lo, ref_hi;
+  };
+
+  /** Pool of tree nodes, released in bulk.
+   *
+   *  Nodes are stored in chunks of doubling size (allocated on demand), so
+   *  existing nodes never move and a small Arena only holds a small chunk.
+   *  Allocation is thread-safe: trees of different clones may be modified
+   *  concurrently while sharing an Arena.
+   */
+  struct Arena {
+    /** length of first chunk (chunk k holds FIRST_CHUNK_LEN << k nodes) */
+    static const unsigned FIRST_CHUNK_BITS = 5;
+    static const uint64_t FIRST_CHUNK_LEN = uint64_t(1) << FIRST_CHUNK_BITS;
+    /** number of chunks needed to address all node indices */
+    static const unsigned NUM_CHUNKS = 8*sizeof(TNodeIdx) + 1 - FIRST_CHUNK_BITS;
+
+    /** chunks of nodes (allocated on demand) */
+    std::atomic<Node*> chunks[NUM_CHUNKS];
+    /** number of allocated nodes (including unused node 0) */
+    std::atomic<uint64_t> num_nodes;
+    /** guards allocation of chunks */
+    std::mutex mtx_chunks;
+
+    /** default c'tor */
+    Arena();
+    /** d'tor: releases all nodes */
+    ~Arena();
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    /** Store a node, returns its index. */
+    TNodeIdx alloc(const Node& node);
+    /** Access node by index (must not be 0). */
+    const Node& operator[](const TNodeIdx idx) const {
+      unsigned idx_chunk;
+      uint64_t off;
+      locate(idx, idx_chunk, off);
+      return chunks[idx_chunk].load(std::memory_order_acquire)[off];
+    }
+    /** Number of nodes allocated so far. */
+    size_t size() const { return num_nodes.load() - 1; }
+
+    /** Get chunk and offset within chunk of a node index. */
+    static void
+    locate(const uint64_t idx, unsigned& idx_chunk, uint64_t& off) {
+      // chunk k starts at index FIRST_CHUNK_LEN * (2^k - 1)
+      uint64_t x = idx + FIRST_CHUNK_LEN;
+      unsigned msb = 63 - __builtin_clzll(x);
+      idx_chunk = msb - FIRST_CHUNK_BITS;
+      off = x - (uint64_t(1) << msb);
+    }
+  };
+
+  /** Visits SegmentCopies in physical order. */
+  struct const_iterator {
+    typedef std::forward_iterator_tag iterator_category;
+    typedef SegmentCopy value_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef const SegmentCopy* pointer;
+    typedef const SegmentCopy& reference;
+
+    /** Arena holding the nodes */
+    const Arena* arena;
+    /** path from root to current node (current node last) */
+    std::vector<const Node*> stack;
+
+    const_iterator() : arena(nullptr) {}
+    const_iterator(const Arena* arena, const TNodeIdx root);
+    reference operator*() const { return stack.back()->seg; }
+    pointer operator->() const { return &(stack.back()->seg); }
+    const_iterator& operator++();
+    const_iterator operator++(int);
+    bool operator==(const const_iterator& rhs) const { return stack == rhs.stack; }
+    bool operator!=(const const_iterator& rhs) const { return stack != rhs.stack; }
+  };
+
+  /** Arena holding the nodes (created on first insertion unless given). */
+  std::shared_ptr<Arena> sp_arena;
+  /** Root node (0 if empty). */
+  TNodeIdx root;
+
+  /** default c'tor */
+  SegmentTree();
+  /** Create empty tree allocating nodes from a given Arena. */
+  explicit SegmentTree(std::shared_ptr<Arena> sp_arena);
+
+  /** Number of SegmentCopies. */
+  size_t size() const { return root ? (*sp_arena)[root].count : 0; }
+  /** Physical length (sum of SegmentCopy lengths). */
+  TCoord length() const { return root ? (*sp_arena)[root].length : 0; }
+  /** Is the tree empty? */
+  bool empty() const { return !root; }
+  /** First SegmentCopy (tree must not be empty). */
+  const SegmentCopy& front() const;
+
+  const_iterator begin() const { return const_iterator(sp_arena.get(), root); }
+  const_iterator end() const { return const_iterator(); }
+
+  /** Append a SegmentCopy. */
+  void push_back(const SegmentCopy& seg);
+  /** Replace contents by a sequence of SegmentCopies (in physical order).
+   *  Builds the tree in O(n), without the intermediate nodes of repeated push_back().
+   */
+  void build(const std::vector<SegmentCopy>& vec_seg);
+  /** Append all SegmentCopies of another tree (must share this tree's Arena). */
+  void append(const SegmentTree& other);
+
+  /** Split tree at a physical position.
+   *  SegmentCopies ending at or before pos go to the left, the ones starting
+   *  at or after pos to the right. A SegmentCopy containing pos is part of neither.
+   *  Both parts share this tree's Arena.
+   *  \param pos      physical position at which to split.
+   *  \param left     Output param: SegmentCopies left of pos.
+   *  \param right    Output param: SegmentCopies right of pos.
+   *  \param seg_mid  Output param: SegmentCopy containing pos (if any).
+   *  \param off_mid  Output param: offset of pos within seg_mid.
+   *  \returns        true if a SegmentCopy contains pos, false otherwise.
+   */
+  bool
+  split (
+    const TCoord pos,
+    SegmentTree& left,
+    SegmentTree& right,
+    SegmentCopy& seg_mid,
+    TCoord& off_mid
+  ) const;
+
+  /** Get parts of SegmentCopies covering a physical interval.
+   *  \param start       physical start position (inclusive).
+   *  \param end         physical end position (exclusive).
+   *  \param out_pieces  Output param: tuples (SegmentCopy, ref_start, ref_end) of covered parts, in order.
+   */
+  void
+  getPieces (
+    const TCoord start,
+    const TCoord end,
+    std::vector<std::tuple<SegmentCopy, TCoord, TCoord>>& out_pieces
+  ) const;
+
+  /** Get SegmentCopies overlapping a reference position. */
+  void
+  getSegmentCopiesAt (
+    const TCoord ref_pos,
+    std::vector<SegmentCopy>& out_segments
+  ) const;
+
+  /** Check if tree contains a SegmentCopy (identified by id). */
+  bool
+  contains (
+    const SegmentCopy& seg
+  ) const;
+
+  /** Change the id of a SegmentCopy.
+   *  \returns true on success, false if SegmentCopy is not part of tree.
+   */
+  bool
+  replaceId (
+    const SegmentCopy& seg,
+    const TSegId id_new
+  );
+};
+
+} // namespace seqio
+
+#endif // SEGMENTTREE_H
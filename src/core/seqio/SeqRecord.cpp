@@ -1,11 +1,84 @@
 #include "SeqRecord.hpp"
+#include <algorithm>
+#include <cstring>
 
 using namespace std;
 
 namespace seqio {
 
 SeqRecord::SeqRecord(const string id, const string desc, const string& seq)
-  : id(id), description(desc), seq(seq), id_ref(id), chr_copy(0) {}
+  : id(id), description(desc), seq(seq), is_packed(false), is_mapped(false), id_ref(id), chr_copy(0) {}
 SeqRecord::~SeqRecord() {}
 
-} // namespace seqio
\ No newline at end of file
+void SeqRecord::pack() {
+  if (is_packed)
+    return;
+  if (is_mapped) {
+    this->getSubSeq(0, fai.length, seq);
+    sp_fasta.reset();
+    is_mapped = false;
+  }
+  seq_packed.assign(seq);
+  string().swap(seq);
+  is_packed = true;
+}
+
+void SeqRecord::map(shared_ptr<MappedFile> sp_file, const FaiRecord& rec_fai) {
+  sp_fasta = sp_file;
+  fai = rec_fai;
+  string().swap(seq);
+  seq_packed.clear();
+  is_packed = false;
+  is_mapped = true;
+}
+
+TCoord SeqRecord::length() const {
+  if (is_mapped)
+    return fai.length;
+  return is_packed ? seq_packed.length : seq.length();
+}
+
+char SeqRecord::getNucAt(const TCoord pos) const {
+  if (is_mapped)
+    return sp_fasta->data[fai.getOffset(pos)];
+  return is_packed ? seq_packed.getNucAt(pos) : seq[pos];
+}
+
+void SeqRecord::setNucAt(const TCoord pos, const char nuc) {
+  if (is_mapped) // modifies private copy of mapped page
+    sp_fasta->data[fai.getOffset(pos)] = nuc;
+  else if (is_packed)
+    seq_packed.setNucAt(pos, nuc);
+  else
+    seq[pos] = nuc;
+}
+
+void SeqRecord::getSubSeq(const TCoord start, const TCoord len, string& out) const {
+  TCoord n = this->length();
+  out.resize(start < n ? min(len, n - start) : 0);
+  this->copySubSeq(start, len, &out[0]);
+}
+
+TCoord SeqRecord::copySubSeq(const TCoord start, const TCoord len, char* out) const {
+  if (is_packed)
+    return seq_packed.copy(start, len, out);
+  TCoord n_total = this->length();
+  if (start >= n_total)
+    return 0;
+  TCoord n = min(len, n_total - start);
+  if (is_mapped) {
+    // copy line by line, skipping newlines
+    TCoord i = 0;
+    while (i < n) {
+      TCoord pos = start + i;
+      TCoord num_bases = min(n - i, TCoord(fai.line_bases - pos % fai.line_bases));
+      memcpy(out + i, sp_fasta->data + fai.getOffset(pos), num_bases);
+      i += num_bases;
+    }
+  }
+  else
+    memcpy(out, seq.data() + start, n);
+  return n;
+}
+
+} // namespace seqio
@@ -1,6 +1,11 @@
 #ifndef SEQRECORD_H
 #define SEQRECORD_H
 
+#include "FaiRecord.hpp"
+#include "MappedFile.hpp"
+#include "PackedSequence.hpp"
+#include "types.hpp"
+#include <memory>
 #include <string>
 
 namespace seqio {
@@ -9,13 +14,46 @@ struct SeqRecord
 {
   std::string id;          /** identifier */
   std::string description; /** sequence description (everything after first space in ID line) */
-  std::string seq;         /** actual sequence */
+  std::string seq;         /** actual sequence (empty if sequence has been packed) */
+  PackedSequence seq_packed; /** 2-bit packed sequence (see pack()) */
+  bool is_packed;          /** sequence is stored in seq_packed */
+  std::shared_ptr<MappedFile> sp_fasta; /** memory-mapped FASTA file (see map()) */
+  FaiRecord fai;           /** location of sequence in mapped FASTA file */
+  bool is_mapped;          /** sequence is read from sp_fasta */
   std::string id_ref;      /** identifier in reference genome (ploidy) */
   short chr_copy;          /** chromosome copy (0 for haploid) */
   SeqRecord(const std::string, const std::string, const std::string&);
   ~SeqRecord();
+
+  /** Move sequence into 2-bit packed storage, releasing the plain text. */
+  void pack();
+  /** Serve sequence from a memory-mapped FASTA file, located by a .fai entry. */
+  void map(std::shared_ptr<MappedFile> sp_file, const FaiRecord& rec_fai);
+  /** Get number of bases in sequence. */
+  TCoord length() const;
+  /** Get nucleotide at position (0-based). */
+  char getNucAt(const TCoord pos) const;
+  /** Set nucleotide at position (0-based). */
+  void setNucAt(const TCoord pos, const char nuc);
+  /**
+   * Get subsequence, regardless of how the sequence is stored.
+   *
+   * \param start  start position (0-based)
+   * \param len    number of bases (truncated at sequence end)
+   * \param out    output parameter, receives subsequence
+   */
+  void getSubSeq(const TCoord start, const TCoord len, std::string& out) const;
+  /**
+   * Copy subsequence into a caller-provided buffer (does not allocate).
+   *
+   * \param start  start position (0-based)
+   * \param len    number of bases (truncated at sequence end)
+   * \param out    output buffer (must hold at least len chars)
+   * \returns      number of copied bases
+   */
+  TCoord copySubSeq(const TCoord start, const TCoord len, char* out) const;
 };
 
 } // namespace seqio
 
-#endif // SEQRECORD_H
\ No newline at end of file
+#endif // SEQRECORD_H
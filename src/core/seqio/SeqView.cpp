@@ -0,0 +1,29 @@
+#include "SeqView.hpp"
+#include <algorithm>
+
+using namespace std;
+
+namespace seqio {
+
+SeqView::SeqView() : rec(nullptr), start(0), len(0), pos_chr(0) {}
+
+SeqView::SeqView(
+  const SeqRecord* rec,
+  const TCoord start,
+  const TCoord len,
+  const TCoord pos_chr
+)
+: rec(rec), start(start), len(len), pos_chr(pos_chr) {}
+
+TCoord SeqView::copy(const TCoord pos, const TCoord n, char* buf) const {
+  if (pos >= len)
+    return 0;
+  return rec->copySubSeq(start + pos, min(n, len - pos), buf);
+}
+
+void SeqView::str(string& out) const {
+  out.resize(len);
+  this->copy(0, len, &out[0]);
+}
+
+} // namespace seqio
@@ -0,0 +1,68 @@
+#ifndef SEQVIEW_H
+#define SEQVIEW_H
+
+#include "SeqRecord.hpp"
+#include "types.hpp"
+#include <iterator>
+#include <string>
+
+namespace seqio {
+
+/**
+ * Read-only view of a stretch of a sequence record.
+ *
+ * A view does not copy any sequence data; bases are decoded from the
+ * underlying storage (plain, packed or memory-mapped) on access.
+ * The view is valid as long as the SeqRecord it refers to.
+ */
+struct SeqView
+{
+  /** sequence record the view refers to */
+  const SeqRecord* rec;
+  /** start position within sequence record */
+  TCoord start;
+  /** number of bases */
+  TCoord len;
+  /** start position in chromosome coordinates */
+  TCoord pos_chr;
+
+  /** Iterates over the bases of a view. */
+  struct const_iterator : public std::iterator<std::forward_iterator_tag, char>
+  {
+    const SeqView* view;
+    TCoord pos;
+    const_iterator(const SeqView* view, TCoord pos) : view(view), pos(pos) {}
+    char operator*() const { return (*view)[pos]; }
+    const_iterator& operator++() { ++pos; return *this; }
+    bool operator==(const const_iterator& rhs) const { return pos == rhs.pos; }
+    bool operator!=(const const_iterator& rhs) const { return pos != rhs.pos; }
+  };
+
+  /** default c'tor */
+  SeqView();
+  /** c'tor */
+  SeqView(const SeqRecord* rec, const TCoord start, const TCoord len, const TCoord pos_chr);
+
+  /** Get number of bases. */
+  TCoord length() const { return len; }
+  /** Get base at position (relative to view start). */
+  char operator[](const TCoord i) const { return rec->getNucAt(start + i); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, len); }
+
+  /**
+   * Copy bases into a caller-provided buffer.
+   *
+   * \param pos  start position (relative to view start)
+   * \param n    number of bases (truncated at view end)
+   * \param buf  output buffer (must hold at least n chars)
+   * \returns    number of copied bases
+   */
+  TCoord copy(const TCoord pos, const TCoord n, char* buf) const;
+  /** Decode view into a string (reuses the string's capacity). */
+  void str(std::string& out) const;
+};
+
+} // namespace seqio
+
+#endif // SEQVIEW_H
@@ -1,9 +1,8 @@
 #ifndef SEQIO_TYPES_H
 #define SEQIO_TYPES_H
 
-#include <boost/uuid/uuid.hpp>
-#include <boost/uuid/uuid_generators.hpp>
-#include <boost/uuid/uuid_io.hpp>
+#include <cstdint>
+#include <string>
 #include <tuple>
 
 namespace seqio {
@@ -13,11 +12,16 @@ enum Nuc {
   A, C, G, T, N 
 };
 
-/** Represents genomic coordinates. */
+/** Represents genomic coordinates (64-bit, also for genomes > 4 Gbp). */
 typedef
-unsigned long 
+uint64_t
 TCoord;
 
+/** Identifies a SegmentCopy (handed out by SegmentIdAllocator). */
+typedef
+uint64_t
+TSegId;
+
 /** Represents genomic regions (chromosome, start, end). */
 typedef 
 std::tuple<
@@ -29,17 +33,17 @@ TRegion;
 
 /** Documents a modification introduced to a SegmentCopy.
  *  Structure: (new, old, start, end)
- *   - new: UUID of newly created SegmentCopy
- *   - old: UUID of existing SegmentCopy to be replaced
+ *   - new: ID of newly created SegmentCopy
+ *   - old: ID of existing SegmentCopy to be replaced
  *   - start: start coordinate within old SegmentCopy covered by the new one
  *   - end: end coordinate within old SegmentCopy covered by the new one
  */
 typedef 
 std::tuple<
-  boost::uuids::uuid, 
-  boost::uuids::uuid, 
-  unsigned long, 
-  unsigned long
+  TSegId, 
+  TSegId, 
+  TCoord, 
+  TCoord
 >
 seg_mod_t;
 
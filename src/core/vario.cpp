@@ -8,7 +8,6 @@
 #include <cstdio>
 
 using namespace std;
-using boost::uuids::uuid;
 using stringio::format;
 using seqio::ChromosomeInstance;
 using seqio::Locus;
@@ -17,8 +16,9 @@ using seqio::TCoord;
 
 namespace vario {
 
-Variant::Variant(std::string id, std::string chr, unsigned long pos)
- : id(id), chr(chr), pos(pos) {}
+Variant::Variant(std::string id, std::string chr, TCoord pos)
+ : id(id), chr(chr), reg_copy(0), pos(pos), alleles(0), idx_mutation(0), rel_pos(0.0),
+   is_somatic(false), is_het(true), is_error(false) {}
 
 /* VariantSet
  *------------*/
@@ -49,7 +49,7 @@ long VariantSet::indexVariants() {
 
   for (Variant var : this->vec_variants) {
     if (this->map_chr2pos2var.find(var.chr) == this->map_chr2pos2var.end())
-      this->map_chr2pos2var[var.chr] = map<unsigned long, vector<Variant>>();
+      this->map_chr2pos2var[var.chr] = map<TCoord, vector<Variant>>();
     //if (this->map_chr2pos2var[var.chr].find(var.pos) == this->map_chr2pos2var[var.chr].end())
     //  this->map_chr2pos2var[var.chr][var.pos] = vector<Variant>>();
     this->map_chr2pos2var[var.chr][var.pos].push_back(var);
@@ -146,6 +146,7 @@ ostream& operator<<(ostream& lhs, const CopyNumberVariant& cnv) {
 Variant::Variant ()
 : id(""),
   chr(""),
+  reg_copy(0),
   pos(0),
   alleles(0),
   idx_mutation(0),
@@ -458,7 +459,7 @@ void writeVcf (
   vector<TCoord> vec_ref_len;
   for (auto rec : seqs) {
     vec_ref_ids.push_back(rec->id_ref);
-    vec_ref_len.push_back(rec->seq.size());
+    vec_ref_len.push_back(rec->length());
   }
 
   // write header
@@ -609,25 +610,25 @@ vector<Variant> generateVariantsRandomPos(
   const bool inf_sites)
 {
   vector<Variant> variants = vector<Variant>(num_variants);
-  boost::container::flat_set<int> var_pos; // keep track of variant positions
+  boost::container::flat_set<TCoord> var_pos; // keep track of variant positions
   function<double()> random_float = rng.getRandomFunctionReal(0.0, 1.0);
-  function<long()> random_pos = rng.getRandomFunctionInt<long>(0, genome.length);
+  function<TCoord()> random_pos = rng.getRandomFunctionInt(TCoord(0), genome.length-1);
   function<short()> random_copy = rng.getRandomFunctionInt(short(0), short(genome.ploidy-1));
   random_selector<> selector(rng.generator); // used to pick random vector indices
 
   for (int i=0; i<num_variants; ++i) {
     // pick random position
-    long nuc_pos = random_pos();
+    TCoord nuc_pos = random_pos();
     if (inf_sites) {
       while (binary_search(var_pos.begin(), var_pos.end(), nuc_pos)) {
-fprintf(stderr, "locus %ld has been mutated before, picking another one...\n", nuc_pos);
+fprintf(stderr, "locus %lu has been mutated before, picking another one...\n", nuc_pos);
         nuc_pos = random_pos();
       }
       var_pos.insert(nuc_pos);
     }
     Locus loc = genome.getLocusByGlobalPos(nuc_pos);
     string id_chr = genome.records[loc.idx_record]->id;
-    short ref_nuc = seqio::nuc2idx(genome.records[loc.idx_record]->seq[loc.start]);
+    short ref_nuc = seqio::nuc2idx(genome.records[loc.idx_record]->getNucAt(loc.start));
     // pick new nucleotide
     short nuc_alt = evolution::MutateSite(ref_nuc, random_float, model);
     Variant var;
@@ -708,11 +709,11 @@ fprintf(stderr, "genotypes: %lu\n", genotypes.size());
       unsigned chr_idx = it_chr_idx->second;
       // only apply variant if any allele is non-reference
       if (gt.maternal>0) {
-        genome.records[chr_idx]->seq[var.pos-1] = var.alleles[gt.maternal][0]; // TODO: at the moment only SNVs are supported ("[0]" extracts the first character from the allel)
+        genome.records[chr_idx]->setNucAt(var.pos-1, var.alleles[gt.maternal][0]); // TODO: at the moment only SNVs are supported ("[0]" extracts the first character from the allel)
       }
       if (gt.paternal>0) {
 //fprintf(stderr, "\t%lu paternal: '%s' -> '%s'\n", var.pos, var.alleles[0].c_str(), var.alleles[gt.paternal].c_str());
-        genome.records[num_sequences+chr_idx]->seq[var.pos-1] = var.alleles[gt.paternal][0];
+        genome.records[num_sequences+chr_idx]->setNucAt(var.pos-1, var.alleles[gt.paternal][0]);
       }
     }
     else {
@@ -8,8 +8,6 @@
 #include "seqio/GenomeInstance.hpp"
 #include "stringio.hpp"
 #include "evolution.hpp"
-#include <boost/uuid/uuid.hpp>
-#include <boost/uuid/uuid_generators.hpp>
 #include <fstream>
 #include <functional>
 #include <iostream>
@@ -44,7 +42,7 @@ struct Variant
   bool is_error;      /** true: Variant due to sequencing error (only applies to read count sim) */
 
   Variant();
-  Variant(std::string id, std::string chr, unsigned long pos);
+  Variant(std::string id, std::string chr, seqio::TCoord pos);
   ~Variant();
 
   bool operator< (const Variant&) const; /** make variants sortable */
@@ -65,7 +63,7 @@ struct VariantSet
 {
   unsigned long num_variants = 0;
   std::vector<Variant> vec_variants; /** all variants that belong to the set */
-  std::map<std::string, std::map<unsigned long, std::vector<Variant>>> map_chr2pos2var; /** variants stored by chromosome id */
+  std::map<std::string, std::map<seqio::TCoord, std::vector<Variant>>> map_chr2pos2var; /** variants stored by chromosome id */
 
   /** summary statistics */
   double mat_freqs[4][4] = {
@@ -134,8 +132,8 @@ struct CopyNumberVariant
   bool        is_forward;      /** true: event at 3' side of start_rel; false: at 5' end */
   double      len_rel;         /** length of affected region (fraction of chromsome length) */
   double      start_rel;       /** start position of event (fraction of chromosome length) */
-  unsigned    ref_pos_begin;   /** start coordinate (in reference chr) */
-  unsigned    ref_pos_end;     /** end coordinate (in reference chr) */
+  seqio::TCoord ref_pos_begin; /** start coordinate (in reference chr) */
+  seqio::TCoord ref_pos_end;   /** end coordinate (in reference chr) */
   std::string ref_chr;         /** affected chromosome (reference ID) */
 
   /** default c'tor */
@@ -0,0 +1,193 @@
+#include "HaplotypeStore.hpp"
+#include <fstream>
+
+using namespace std;
+using seqio::ChromosomeInstance;
+using seqio::ChromosomeReference;
+using seqio::SegmentCopy;
+using seqio::SeqView;
+using seqio::TCoord;
+
+namespace vario {
+
+HaplotypeStore::HaplotypeStore () {}
+
+shared_ptr<seqan::CharString>
+HaplotypeStore::getHost (
+  const string& id_chr,
+  const GenomeReference& reference
+)
+{
+  auto it_host = this->map_chr_host.find(id_chr);
+  if (it_host != this->map_chr_host.end())
+    return it_host->second;
+
+  // positions not covered by sequence records (e.g. between exons) are 'N'
+  const ChromosomeReference& chr_ref = *(reference.chromosomes.at(id_chr));
+  shared_ptr<seqan::CharString> sp_host = make_shared<seqan::CharString>();
+  seqan::resize(*sp_host, chr_ref.length, 'N');
+  vector<SeqView> views;
+  if (chr_ref.length > 0)
+    reference.getSequenceViews(id_chr, 0, chr_ref.length, views);
+  for (auto const & view : views)
+    view.copy(0, view.length(), &((*sp_host)[view.pos_chr]));
+  this->map_chr_host[id_chr] = sp_host;
+
+  return sp_host;
+}
+
+bool
+HaplotypeStore::addClone (
+  const string& lbl_clone,
+  const GenomeInstance& genome,
+  const GenomeReference& reference,
+  const VariantStore& var_store
+)
+{
+  map<string, vector<shared_ptr<TJournaledString>>>& map_chr_hap = this->map_clone_chr_hap[lbl_clone];
+  map_chr_hap.clear();
+
+  for (auto const & id_ci : genome.map_id_chr) {
+    const string& id_chr = id_ci.first;
+    if (reference.chromosomes.count(id_chr) == 0) {
+      fprintf(stderr, "[ERROR] (HaplotypeStore::addClone) chromosome '%s' not in reference.\n", id_chr.c_str());
+      return false;
+    }
+    shared_ptr<seqan::CharString> sp_host = this->getHost(id_chr, reference);
+    TCoord len_host = seqan::length(*sp_host);
+
+    for (const shared_ptr<ChromosomeInstance>& sp_chr : id_ci.second) {
+      shared_ptr<TJournaledString> sp_hap = make_shared<TJournaledString>();
+      seqan::setHost(*sp_hap, *sp_host);
+
+      // haplotype starts out as host, pos_hap: current position in haplotype,
+      // pos_host: host position located at pos_hap (if host is still in order)
+      TCoord pos_hap = 0;
+      TCoord pos_host = 0;
+      for (const SegmentCopy& seg : sp_chr->segments) {
+        TCoord len_seg = seg.ref_end - seg.ref_start;
+        if (seg.ref_start >= pos_host) {
+          // SegmentCopy follows in reference order, skip host region in between
+          if (seg.ref_start > pos_host)
+            seqan::erase(*sp_hap, pos_hap, pos_hap + (seg.ref_start - pos_host));
+          pos_host = seg.ref_end;
+        } else {
+          // SegmentCopy out of order, insert copy of host region
+          seqan::insert(*sp_hap, pos_hap, seqan::infix(*sp_host, seg.ref_start, seg.ref_end));
+        }
+
+        // apply SNVs carried by SegmentCopy
+        auto it_seg_vars = var_store.map_seg_vars.find(seg.id);
+        if (it_seg_vars != var_store.map_seg_vars.end()) {
+          const VariantTable& tbl_snv = var_store.tbl_snv;
+          for (int id_var : *(it_seg_vars->second)) {
+            VariantTable::TRow row = tbl_snv.getRow(id_var);
+            if (row == VariantTable::NO_ROW)
+              continue;
+            assert( tbl_snv.pos(row) >= seg.ref_start && tbl_snv.pos(row) < seg.ref_end );
+            seqan::assignValue(*sp_hap, pos_hap + (tbl_snv.pos(row) - seg.ref_start), tbl_snv.alt(row));
+          }
+        }
+        pos_hap += len_seg;
+      }
+      // remove remaining host sequence
+      if (len_host > pos_host)
+        seqan::erase(*sp_hap, pos_hap, pos_hap + (len_host - pos_host));
+      assert( seqan::length(*sp_hap) == sp_chr->length );
+
+      map_chr_hap[id_chr].push_back(sp_hap);
+    }
+  }
+
+  return true;
+}
+
+bool
+HaplotypeStore::removeClone (
+  const string& lbl_clone
+)
+{
+  return this->map_clone_chr_hap.erase(lbl_clone) > 0;
+}
+
+size_t
+HaplotypeStore::getNumHaplotypes (
+  const string& lbl_clone,
+  const string& id_chr
+) const
+{
+  auto it_clone = this->map_clone_chr_hap.find(lbl_clone);
+  if (it_clone == this->map_clone_chr_hap.end())
+    return 0;
+  auto it_chr = it_clone->second.find(id_chr);
+  if (it_chr == it_clone->second.end())
+    return 0;
+  return it_chr->second.size();
+}
+
+bool
+HaplotypeStore::getSequence (
+  const string& lbl_clone,
+  const string& id_chr,
+  const size_t idx_hap,
+  const TCoord start,
+  const TCoord end,
+  string& out_seq
+) const
+{
+  out_seq.clear();
+  if (idx_hap >= this->getNumHaplotypes(lbl_clone, id_chr))
+    return false;
+  const TJournaledString& hap = *(this->map_clone_chr_hap.at(lbl_clone).at(id_chr)[idx_hap]);
+  TCoord len_hap = seqan::length(hap);
+  TCoord pos_end = min(end, len_hap);
+  if (start >= pos_end)
+    return true;
+
+  out_seq.resize(pos_end - start);
+  seqan::Iterator<const TJournaledString>::Type it = seqan::begin(hap) + start;
+  for (size_t i = 0; i < out_seq.length(); ++i, ++it)
+    out_seq[i] = *it;
+
+  return true;
+}
+
+bool
+HaplotypeStore::writeFasta (
+  const string& lbl_clone,
+  const string& filename,
+  const unsigned line_width
+) const
+{
+  auto it_clone = this->map_clone_chr_hap.find(lbl_clone);
+  if (it_clone == this->map_clone_chr_hap.end()) {
+    fprintf(stderr, "[ERROR] (HaplotypeStore::writeFasta) clone '%s' not found.\n", lbl_clone.c_str());
+    return false;
+  }
+  ofstream ofs(filename);
+  if (!ofs.good()) {
+    fprintf(stderr, "[ERROR] (HaplotypeStore::writeFasta) cannot write to file '%s'.\n", filename.c_str());
+    return false;
+  }
+
+  string line(line_width, 'N');
+  for (auto const & id_haps : it_clone->second) {
+    for (size_t i = 0; i < id_haps.second.size(); ++i) {
+      const TJournaledString& hap = *(id_haps.second[i]);
+      ofs << stringio::format(">%s_%lu\n", id_haps.first.c_str(), i);
+      seqan::Iterator<const TJournaledString>::Type it = seqan::begin(hap);
+      TCoord len_hap = seqan::length(hap);
+      for (TCoord pos = 0; pos < len_hap; pos += line_width) {
+        size_t len_line = min(TCoord(line_width), len_hap - pos);
+        for (size_t j = 0; j < len_line; ++j, ++it)
+          line[j] = *it;
+        ofs.write(line.data(), len_line);
+        ofs.put('\n');
+      }
+    }
+  }
+
+  return ofs.good();
+}
+
+} /* namespace vario */
@@ -0,0 +1,102 @@
+#ifndef HAPLOTYPESTORE_H
+#define HAPLOTYPESTORE_H
+
+#include "VariantStore.hpp"
+#include <seqan/sequence.h>
+#include <seqan/modifier.h>
+#include <seqan/sequence_journaled.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace vario {
+
+/** Haplotype sequences of clone genomes, stored as edits against the reference.
+ *
+ *  Each ChromosomeInstance of a clone is represented by a journaled string
+ *  whose host is the sequence of the reference chromosome. Hosts are shared
+ *  by all haplotypes: SegmentCopies that follow each other in reference order
+ *  refer to the host, only SNVs, deleted regions and SegmentCopies out of
+ *  reference order (e.g. gains) are recorded in the journal.
+ */
+struct HaplotypeStore {
+  typedef seqan::String<char, seqan::Journaled<seqan::Alloc<>, seqan::SortedArray, seqan::Alloc<>>> TJournaledString;
+
+  /** reference chromosome sequences (hosts of journaled strings) */
+  std::map<std::string, std::shared_ptr<seqan::CharString>> map_chr_host;
+  /** haplotypes by clone label and chromosome id (one for each ChromosomeInstance) */
+  std::map<std::string, std::map<std::string, std::vector<std::shared_ptr<TJournaledString>>>> map_clone_chr_hap;
+
+  /** default c'tor */
+  HaplotypeStore();
+
+  /** Build haplotypes of a clone genome from its SegmentCopies and their SNVs.
+   *  \param lbl_clone  Clone label.
+   *  \param genome     Clone genome.
+   *  \param reference  Reference genome (provides host sequences).
+   *  \param var_store  Variants associated to SegmentCopies.
+   *  \returns          true on success, false on error.
+   */
+  bool
+  addClone (
+    const std::string& lbl_clone,
+    const GenomeInstance& genome,
+    const GenomeReference& reference,
+    const VariantStore& var_store
+  );
+
+  /** Release haplotypes of a clone genome (host sequences are kept for other clones).
+   *  \returns true if clone was present, false otherwise.
+   */
+  bool removeClone(const std::string& lbl_clone);
+
+  /** Number of haplotypes (ChromosomeInstances) of a chromosome in a clone genome. */
+  size_t
+  getNumHaplotypes (
+    const std::string& lbl_clone,
+    const std::string& id_chr
+  ) const;
+
+  /** Get part of a haplotype sequence.
+   *  \param lbl_clone  Clone label.
+   *  \param id_chr     Chromosome id.
+   *  \param idx_hap    Index of haplotype (ChromosomeInstance).
+   *  \param start      Start position in haplotype (inclusive).
+   *  \param end        End position in haplotype (exclusive, truncated to haplotype length).
+   *  \param out_seq    Output param: haplotype sequence.
+   *  \returns          true on success, false if haplotype does not exist.
+   */
+  bool
+  getSequence (
+    const std::string& lbl_clone,
+    const std::string& id_chr,
+    const size_t idx_hap,
+    const seqio::TCoord start,
+    const seqio::TCoord end,
+    std::string& out_seq
+  ) const;
+
+  /** Write haplotypes of a clone genome to FASTA file.
+   *  One record per ChromosomeInstance, named <chr>_<idx>.
+   *  \returns true on success, false on error.
+   */
+  bool
+  writeFasta (
+    const std::string& lbl_clone,
+    const std::string& filename,
+    const unsigned line_width = 60
+  ) const;
+
+private:
+  /** Get host sequence for reference chromosome (loaded on first use). */
+  std::shared_ptr<seqan::CharString>
+  getHost (
+    const std::string& id_chr,
+    const GenomeReference& reference
+  );
+};
+
+} /* namespace vario */
+
+#endif /* HAPLOTYPESTORE_H */
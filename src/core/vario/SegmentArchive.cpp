@@ -0,0 +1,289 @@
+#include "SegmentArchive.hpp"
+#include "../seqio/BinaryIO.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+
+using namespace std;
+using seqio::BinaryReader;
+using seqio::BinaryWriter;
+using seqio::TCoord;
+using seqio::TSegId;
+
+namespace vario {
+
+/** Identifies segment archive files. */
+static const char SEG_ARCHIVE_MAGIC[8] = { 'T', 'G', 'S', 'S', 'E', 'G', 'A', 'R' };
+/** Format version of segment archives (increment on layout changes). */
+static const uint32_t SEG_ARCHIVE_VERSION = 2;
+/** Size of archive header: magic, version, reserved, directory offset, directory checksum. */
+static const size_t SEG_ARCHIVE_HEADER_LEN = 8 + 4 + 4 + 8 + 8;
+
+SegmentArchive::SegmentArchive () : pos_blocks(0) {}
+
+bool
+SegmentArchive::write (
+  const string& filename,
+  const map<string, GenomeInstance>& map_clone_genome,
+  const VariantStore& var_store
+)
+{
+  // variant ids are stored once, blocks refer to them by index
+  map<int, uint32_t> map_var_idx;
+  vector<uint64_t> vec_var_offset(1, 0);
+  string var_chars;
+
+  ofstream ofs(filename, ios::out | ios::binary);
+  if (!ofs.good()) {
+    fprintf(stderr, "[ERROR] (SegmentArchive::write) cannot write to file '%s'.\n", filename.c_str());
+    return false;
+  }
+
+  // header (directory offset and checksum are filled in after directory has been written)
+  uint32_t version = SEG_ARCHIVE_VERSION;
+  uint32_t reserved = 0;
+  uint64_t pos_dir = 0;
+  uint64_t checksum = 0;
+  ofs.write(SEG_ARCHIVE_MAGIC, sizeof(SEG_ARCHIVE_MAGIC));
+  ofs.write(reinterpret_cast<const char*>(&version), sizeof(version));
+  ofs.write(reinterpret_cast<const char*>(&reserved), sizeof(reserved));
+  ofs.write(reinterpret_cast<const char*>(&pos_dir), sizeof(pos_dir));
+  ofs.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+
+  // write blocks (one per clone and chromosome) directly to file
+  vector<SegmentArchive::Entry> vec_entry;
+  uint64_t pos_block = 0;
+  for (auto const & lbl_gi : map_clone_genome) {
+    for (auto const & id_ci : lbl_gi.second.map_id_chr) {
+      vector<uint32_t> vec_inst;
+      vector<TSegId> vec_id;
+      vector<TCoord> vec_start, vec_end;
+      vector<uint64_t> vec_seg_var_offset(1, 0);
+      vector<uint32_t> vec_seg_var;
+      for (size_t i = 0; i < id_ci.second.size(); ++i) {
+        for (auto const & seg : id_ci.second[i]->segments) {
+          vec_inst.push_back(i);
+          vec_id.push_back(seg.id);
+          vec_start.push_back(seg.ref_start);
+          vec_end.push_back(seg.ref_end);
+          auto it_seg_vars = var_store.map_seg_vars.find(seg.id);
+          if (it_seg_vars != var_store.map_seg_vars.end()) {
+            for (int id_var : *(it_seg_vars->second)) {
+              auto res = map_var_idx.insert(make_pair(id_var, uint32_t(map_var_idx.size())));
+              if (res.second) {
+                var_chars += var_store.tbl_snv.label(var_store.tbl_snv.getRow(id_var));
+                vec_var_offset.push_back(var_chars.size());
+              }
+              vec_seg_var.push_back(res.first->second);
+            }
+          }
+          vec_seg_var_offset.push_back(vec_seg_var.size());
+        }
+      }
+      // position index: SegmentCopies ordered by start, running maximum of end positions
+      vector<uint32_t> vec_by_start(vec_id.size());
+      iota(vec_by_start.begin(), vec_by_start.end(), 0);
+      stable_sort(vec_by_start.begin(), vec_by_start.end(),
+        [&vec_start](uint32_t a, uint32_t b) { return vec_start[a] < vec_start[b]; });
+      vector<TCoord> vec_max_end(vec_by_start.size());
+      TCoord max_end = 0;
+      for (size_t k = 0; k < vec_by_start.size(); ++k) {
+        max_end = max(max_end, vec_end[vec_by_start[k]]);
+        vec_max_end[k] = max_end;
+      }
+
+      SegmentArchive::Entry entry;
+      entry.lbl_clone = lbl_gi.first;
+      entry.id_chr = id_ci.first;
+      entry.offset = pos_block;
+      BinaryWriter out(ofs);
+      out.writeVec(vec_inst);
+      out.writeVec(vec_id);
+      out.writeVec(vec_start);
+      out.writeVec(vec_end);
+      out.writeVec(vec_by_start);
+      out.writeVec(vec_max_end);
+      out.writeVec(vec_seg_var_offset);
+      out.writeVec(vec_seg_var);
+      entry.len = uint64_t(ofs.tellp()) - SEG_ARCHIVE_HEADER_LEN - entry.offset;
+      pos_block += entry.len;
+      entry.checksum = out.hash;
+      vec_entry.push_back(entry);
+    }
+  }
+
+  // directory (follows blocks)
+  pos_dir = SEG_ARCHIVE_HEADER_LEN + pos_block;
+  BinaryWriter out(ofs);
+  out.writeVec(vec_var_offset);
+  out.writeStr(var_chars);
+  out.write64(vec_entry.size());
+  for (auto const & entry : vec_entry) {
+    out.writeStr(entry.lbl_clone);
+    out.writeStr(entry.id_chr);
+    out.write64(entry.offset);
+    out.write64(entry.len);
+    out.write64(entry.checksum);
+  }
+  uint64_t hash_dir = out.hash;
+
+  ofs.seekp(sizeof(SEG_ARCHIVE_MAGIC) + sizeof(version) + sizeof(reserved));
+  ofs.write(reinterpret_cast<const char*>(&pos_dir), sizeof(pos_dir));
+  ofs.write(reinterpret_cast<const char*>(&hash_dir), sizeof(hash_dir));
+
+  return ofs.good();
+}
+
+bool
+SegmentArchive::open (
+  const string& filename
+)
+{
+  vec_entries.clear();
+  if (!file.open(filename)) {
+    fprintf(stderr, "[ERROR] (SegmentArchive::open) cannot open file '%s'.\n", filename.c_str());
+    return false;
+  }
+  if (file.size < SEG_ARCHIVE_HEADER_LEN || memcmp(file.data, SEG_ARCHIVE_MAGIC, sizeof(SEG_ARCHIVE_MAGIC)) != 0) {
+    fprintf(stderr, "[ERROR] (SegmentArchive::open) '%s' is not a segment archive.\n", filename.c_str());
+    return false;
+  }
+  uint32_t version = 0;
+  uint64_t pos_dir = 0;
+  uint64_t checksum = 0;
+  memcpy(&version, file.data + 8, sizeof(version));
+  memcpy(&pos_dir, file.data + 16, sizeof(pos_dir));
+  memcpy(&checksum, file.data + 24, sizeof(checksum));
+  if (version != SEG_ARCHIVE_VERSION) {
+    fprintf(stderr, "[ERROR] (SegmentArchive::open) unsupported format version (v%u) of '%s'.\n", version, filename.c_str());
+    return false;
+  }
+  if (pos_dir < SEG_ARCHIVE_HEADER_LEN || pos_dir > file.size) {
+    fprintf(stderr, "[ERROR] (SegmentArchive::open) corrupted header in '%s'.\n", filename.c_str());
+    return false;
+  }
+
+  // read directory (located after blocks)
+  BinaryReader in(file.data + pos_dir, file.size - pos_dir);
+  in.readVec(var_offset);
+  var_chars = in.readStr();
+  uint64_t num_entries = in.read64();
+  for (uint64_t i = 0; in.ok && i < num_entries; ++i) {
+    Entry entry;
+    entry.lbl_clone = in.readStr();
+    entry.id_chr = in.readStr();
+    entry.offset = in.read64();
+    entry.len = in.read64();
+    entry.checksum = in.read64();
+    vec_entries.push_back(entry);
+  }
+  bool is_valid = in.ok && var_offset.size() > 0 && var_offset.back() == var_chars.size();
+  if (!is_valid || seqio::hashFnv1a(in.data, in.pos) != checksum) {
+    fprintf(stderr, "[ERROR] (SegmentArchive::open) corrupted directory in '%s'.\n", filename.c_str());
+    vec_entries.clear();
+    return false;
+  }
+  pos_blocks = SEG_ARCHIVE_HEADER_LEN;
+
+  return true;
+}
+
+vector<string>
+SegmentArchive::getCloneLabels () const
+{
+  vector<string> vec_lbl;
+  for (auto const & entry : vec_entries) {
+    if (vec_lbl.empty() || vec_lbl.back() != entry.lbl_clone)
+      vec_lbl.push_back(entry.lbl_clone);
+  }
+  return vec_lbl;
+}
+
+vector<string>
+SegmentArchive::getChromosomeIds (
+  const string& lbl_clone
+) const
+{
+  vector<string> vec_id;
+  for (auto const & entry : vec_entries) {
+    if (entry.lbl_clone == lbl_clone)
+      vec_id.push_back(entry.id_chr);
+  }
+  return vec_id;
+}
+
+bool
+SegmentArchive::getSegments (
+  const string& lbl_clone,
+  const string& id_chr,
+  vector<ArchivedSegment>& out_segments,
+  const TCoord start,
+  const TCoord end
+) const
+{
+  auto it_entry = find_if(vec_entries.begin(), vec_entries.end(),
+    [&lbl_clone, &id_chr](const Entry& e) { return e.lbl_clone == lbl_clone && e.id_chr == id_chr; });
+  if (it_entry == vec_entries.end())
+    return false;
+  if (it_entry->offset + it_entry->len > file.size - pos_blocks) {
+    fprintf(stderr, "[ERROR] (SegmentArchive::getSegments) premature end of file '%s'.\n", file.filename.c_str());
+    return false;
+  }
+  const char* p_block = file.data + pos_blocks + it_entry->offset;
+  if (seqio::hashFnv1a(p_block, it_entry->len) != it_entry->checksum) {
+    fprintf(stderr, "[ERROR] (SegmentArchive::getSegments) checksum mismatch for '%s:%s'.\n", lbl_clone.c_str(), id_chr.c_str());
+    return false;
+  }
+
+  BinaryReader in(p_block, it_entry->len);
+  vector<uint32_t> vec_inst, vec_by_start, vec_seg_var;
+  vector<TSegId> vec_id;
+  vector<TCoord> vec_start, vec_end, vec_max_end;
+  vector<uint64_t> vec_seg_var_offset;
+  in.readVec(vec_inst);
+  in.readVec(vec_id);
+  in.readVec(vec_start);
+  in.readVec(vec_end);
+  in.readVec(vec_by_start);
+  in.readVec(vec_max_end);
+  in.readVec(vec_seg_var_offset);
+  in.readVec(vec_seg_var);
+  size_t num_seg = vec_id.size();
+  bool is_valid = in.ok && vec_inst.size() == num_seg && vec_start.size() == num_seg && vec_end.size() == num_seg;
+  is_valid = is_valid && vec_by_start.size() == num_seg && vec_max_end.size() == num_seg;
+  is_valid = is_valid && vec_seg_var_offset.size() == num_seg+1 && vec_seg_var_offset.back() == vec_seg_var.size();
+  for (uint32_t idx_var : vec_seg_var)
+    is_valid = is_valid && idx_var+1 < var_offset.size();
+  if (!is_valid) {
+    fprintf(stderr, "[ERROR] (SegmentArchive::getSegments) corrupted block for '%s:%s'.\n", lbl_clone.c_str(), id_chr.c_str());
+    return false;
+  }
+
+  // SegmentCopies overlapping [start, end): start before end, running max of ends beyond start
+  auto it_lo = upper_bound(vec_max_end.begin(), vec_max_end.end(), start);
+  size_t k_lo = it_lo - vec_max_end.begin();
+  vector<uint32_t> vec_idx;
+  for (size_t k = k_lo; k < vec_by_start.size() && vec_start[vec_by_start[k]] < end; ++k) {
+    if (vec_end[vec_by_start[k]] > start)
+      vec_idx.push_back(vec_by_start[k]);
+  }
+  sort(vec_idx.begin(), vec_idx.end());
+
+  for (uint32_t i : vec_idx) {
+    ArchivedSegment seg;
+    seg.idx_chr_inst = vec_inst[i];
+    seg.id = vec_id[i];
+    seg.ref_start = vec_start[i];
+    seg.ref_end = vec_end[i];
+    for (uint64_t j = vec_seg_var_offset[i]; j < vec_seg_var_offset[i+1]; ++j) {
+      uint32_t idx_var = vec_seg_var[j];
+      seg.vec_var_ids.push_back(var_chars.substr(var_offset[idx_var], var_offset[idx_var+1] - var_offset[idx_var]));
+    }
+    out_segments.push_back(seg);
+  }
+
+  return true;
+}
+
+} /* namespace vario */
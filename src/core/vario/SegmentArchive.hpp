@@ -0,0 +1,101 @@
+#ifndef SEGMENTARCHIVE_H
+#define SEGMENTARCHIVE_H
+
+#include "VariantStore.hpp"
+#include "../seqio/MappedFile.hpp"
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace vario {
+
+/** SegmentCopy of a clone genome as stored in a SegmentArchive. */
+struct ArchivedSegment {
+  /** index of ChromosomeInstance (among copies of the same chromosome) */
+  uint32_t idx_chr_inst;
+  /** SegmentCopy id */
+  seqio::TSegId id;
+  /** reference interval [ref_start, ref_end) */
+  seqio::TCoord ref_start, ref_end;
+  /** ids of variants carried by SegmentCopy */
+  std::vector<std::string> vec_var_ids;
+};
+
+/** Binary archive of clone genome layouts (SegmentCopies) and their variants.
+ *
+ *  The archive consists of a header, one block per clone and chromosome and
+ *  a directory (written last, its offset is stored in the header). Each
+ *  block holds the SegmentCopies of all ChromosomeInstances (in physical
+ *  order), an index by reference position and the variants associated to
+ *  each SegmentCopy. Opening an archive only reads the
+ *  directory, blocks are loaded (and checked) on request.
+ */
+struct SegmentArchive {
+  /** Directory entry: location of block for clone and chromosome. */
+  struct Entry {
+    std::string lbl_clone;
+    std::string id_chr;
+    uint64_t offset;
+    uint64_t len;
+    uint64_t checksum;
+  };
+
+  /** mapped archive file */
+  seqio::MappedFile file;
+  /** directory (ordered by clone, then chromosome) */
+  std::vector<Entry> vec_entries;
+  /** start of blocks in archive file */
+  uint64_t pos_blocks;
+  /** variant ids, var_chars[var_offset[i], var_offset[i+1]) */
+  std::vector<uint64_t> var_offset;
+  std::string var_chars;
+
+  /** default c'tor */
+  SegmentArchive();
+
+  /** Write SegmentCopies and associated variants of clone genomes to archive file.
+   *  \param filename          Output file name.
+   *  \param map_clone_genome  GenomeInstances by clone label.
+   *  \param var_store         Variants associated to SegmentCopies.
+   *  \returns                 true on success, false on error.
+   */
+  static bool
+  write (
+    const std::string& filename,
+    const std::map<std::string, GenomeInstance>& map_clone_genome,
+    const VariantStore& var_store
+  );
+
+  /** Open archive file (reads directory).
+   *  \returns true on success, false on error.
+   */
+  bool open(const std::string& filename);
+
+  /** Labels of archived clones (in archive order). */
+  std::vector<std::string> getCloneLabels() const;
+
+  /** Chromosomes archived for a clone (in archive order). */
+  std::vector<std::string> getChromosomeIds(const std::string& lbl_clone) const;
+
+  /** Load SegmentCopies of a clone's chromosome overlapping a reference interval.
+   *  \param lbl_clone     Clone label.
+   *  \param id_chr        Chromosome id.
+   *  \param out_segments  Output param: SegmentCopies (in physical order).
+   *  \param start         Reference start position (inclusive).
+   *  \param end           Reference end position (exclusive).
+   *  \returns             true on success, false if not archived or corrupted.
+   */
+  bool
+  getSegments (
+    const std::string& lbl_clone,
+    const std::string& id_chr,
+    std::vector<ArchivedSegment>& out_segments,
+    const seqio::TCoord start = 0,
+    const seqio::TCoord end = std::numeric_limits<seqio::TCoord>::max()
+  ) const;
+};
+
+} /* namespace vario */
+
+#endif /* SEGMENTARCHIVE_H */
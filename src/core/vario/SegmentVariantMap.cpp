@@ -0,0 +1,123 @@
+#include "SegmentVariantMap.hpp"
+#include <cassert>
+#include <limits>
+#include <stdexcept>
+
+using namespace std;
+using seqio::TSegId;
+
+namespace vario {
+
+const TSegId SegmentVariantMap::EMPTY_KEY = numeric_limits<TSegId>::max();
+
+/** Initial number of slots. */
+static const size_t SEG_VAR_MAP_MIN_SLOTS = 16;
+
+SegmentVariantMap::SegmentVariantMap () : num_entries(0) {}
+
+void
+SegmentVariantMap::clear ()
+{
+  vec_slots.clear();
+  num_entries = 0;
+}
+
+size_t
+SegmentVariantMap::hashSlot (
+  const TSegId id_seg
+) const
+{
+  // Fibonacci hashing: consecutive ids are spread over the table
+  uint64_t h = id_seg * 0x9E3779B97F4A7C15ULL;
+  return (h ^ (h >> 32)) & (vec_slots.size() - 1);
+}
+
+size_t
+SegmentVariantMap::findSlot (
+  const TSegId id_seg
+) const
+{
+  if (vec_slots.empty())
+    return 0;
+  size_t mask = vec_slots.size() - 1;
+  for (size_t i = hashSlot(id_seg); ; i = (i+1) & mask) {
+    if (vec_slots[i].first == id_seg)
+      return i;
+    if (vec_slots[i].first == EMPTY_KEY)
+      return vec_slots.size();
+  }
+}
+
+SegmentVariantMap::iterator
+SegmentVariantMap::find (
+  const TSegId id_seg
+)
+{
+  size_t i = findSlot(id_seg);
+  return iterator(slotData() + i, slotData() + vec_slots.size());
+}
+
+SegmentVariantMap::const_iterator
+SegmentVariantMap::find (
+  const TSegId id_seg
+) const
+{
+  size_t i = findSlot(id_seg);
+  return const_iterator(slotData() + i, slotData() + vec_slots.size());
+}
+
+const shared_ptr<SegmentVariantMap::TVarList>&
+SegmentVariantMap::at (
+  const TSegId id_seg
+) const
+{
+  size_t i = findSlot(id_seg);
+  if (i == vec_slots.size())
+    throw out_of_range("SegmentVariantMap::at");
+  return vec_slots[i].second;
+}
+
+shared_ptr<SegmentVariantMap::TVarList>&
+SegmentVariantMap::operator[] (
+  const TSegId id_seg
+)
+{
+  assert( id_seg != EMPTY_KEY );
+  // existing entries are returned without modifying the table
+  size_t i = findSlot(id_seg);
+  if (i < vec_slots.size())
+    return vec_slots[i].second;
+
+  // keep load factor at or below 1/2
+  if (2*(num_entries+1) > vec_slots.size())
+    this->rehash(max(SEG_VAR_MAP_MIN_SLOTS, 2*vec_slots.size()));
+
+  size_t mask = vec_slots.size() - 1;
+  i = hashSlot(id_seg);
+  while (vec_slots[i].first != EMPTY_KEY)
+    i = (i+1) & mask;
+  vec_slots[i].first = id_seg;
+  ++num_entries;
+  return vec_slots[i].second;
+}
+
+void
+SegmentVariantMap::rehash (
+  const size_t num_slots
+)
+{
+  vector<value_type> vec_old(num_slots, value_type(EMPTY_KEY, nullptr));
+  vec_old.swap(vec_slots);
+  size_t mask = num_slots - 1;
+  for (auto & slot : vec_old) {
+    if (slot.first == EMPTY_KEY)
+      continue;
+    size_t i = hashSlot(slot.first);
+    while (vec_slots[i].first != EMPTY_KEY)
+      i = (i+1) & mask;
+    vec_slots[i].first = slot.first;
+    vec_slots[i].second = move(slot.second);
+  }
+}
+
+} /* namespace vario */
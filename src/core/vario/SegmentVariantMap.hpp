@@ -0,0 +1,84 @@
+#ifndef SEGMENTVARIANTMAP_H
+#define SEGMENTVARIANTMAP_H
+
+#include "../seqio/types.hpp"
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace vario {
+
+/** Hash map from SegmentCopy ids to the variants they carry.
+ *
+ *  Uses open addressing (linear probing) over a power-of-two table, so
+ *  lookups touch a single contiguous array. Variant lists hold SNV ids
+ *  sorted by position (then id) and may be shared by several SegmentCopies.
+ *  The interface follows std::map where used (find, count, at, operator[]),
+ *  entries cannot be removed.
+ */
+struct SegmentVariantMap
+{
+  typedef std::vector<int> TVarList;
+  typedef std::pair<seqio::TSegId, std::shared_ptr<TVarList>> value_type;
+  /** marks empty slots (never assigned as SegmentCopy id) */
+  static const seqio::TSegId EMPTY_KEY;
+
+  /** Iterates over occupied slots. */
+  template <typename TValue>
+  struct SlotIterator : public std::iterator<std::forward_iterator_tag, TValue>
+  {
+    TValue* p;
+    TValue* p_end;
+    SlotIterator(TValue* p, TValue* p_end) : p(p), p_end(p_end) { skipEmpty(); }
+    void skipEmpty() { while (p != p_end && p->first == EMPTY_KEY) ++p; }
+    TValue& operator*() const { return *p; }
+    TValue* operator->() const { return p; }
+    SlotIterator& operator++() { ++p; skipEmpty(); return *this; }
+    bool operator==(const SlotIterator& rhs) const { return p == rhs.p; }
+    bool operator!=(const SlotIterator& rhs) const { return p != rhs.p; }
+  };
+  typedef SlotIterator<value_type> iterator;
+  typedef SlotIterator<const value_type> const_iterator;
+
+  /** hash table (size is a power of two) */
+  std::vector<value_type> vec_slots;
+  /** number of occupied slots */
+  size_t num_entries;
+
+  /** default c'tor */
+  SegmentVariantMap();
+
+  size_t size() const { return num_entries; }
+  bool empty() const { return num_entries == 0; }
+  void clear();
+
+  iterator begin() { return iterator(slotData(), slotData() + vec_slots.size()); }
+  iterator end() { return iterator(slotData() + vec_slots.size(), slotData() + vec_slots.size()); }
+  const_iterator begin() const { return const_iterator(slotData(), slotData() + vec_slots.size()); }
+  const_iterator end() const { return const_iterator(slotData() + vec_slots.size(), slotData() + vec_slots.size()); }
+
+  iterator find(const seqio::TSegId id_seg);
+  const_iterator find(const seqio::TSegId id_seg) const;
+  size_t count(const seqio::TSegId id_seg) const { return findSlot(id_seg) < vec_slots.size() ? 1 : 0; }
+  /** Get variant list of SegmentCopy (throws std::out_of_range if there is none). */
+  const std::shared_ptr<TVarList>& at(const seqio::TSegId id_seg) const;
+  /** Get variant list of SegmentCopy (inserts empty pointer if there is none).
+   *  Only insertions may rehash (invalidating references to other entries).
+   */
+  std::shared_ptr<TVarList>& operator[](const seqio::TSegId id_seg);
+
+private:
+  value_type* slotData() { return vec_slots.empty() ? nullptr : &vec_slots[0]; }
+  const value_type* slotData() const { return vec_slots.empty() ? nullptr : &vec_slots[0]; }
+  /** Home slot of key. */
+  size_t hashSlot(const seqio::TSegId id_seg) const;
+  /** Slot holding key (vec_slots.size() if not present). */
+  size_t findSlot(const seqio::TSegId id_seg) const;
+  /** Move entries to a table of given size (power of two). */
+  void rehash(const size_t num_slots);
+};
+
+} /* namespace vario */
+
+#endif /* SEGMENTVARIANTMAP_H */
@@ -1,33 +1,113 @@
 #include "VariantStore.hpp"
 #include <boost/container/flat_set.hpp>
+#include <algorithm>
+#include <limits>
+#include <set>
 using namespace std;
-using boost::uuids::uuid;
 using seqio::ChromosomeInstance;
 using seqio::Locus;
+using seqio::SegmentCopy;
+using seqio::SegmentIdAllocator;
+using seqio::SegmentIndex;
 using seqio::TCoord;
+using seqio::TSegId;
 
 namespace vario {
 
-unsigned
-VariantStore::indexSnvs () 
+/**
+ * Set chromosome and local position of SNVs from their global positions.
+ * Loci are resolved in a single sweep over sorted positions.
+ *
+ * \param vec_pos_id   global positions and ids of SNVs (sorted in place)
+ * \param genome       reference genome
+ * \param tbl_snv      SNVs to update
+ */
+static void
+resolveSnvLoci (
+  vector<pair<TCoord, int>>& vec_pos_id,
+  const GenomeReference& genome,
+  VariantTable& tbl_snv
+)
 {
-  unsigned num_snvs = 0;
-  this->map_chr_pos_snvs.clear();
-
-  for (auto const & id_var : this->map_id_snv) {
-
-    int id = id_var.first;
-    Variant var = id_var.second;
+  sort(vec_pos_id.begin(), vec_pos_id.end());
+  vector<TCoord> vec_pos(vec_pos_id.size());
+  for (size_t i = 0; i < vec_pos_id.size(); ++i)
+    vec_pos[i] = vec_pos_id[i].first;
+  vector<Locus> vec_loc;
+  genome.getLociByGlobalPos(vec_pos, vec_loc);
+  for (size_t i = 0; i < vec_pos_id.size(); ++i)
+    tbl_snv.setLocus(tbl_snv.getRow(vec_pos_id[i].second), vec_loc[i].id_ref, vec_loc[i].start);
+}
 
-    // if necessary, initialize pos->var map for chromosome
-    if (this->map_chr_pos_snvs.find(var.chr) == this->map_chr_pos_snvs.end())
-      this->map_chr_pos_snvs[var.chr] = map<TCoord, vector<int>>();
+/** Interval index of loci not covered by any SegmentCopy. */
+static const size_t NO_INTERVAL = numeric_limits<size_t>::max();
+
+/**
+ * Index the SegmentCopies of a chromosome by reference position.
+ * Index entries refer to SegmentCopies by their rank (over all ChromosomeInstances,
+ * in physical order), so candidates for a locus are enumerated in the same order
+ * as by GenomeInstance::getSegmentCopiesAt().
+ *
+ * \param genome       GenomeInstance
+ * \param id_chr       chromosome id
+ * \param out_index    Output param: index of SegmentCopy ranks
+ * \param out_vec_seg  Output param: SegmentCopies by rank
+ */
+static void
+indexChromosomeSegments (
+  const GenomeInstance& genome,
+  const string& id_chr,
+  SegmentIndex& out_index,
+  vector<SegmentCopy>& out_vec_seg
+)
+{
+  out_vec_seg.clear();
+  auto it_chr = genome.map_id_chr.find(id_chr);
+  if (it_chr != genome.map_id_chr.end()) {
+    for (auto const & sp_chr : it_chr->second)
+      out_vec_seg.insert(out_vec_seg.end(), sp_chr->segments.begin(), sp_chr->segments.end());
+  }
+  vector<SegmentCopy> vec_rank(out_vec_seg.size());
+  for (size_t k = 0; k < out_vec_seg.size(); ++k) {
+    const SegmentCopy& seg = out_vec_seg[k];
+    vec_rank[k] = SegmentCopy(k, seg.ref_start, seg.ref_end, seg.gl_allele);
+  }
+  out_index.build(vec_rank);
+}
 
-    this->map_chr_pos_snvs[var.chr][var.pos].push_back(var.idx_mutation);
-    num_snvs++;
+/**
+ * Locate loci in the elementary intervals of a SegmentIndex.
+ * Loci are sorted and merged with the interval boundaries in a single sweep.
+ *
+ * \param index         SegmentIndex
+ * \param vec_loci      reference positions and (output) slots of loci (sorted in place)
+ * \param out_vec_itvl  Output param: interval index for each slot (NO_INTERVAL if not covered)
+ */
+static void
+locateLoci (
+  const SegmentIndex& index,
+  vector<pair<TCoord, size_t>>& vec_loci,
+  vector<size_t>& out_vec_itvl
+)
+{
+  sort(vec_loci.begin(), vec_loci.end());
+  size_t num_itvl = index.numIntervals();
+  size_t i = 0;
+  for (auto const & locus : vec_loci) {
+    TCoord pos = locus.first;
+    if (num_itvl == 0 || pos < index.m_bkp.front() || pos >= index.m_bkp.back())
+      continue;
+    while (index.m_bkp[i+1] <= pos)
+      ++i;
+    if (index.m_offset[i+1] > index.m_offset[i])
+      out_vec_itvl[locus.second] = i;
   }
+}
 
-  return num_snvs;
+unsigned
+VariantStore::indexSnvs () 
+{
+  return this->tbl_snv.indexPositions();
 }
 
 bool
@@ -42,56 +122,70 @@ VariantStore::generateGermlineVariants (
   // NOTE: germline variants carry negative indices
   int id_next = -1 * num_variants;
   //vector<Variant> variants = vector<Variant>(num_variants);
-  boost::container::flat_set<int> var_pos; // keep track of variant positions
+  boost::container::flat_set<TCoord> var_pos; // keep track of variant positions
   function<double()> random_float = rng.getRandomFunctionReal(0.0, 1.0);
   function<short()> random_copy = rng.getRandomFunctionInt(short(0), short(genome.ploidy-1));
   random_selector<> selector(rng.generator); // used to pick random vector indices
+  vector<pair<TCoord, int>> vec_pos_id; // global variant positions (resolved at the end)
 
   // determine base mutation probs from model (row sums)
+  // (nucleotides absent from the reference cannot be mutated)
   vector<double> p_i(4, 0);
+  double p_tot = 0.0;
   for (int i=0; i<4; ++i) {
     for (int j=0; j<4; ++j) {
       p_i[i] += model.Q[i][j];
     }
+    if (p_i[i] > 0 && genome.countNuc(i) == 0) {
+      fprintf(stderr, "[WARN] (VariantStore::generateGermlineVariants) nucleotide '%c' not found in reference, will not be mutated.\n", seqio::idx2nuc(i));
+      p_i[i] = 0.0;
+    }
+    p_tot += p_i[i];
+  }
+  if (num_variants > 0 && p_tot == 0.0) {
+    fprintf(stderr, "[ERROR] (VariantStore::generateGermlineVariants) no mutable sites in reference.\n");
+    return false;
   }
   function<int()> random_nuc_idx = rng.getRandomIndexWeighted(p_i);
 
-  unsigned long genome_len = genome.length; // haploid genome length
+  TCoord genome_len = genome.length; // haploid genome length
   for (int i=0; i<num_variants; ++i) {
     // pick random nucleotide bucket
     int idx_bucket = random_nuc_idx();
     // pick random position
-    long nuc_pos = selector(genome.nuc_pos[idx_bucket]);
+    TCoord num_pos = genome.countNuc(idx_bucket);
+    TCoord nuc_pos = genome.getNucPos(idx_bucket, selector.index(num_pos));
     if (inf_sites) {
       while (binary_search(var_pos.begin(), var_pos.end(), nuc_pos)) {
 // TODO: check verbosity setting
-fprintf(stderr, "[INFO] Infinite sites assumption: locus %ld has been mutated before, picking another one...\n", nuc_pos);
-        nuc_pos = selector(genome.nuc_pos[idx_bucket]);
+fprintf(stderr, "[INFO] Infinite sites assumption: locus %lu has been mutated before, picking another one...\n", nuc_pos);
+        nuc_pos = genome.getNucPos(idx_bucket, selector.index(num_pos));
       }
       var_pos.insert(nuc_pos);
     }
-    Locus loc = genome.getLocusByGlobalPos(nuc_pos);
+    vec_pos_id.push_back(make_pair(nuc_pos, id_next));
     // pick new nucleotide
     short nuc_alt = evolution::MutateSite(idx_bucket, random_float, model);
     Variant var;
     var.id = stringio::format("g%d", i);
     var.is_somatic = false;
     var.is_het = ( random_float() > rate_hom );
-    var.chr = loc.id_ref;
     //var.chr_copy = random_copy(); // TODO: deprecated!
     //var.rel_pos = double(nuc_pos-(var.chr_copy*genome_len))/genome_len;
     var.rel_pos = double(nuc_pos)/genome_len;
     //var.reg_copy = 0; // TODO: deprecated!
-    var.pos = loc.start;
     var.alleles.push_back(string(1, seqio::idx2nuc(idx_bucket)));
     var.alleles.push_back(string(1, seqio::idx2nuc(nuc_alt)));
     var.idx_mutation = id_next;
 
-    this->map_id_snv[id_next] = var;
+    this->tbl_snv.add(id_next, var);
     id_next++;
     // variants[i] = var;
   }
 
+  // set chromosome and local position of variants
+  resolveSnvLoci(vec_pos_id, genome, this->tbl_snv);
+
   // sanity check: correct number of variants?
   assert ( id_next == 0 );
   return true;
@@ -111,13 +205,31 @@ VariantStore::generateSomaticVariants(
   //------------
   vector<Variant> variants;
   // keep track of variant positions (ISM)
-  boost::container::flat_set<int> var_pos;
+  boost::container::flat_set<TCoord> var_pos;
   // random function, returns substitution index
-  function<int()> r_idx_sub = rng.getRandomIndexWeighted(model_snv.m_weight);
+  // (tri-nucleotides absent from the reference cannot be mutated)
+  vector<double> vec_sub_weight = model_snv.m_weight;
+  double w_tot = 0.0;
+  set<string> set_site_missing;
+  for (size_t i = 0; i < vec_sub_weight.size(); ++i) {
+    if (vec_sub_weight[i] > 0 && genome.countTrinuc(model_snv.m_site[i]) == 0) {
+      if (set_site_missing.insert(model_snv.m_site[i]).second)
+        fprintf(stderr, "[WARN] (VariantStore::generateSomaticVariants) context '%s' not found in reference, will not be mutated.\n", model_snv.m_site[i].c_str());
+      vec_sub_weight[i] = 0.0;
+    }
+    w_tot += vec_sub_weight[i];
+  }
+  bool has_snv = any_of(vec_mutations.begin(), vec_mutations.end(), [](const Mutation& m) { return m.is_snv; });
+  if (has_snv && w_tot == 0.0) {
+    fprintf(stderr, "[ERROR] (VariantStore::generateSomaticVariants) no mutable sites in reference.\n");
+    return false;
+  }
+  function<int()> r_idx_sub = rng.getRandomIndexWeighted(vec_sub_weight);
   // TODO: deprecated!
   function<short()> random_copy = rng.getRandomFunctionInt(short(0), short(1)); // was genome.ploidy-1
   random_selector<> selector(rng.generator); // used to pick random vector indices
-  unsigned long genome_len = genome.length; // haploid genome length
+  TCoord genome_len = genome.length; // haploid genome length
+  vector<pair<TCoord, int>> vec_pos_id; // global SNV positions (resolved at the end)
   //------------
 
   // CNV events
@@ -145,29 +257,28 @@ VariantStore::generateSomaticVariants(
       string alt_nuc = model_snv.m_alt[i_sub];
       string ref_nuc = ref_site.substr(1, 1);
       // pick random position (+1 b/c second nucleotide in 3-mer is mutated)
-      long nuc_pos = selector(genome.map_3mer_pos.at(ref_site)) + 1;
+      TCoord num_pos = genome.countTrinuc(ref_site);
+      TCoord nuc_pos = genome.getTrinucPos(ref_site, selector.index(num_pos)) + 1;
       if (inf_sites) {
         while (binary_search(var_pos.begin(), var_pos.end(), nuc_pos)) {
           // TODO: check verbosity setting
-          fprintf(stderr, "[INFO] Infinite sites model: locus %ld has been mutated before, picking another one...\n", nuc_pos);
-          nuc_pos = selector(genome.map_3mer_pos.at(ref_site)) + 1;
+          fprintf(stderr, "[INFO] Infinite sites model: locus %lu has been mutated before, picking another one...\n", nuc_pos);
+          nuc_pos = genome.getTrinucPos(ref_site, selector.index(num_pos)) + 1;
         }
         var_pos.insert(nuc_pos);
       }
-      Locus loc = genome.getLocusByGlobalPos(nuc_pos);
+      vec_pos_id.push_back(make_pair(nuc_pos, m.id));
       // TODO: identify available segment copies in GenomeInstance, choose one
 
       // init new Variant
       Variant var;
       var.id = stringio::format("s%d", m.id);
-      var.chr = loc.id_ref;
       var.rel_pos = double(nuc_pos)/genome_len;
-      var.pos = loc.start;
       var.alleles.push_back(ref_nuc);
       var.alleles.push_back(alt_nuc);
       var.idx_mutation = m.id;
       var.is_somatic = true;
-      this->map_id_snv[m.id] = var;
+      this->tbl_snv.add(m.id, var);
     }
     else { // CNV event
       CopyNumberVariant cnv;
@@ -222,6 +333,9 @@ VariantStore::generateSomaticVariants(
     }
   }
 
+  // set chromosome and local position of SNVs
+  resolveSnvLoci(vec_pos_id, genome, this->tbl_snv);
+
   // index SNVs by chromosome and ref position
   this->indexSnvs();
 
@@ -236,163 +350,433 @@ VariantStore::applyGermlineVariants (
 {
   random_selector<> selector(rng.generator); // used to pick random SegmentCopy
 
-  // loop over variants
-  for (auto const & id_snv : map_id_snv) {
-    int id = id_snv.first;
-    Variant var = id_snv.second;
-
-    // skip somatic variants
-    if (var.is_somatic) continue;
-
-    // get available SegmentCopies from genome
-    string id_chr = var.chr;
-    TCoord ref_pos = var.pos;
-    vector<SegmentCopy> vec_seg_avail = genome.getSegmentCopiesAt(id_chr, ref_pos);
+  // collect loci of germline variants by chromosome
+  vector<int> vec_id;
+  map<string, vector<pair<TCoord, size_t>>> map_chr_loci;
+  for (int id : tbl_snv.getIds()) {
+    VariantTable::TRow row = tbl_snv.getRow(id);
+    if (tbl_snv.isSomatic(row)) continue;
+    map_chr_loci[tbl_snv.chr(row)].push_back(make_pair(tbl_snv.pos(row), vec_id.size()));
+    vec_id.push_back(id);
+  }
+  vector<string> vec_chr;
+  for (auto const & chr_loci : map_chr_loci)
+    vec_chr.push_back(chr_loci.first);
+
+  // locate variants among SegmentCopies (one sweep per chromosome)
+  vector<SegmentIndex> vec_index(vec_chr.size());
+  vector<vector<SegmentCopy>> vec_chr_seg(vec_chr.size());
+  vector<size_t> vec_itvl(vec_id.size(), NO_INTERVAL);
+  vector<size_t> vec_idx_chr(vec_id.size());
+  #pragma omp parallel for schedule(dynamic)
+  for (size_t i = 0; i < vec_chr.size(); ++i) {
+    vector<pair<TCoord, size_t>>& vec_loci = map_chr_loci.at(vec_chr[i]);
+    indexChromosomeSegments(genome, vec_chr[i], vec_index[i], vec_chr_seg[i]);
+    locateLoci(vec_index[i], vec_loci, vec_itvl);
+    for (auto const & locus : vec_loci)
+      vec_idx_chr[locus.second] = i;
+  }
 
-    // SegmentCopies that will carry the variant
-    vector<SegmentCopy> vec_seg_mut;
+  // pick SegmentCopies (in order of variant ids)
+  vector<TSegVarAdd> vec_var_add;
+  for (size_t k = 0; k < vec_id.size(); ++k) {
+    int id = vec_id[k];
+    VariantTable::TRow row = tbl_snv.getRow(id);
+    if (vec_itvl[k] == NO_INTERVAL) {
+      fprintf(stderr, "[WARN] (VariantStore::applyGermlineVariants) variant '%s' masked (no locus '%s:%lu').\n", tbl_snv.label(row).c_str(), tbl_snv.chr(row).c_str(), tbl_snv.pos(row));
+      continue;
+    }
+    const SegmentIndex& index = vec_index[vec_idx_chr[k]];
+    const vector<SegmentCopy>& vec_seg = vec_chr_seg[vec_idx_chr[k]];
+    const TSegId* p_first = index.m_ids.data() + index.m_offset[vec_itvl[k]];
+    const TSegId* p_last = index.m_ids.data() + index.m_offset[vec_itvl[k]+1];
     // homozygous variants are introduced into all SegmentCopies, heterozygous ones into random one
-    if ( var.is_het ) {
-      // pick random SegmentCopy to mutate
-      vec_seg_mut.push_back( selector(vec_seg_avail) );
+    if ( tbl_snv.isHet(row) ) {
+      vec_var_add.push_back(make_tuple(0, vec_seg[*selector(p_first, p_last)].id, id));
     } else {
-      // mark all SegmentCopies for mutation
-      vec_seg_mut = vec_seg_avail;
-    }
-    
-    // initialize or append to Variant vector of segment copies
-    for ( SegmentCopy sc : vec_seg_mut ) {
-      if ( map_seg_vars.count(sc.id) == 0 ) {
-        map_seg_vars[sc.id] = { id };
-      } else {
-        map_seg_vars[sc.id].push_back(id);
-      }
+      for (const TSegId* p = p_first; p != p_last; ++p)
+        vec_var_add.push_back(make_tuple(0, vec_seg[*p].id, id));
     }
   }
+  this->updateSegmentVariants(vector<seqio::seg_mod_t>(), vec_var_add);
 
   return true;
 }
 
-void 
+void
 VariantStore::applyMutation (
   Mutation mut,
   GenomeInstance& genome,
   RandomNumberGenerator& rng
 )
+{
+  vector<seqio::seg_mod_t> vec_seg_mod;
+  vector<TSegVarAdd> vec_var_add;
+  this->planMutation(mut, genome, rng, vec_seg_mod, vec_var_add);
+  this->updateSegmentVariants(vec_seg_mod, vec_var_add);
+}
+
+void
+VariantStore::applyMutations (
+  const vector<Mutation>& vec_mut,
+  GenomeInstance& genome,
+  RandomNumberGenerator& rng
+)
+{
+  // record changes to SegmentCopies for all mutations, then update variant lists in one batch
+  vector<seqio::seg_mod_t> vec_seg_mod;
+  vector<TSegVarAdd> vec_var_add;
+  auto it_mut = vec_mut.begin();
+  while (it_mut != vec_mut.end()) {
+    if (it_mut->is_snv) {
+      // consecutive SNVs do not change genome structure, locate them in one go
+      auto it_run_end = find_if(it_mut, vec_mut.end(), [](const Mutation& m) { return !m.is_snv; });
+      this->planSnvMutations(it_mut, it_run_end, genome, rng, vec_seg_mod, vec_var_add);
+      it_mut = it_run_end;
+    } else {
+      this->planMutation(*it_mut, genome, rng, vec_seg_mod, vec_var_add);
+      ++it_mut;
+    }
+  }
+  this->updateSegmentVariants(vec_seg_mod, vec_var_add);
+}
+
+void
+VariantStore::planSnvMutations (
+  vector<Mutation>::const_iterator it_first,
+  vector<Mutation>::const_iterator it_last,
+  GenomeInstance& genome,
+  RandomNumberGenerator& rng,
+  vector<seqio::seg_mod_t>& out_vec_seg_mod,
+  vector<TSegVarAdd>& out_vec_var_add
+) const
+{
+  // loci of SNVs by chromosome
+  size_t num_snv = distance(it_first, it_last);
+  map<string, vector<pair<TCoord, size_t>>> map_chr_loci;
+  for (size_t k = 0; k < num_snv; ++k) {
+    const Mutation& mut = *(it_first + k);
+    assert( mut.is_snv && this->tbl_snv.count(mut.id)>0 );
+    VariantTable::TRow row = this->tbl_snv.getRow(mut.id);
+    map_chr_loci[tbl_snv.chr(row)].push_back(make_pair(tbl_snv.pos(row), k));
+  }
+
+  // locate SNVs among SegmentCopies (one sweep per chromosome)
+  map<string, SegmentIndex> map_chr_index;
+  map<string, vector<SegmentCopy>> map_chr_seg;
+  vector<size_t> vec_itvl(num_snv, NO_INTERVAL);
+  for (auto & chr_loci : map_chr_loci) {
+    indexChromosomeSegments(genome, chr_loci.first, map_chr_index[chr_loci.first], map_chr_seg[chr_loci.first]);
+    locateLoci(map_chr_index[chr_loci.first], chr_loci.second, vec_itvl);
+  }
+
+  // pick SegmentCopies in order of mutations (cf. planMutation())
+  for (size_t k = 0; k < num_snv; ++k) {
+    const Mutation& mut = *(it_first + k);
+    VariantTable::TRow row = this->tbl_snv.getRow(mut.id);
+    const string& id_chr = tbl_snv.chr(row);
+    if (vec_itvl[k] == NO_INTERVAL) {
+      fprintf(stderr, "[INFO] (VariantStore::applyMutation) SNV '%d' masked (no locus '%s:%lu').\n", mut.id, id_chr.c_str(), tbl_snv.pos(row));
+      continue;
+    }
+    const SegmentIndex& index = map_chr_index.at(id_chr);
+    // pick random SegmentCopy (each pick advances rng)
+    size_t num_seg = index.m_offset[vec_itvl[k]+1] - index.m_offset[vec_itvl[k]];
+    TSegId rank = index.m_ids[index.m_offset[vec_itvl[k]] + rng.getRandomIndex(num_seg)];
+    SegmentCopy& sc = map_chr_seg.at(id_chr)[rank];
+    // SegmentCopy may be shared with ancestral genomes, make sure it is private
+    // (later SNVs in the same SegmentCopy refer to the private copy)
+    sc.id = genome.unshareSegmentCopy(id_chr, sc, out_vec_seg_mod);
+    // initialize or append to Variant vector of SegmentCopy (after preceding transfers)
+    out_vec_var_add.push_back(make_tuple(out_vec_seg_mod.size(), sc.id, mut.id));
+  }
+}
+
+void
+VariantStore::planMutation (
+  const Mutation& mut,
+  GenomeInstance& genome,
+  RandomNumberGenerator& rng,
+  vector<seqio::seg_mod_t>& out_vec_seg_mod,
+  vector<TSegVarAdd>& out_vec_var_add
+) const
 {
   // perform some sanity checks
   assert( mut.is_snv != mut.is_cnv );
-  assert( !mut.is_snv || this->map_id_snv.count(mut.id)>0 );
+  assert( !mut.is_snv || this->tbl_snv.count(mut.id)>0 );
   assert( !mut.is_cnv || this->map_id_cnv.count(mut.id)>0 );
 
-  random_selector<> selector(rng.generator); // used to pick random SegmentCopy
-
   if ( mut.is_snv ) { // SNV mutation
-    Variant snv = this->map_id_snv[mut.id];
+    VariantTable::TRow row = this->tbl_snv.getRow(mut.id);
+    const string& id_chr = tbl_snv.chr(row);
     // get available SegmentCopies
-    vector<SegmentCopy> seg_targets = genome.getSegmentCopiesAt(snv.chr, snv.pos);
+    vector<SegmentCopy> seg_targets = genome.getSegmentCopiesAt(id_chr, tbl_snv.pos(row));
     if ( seg_targets.size() == 0 ) {
-      fprintf(stderr, "[INFO] (VariantStore::applyMutation) SNV '%d' masked (no locus '%s:%lu').\n", mut.id, snv.chr.c_str(), snv.pos);
+      fprintf(stderr, "[INFO] (VariantStore::applyMutation) SNV '%d' masked (no locus '%s:%lu').\n", mut.id, id_chr.c_str(), tbl_snv.pos(row));
       return;
     }
-    SegmentCopy sc = selector(seg_targets);
-    // initialize or append to Variant vector of SegmentCopy
-    if ( map_seg_vars.count(sc.id) == 0 ) {
-      map_seg_vars[sc.id] = { mut.id };
-    } else {
-      map_seg_vars[sc.id].push_back(mut.id);
-    }
+    // pick random SegmentCopy (each pick advances rng)
+    SegmentCopy sc = seg_targets[rng.getRandomIndex(seg_targets.size())];
+    // SegmentCopy may be shared with ancestral genomes, make sure it is private
+    TSegId id_seg = genome.unshareSegmentCopy(id_chr, sc, out_vec_seg_mod);
+    // initialize or append to Variant vector of SegmentCopy (after preceding transfers)
+    out_vec_var_add.push_back(make_tuple(out_vec_seg_mod.size(), id_seg, mut.id));
   }
   else { // CNV mutation
-    CopyNumberVariant cnv = this->map_id_cnv[mut.id];
-    // track modifications to SegmentCopies
-    vector<seqio::seg_mod_t> vec_seg_mod;
+    const CopyNumberVariant& cnv = this->map_id_cnv.at(mut.id);
 
     if (cnv.is_wgd) { // Whole Genome Duplication
-      genome.duplicate(vec_seg_mod);
-      this->transferMutations(vec_seg_mod);
+      genome.duplicate(out_vec_seg_mod);
     }
     else { // Not a WGD, chromosome region is affected
       // pick a ChromsomeInstance randomly (weighted by chromosome lengths)
       string id_chr = cnv.ref_chr;
       assert( genome.map_id_chr.find(id_chr) != genome.map_id_chr.end() );
-      vector<unsigned long> chr_len;
+      if ( genome.map_id_chr[id_chr].size() == 0 ) {
+        fprintf(stderr, "[INFO] (VariantStore::applyMutation) CNV '%d' masked (no copies of '%s' left).\n", mut.id, id_chr.c_str());
+        return;
+      }
+      vector<TCoord> chr_len;
       for (auto const & chr_inst : genome.map_id_chr[id_chr]) {
         chr_len.push_back(chr_inst->length);
       }
       function<int()> r_idx_chr = rng.getRandomIndexWeighted(chr_len);
       int idx_chr = r_idx_chr();
       shared_ptr<ChromosomeInstance> sp_chr = genome.map_id_chr[id_chr][idx_chr];
+      if (!cnv.is_chr_wide) // region will be modified in place
+        sp_chr = genome.unshareChromosome(id_chr, idx_chr);
 
+      vector<seqio::seg_mod_t> vec_seg_mod;
       if (cnv.is_chr_wide) { // whole-chromosome gain/loss
         if (cnv.is_deletion) { // delete current chromosome
           genome.deleteChromosome(sp_chr, id_chr);
         } else {
-          vector<seqio::seg_mod_t> vec_seg_mod;
           shared_ptr<ChromosomeInstance> sp_chr_new(new ChromosomeInstance());
+          sp_chr_new->sp_ids = genome.sp_ids;
           sp_chr_new->copy(sp_chr, vec_seg_mod);
-          this->transferMutations(vec_seg_mod);
         }
       } else if (cnv.is_deletion) { // delete a genomic region
         vec_seg_mod = sp_chr->deleteRegion(cnv.start_rel, cnv.len_rel, cnv.is_forward, cnv.is_telomeric);
-        this->transferMutations(vec_seg_mod);
       } else { // amplify a genomic region
         vec_seg_mod = sp_chr->amplifyRegion(cnv.start_rel, cnv.len_rel, cnv.is_forward, cnv.is_telomeric);
-        this->transferMutations(vec_seg_mod);
       }
-// sanity check: does chromosome length equal length of SegmentCopies?
-ulong len = 0;
-vector<ulong> lens;
-for (auto s : sp_chr->lst_segments) {
-  lens.push_back(s.ref_end - s.ref_start);
-  len += (s.ref_end - s.ref_start);
-}
-if (len != sp_chr->length) {
-  cerr << "### Lengths are off!! ###";
+      out_vec_seg_mod.insert(out_vec_seg_mod.end(), vec_seg_mod.begin(), vec_seg_mod.end());
+#ifndef NDEBUG
+      // sanity check: does chromosome length equal length of SegmentCopies?
+      if (sp_chr->segments.length() != sp_chr->length) {
+        fprintf(stderr, "[WARN] (VariantStore::applyMutation) length of '%s' does not match its SegmentCopies.\n", id_chr.c_str());
+      }
+#endif
+    }
+  }
 }
+
+/** Apply mutations of a clone tree node, then process its subtrees as parallel tasks. */
+static void
+applyCloneTreeMutationsRec (
+  VariantStore& var_store,
+  const shared_ptr<Clone>& node,
+  const vector<Mutation>& vec_mut,
+  map<int, GenomeInstance>& map_id_genome,
+  const map<int, shared_ptr<SegmentIdAllocator>>& map_id_seg_ids,
+  const uint64_t seed_node
+)
+{
+  GenomeInstance& gi_node = map_id_genome.at(node->index);
+  if (!node->isRoot()) {
+    stringstream ss_node;
+    ss_node << *node;
+    fprintf(stderr, "\t%s\n\t\t[%lu mutations...]\n", ss_node.str().c_str(), node->m_vec_mutations.size());
+    // apply somatic mutations (SNVs + CNVs, in order)
+    RandomNumberGenerator rng_node(seed_node, node->index);
+    vector<Mutation> vec_mut_node;
+    for (int mut : node->m_vec_mutations) {
+      vec_mut_node.push_back(vec_mut[mut]);
     }
+    var_store.applyMutations(vec_mut_node, gi_node, rng_node);
   }
+
+  // copy genome to children (chromosomes are shared until modified)
+  vector<shared_ptr<Clone>> vec_children = node->getChildren();
+  for (auto const & child : vec_children) {
+    GenomeInstance& gi_child = map_id_genome.at(child->index);
+    gi_child = gi_node;
+    gi_child.sp_ids = map_id_seg_ids.at(child->index);
+  }
+
+  // subtrees are independent of each other
+  for (size_t i = 0; i < vec_children.size(); ++i) {
+    shared_ptr<Clone> child = vec_children[i];
+    #pragma omp task default(shared) firstprivate(child)
+    applyCloneTreeMutationsRec(var_store, child, vec_mut, map_id_genome, map_id_seg_ids, seed_node);
+  }
+  #pragma omp taskwait
 }
 
-void VariantStore::transferMutations(vector<seqio::seg_mod_t> vec_seg_mod) {
-  uuid seg_new_id;
-  uuid seg_old_id;
+void
+VariantStore::applyCloneTreeMutations (
+  const vector<shared_ptr<Clone>>& nodes,
+  const vector<Mutation>& vec_mut,
+  map<int, GenomeInstance>& map_id_genome,
+  RandomNumberGenerator& rng
+)
+{
+  assert( nodes.size() > 0 );
+  assert( map_id_genome.count(nodes[0]->index) > 0 );
+
+  // reserve SegmentCopy ids for each node (in pre-order, ancestors get lower ids than descendants)
+  shared_ptr<SegmentIdAllocator> sp_ids = map_id_genome.at(nodes[0]->index).sp_ids;
+  TSegId num_ids_node = sp_ids->available() / nodes.size();
+  map<int, shared_ptr<SegmentIdAllocator>> map_id_seg_ids;
+  for (size_t i = 1; i < nodes.size(); ++i) {
+    map_id_seg_ids[nodes[i]->index] = sp_ids->fork(num_ids_node);
+    // create GenomeInstances up front, map is not modified concurrently
+    map_id_genome[nodes[i]->index];
+  }
+
+  // each node gets its own random stream
+  uint64_t seed_node = rng.getStreamSeed();
+
+  #pragma omp parallel
+  {
+  #pragma omp single
+  applyCloneTreeMutationsRec(*this, nodes[0], vec_mut, map_id_genome, map_id_seg_ids, seed_node);
+  } // pragma omp parallel
+}
+
+/** Transfer variants from existing SegmentCopy to new one (not thread-safe). */
+static void
+transferSegmentVariants (
+  VariantStore& var_store,
+  const seqio::seg_mod_t& seg_mod
+)
+{
+  // each modification carries information about:
+  // - newly created SegmentCopy
+  // - existing SegmentCopy it was copied from
+  // - interval (start, end) the new SegmentCopy originates from
+  TSegId seg_new_id;
+  TSegId seg_old_id;
   seqio::TCoord seg_old_start;
   seqio::TCoord seg_old_end;
+  tie(seg_new_id, seg_old_id, seg_old_start, seg_old_end) = seg_mod;
+
+  // transfer variants associated with the copied region within old SegmentCopy
+  auto it_vars = var_store.map_seg_vars.find(seg_old_id);
+  if (it_vars == var_store.map_seg_vars.end())
+    return;
+  shared_ptr<vector<int>> sp_old_vars = it_vars->second;
+  const VariantTable& tbl_snv = var_store.tbl_snv;
+
+  // variant list is sorted by position: check outermost variants first
+  // (copies of whole segments do not need to search the list)
+  bool is_whole_copy = sp_old_vars->empty();
+  if (!is_whole_copy) {
+    TCoord pos_first = tbl_snv.pos(tbl_snv.getRow(sp_old_vars->front()));
+    TCoord pos_last = tbl_snv.pos(tbl_snv.getRow(sp_old_vars->back()));
+    is_whole_copy = (pos_first >= seg_old_start && pos_last < seg_old_end);
+  }
+  if (is_whole_copy) {
+    // all variants are inherited: refer to existing list
+    var_store.map_seg_vars[seg_new_id] = sp_old_vars;
+    return;
+  }
+  auto p_snvs = var_store.getSegmentSnvs(seg_old_id, seg_old_start, seg_old_end);
+  if (p_snvs.first != p_snvs.second) {
+    var_store.map_seg_vars[seg_new_id] = make_shared<vector<int>>(p_snvs.first, p_snvs.second);
+  }
+}
 
-  // loop over SegmentCopy modifications
-  for (auto const & tpl_seg_mod : vec_seg_mod) {
-    // each modification carries information about:
-    // - newly created SegmentCopy
-    // - existing SegmentCopy it was copied from
-    // - interval (start, end) the new SegmentCopy originates from
-    tie(seg_new_id, seg_old_id, seg_old_start, seg_old_end) = tpl_seg_mod;
-
-    // transfer variants associated with the copied region within old SegmentCopy
-    vector<int> seg_new_vars;
-    auto it_vars = this->map_seg_vars.find(seg_old_id);
-    if (it_vars == this->map_seg_vars.end())
-      continue;
-    for (auto const & id_snv : it_vars->second) {
-      Variant snv = this->map_id_snv[id_snv];
-      if (snv.pos >= seg_old_start && snv.pos < seg_old_end) {
-        seg_new_vars.push_back(id_snv);
-      }
-    }
-    if (seg_new_vars.size() > 0) {
-      this->map_seg_vars[seg_new_id] = seg_new_vars;
+/** Orders SNV ids by position, then by id. */
+struct SnvPositionLess {
+  const VariantTable& tbl_snv;
+  SnvPositionLess(const VariantTable& tbl_snv) : tbl_snv(tbl_snv) {}
+  bool operator() (const int a, const int b) const {
+    TCoord pos_a = tbl_snv.pos(tbl_snv.getRow(a));
+    TCoord pos_b = tbl_snv.pos(tbl_snv.getRow(b));
+    return pos_a < pos_b || (pos_a == pos_b && a < b);
+  }
+};
+
+/** Insert variant into (position-sorted) list of SegmentCopy (not thread-safe). */
+static void
+addSegmentVariantUnsync (
+  VariantStore& var_store,
+  const TSegId id_seg,
+  const int id_var
+)
+{
+  shared_ptr<vector<int>>& sp_vars = var_store.map_seg_vars[id_seg];
+  if (!sp_vars) {
+    sp_vars = make_shared<vector<int>>();
+  } else if (sp_vars.use_count() > 1) {
+    // list is shared with other SegmentCopies
+    sp_vars = make_shared<vector<int>>(*sp_vars);
+  }
+  SnvPositionLess pos_less(var_store.tbl_snv);
+  if (sp_vars->empty() || pos_less(sp_vars->back(), id_var))
+    sp_vars->push_back(id_var);
+  else
+    sp_vars->insert(upper_bound(sp_vars->begin(), sp_vars->end(), id_var, pos_less), id_var);
+}
+
+void
+VariantStore::transferMutations (
+  const vector<seqio::seg_mod_t>& vec_seg_mod
+)
+{
+  this->updateSegmentVariants(vec_seg_mod, vector<TSegVarAdd>());
+}
+
+void
+VariantStore::addSegmentVariant (
+  const TSegId id_seg,
+  const int id_var
+)
+{
+  #pragma omp critical(map_seg_vars)
+  addSegmentVariantUnsync(*this, id_seg, id_var);
+}
+
+void
+VariantStore::updateSegmentVariants (
+  const vector<seqio::seg_mod_t>& vec_seg_mod,
+  const vector<TSegVarAdd>& vec_var_add
+)
+{
+  // SNVs associated after the same number of modifications are added by position
+  // (most insertions append to variant lists)
+  SnvPositionLess pos_less(this->tbl_snv);
+  vector<const TSegVarAdd*> vec_add_sorted(vec_var_add.size());
+  for (size_t k = 0; k < vec_var_add.size(); ++k)
+    vec_add_sorted[k] = &vec_var_add[k];
+  stable_sort(vec_add_sorted.begin(), vec_add_sorted.end(),
+    [&pos_less](const TSegVarAdd* a, const TSegVarAdd* b) {
+      return get<0>(*a) < get<0>(*b) || (get<0>(*a) == get<0>(*b) && pos_less(get<2>(*a), get<2>(*b)));
+    });
+
+  #pragma omp critical(map_seg_vars)
+  {
+  auto it_add = vec_add_sorted.begin();
+  for (size_t i = 0; i <= vec_seg_mod.size(); ++i) {
+    // SNVs associated after the first i modifications
+    for (; it_add != vec_add_sorted.end() && get<0>(**it_add) == i; ++it_add) {
+      addSegmentVariantUnsync(*this, get<1>(**it_add), get<2>(**it_add));
     }
+    if (i < vec_seg_mod.size())
+      transferSegmentVariants(*this, vec_seg_mod[i]);
   }
+  } // pragma omp critical
 }
 
 vector<Variant>
 VariantStore::getGermlineSnvVector ()
 {
   vector<Variant> variants;
-  for (auto const & kv : this->map_id_snv) {
-    Variant var = kv.second;
-    if ( !var.is_somatic )
-      variants.push_back(var);
+  for (int id : this->tbl_snv.getIds()) {
+    VariantTable::TRow row = this->tbl_snv.getRow(id);
+    if ( !this->tbl_snv.isSomatic(row) )
+      variants.push_back(this->tbl_snv.getVariant(row));
   }
 
   return variants;
@@ -403,66 +787,65 @@ vector<Variant>
 VariantStore::getSomaticSnvVector () 
 {
   vector<Variant> variants;
-  for (auto const & kv : this->map_id_snv) {
-    Variant var = kv.second;
-    if ( var.is_somatic )
-      variants.push_back(var);
+  for (int id : this->tbl_snv.getIds()) {
+    VariantTable::TRow row = this->tbl_snv.getRow(id);
+    if ( this->tbl_snv.isSomatic(row) )
+      variants.push_back(this->tbl_snv.getVariant(row));
   }
 
   return variants;
 }
 
+pair<const int*, const int*>
+VariantStore::getSegmentSnvs (
+  const TSegId id_seg,
+  const TCoord pos_start,
+  const TCoord pos_end
+) const
+{
+  auto it_seg_vars = this->map_seg_vars.find(id_seg);
+  if (it_seg_vars == this->map_seg_vars.end() || it_seg_vars->second->empty())
+    return make_pair(nullptr, nullptr);
+  const vector<int>& vec_vars = *(it_seg_vars->second);
+  const int* p_first = vec_vars.data();
+  const int* p_last = p_first + vec_vars.size();
+
+  // variant list is sorted by position
+  const VariantTable& tbl = this->tbl_snv;
+  auto pos_less = [&tbl](const int id, const TCoord pos) { return tbl.pos(tbl.getRow(id)) < pos; };
+  const int* p_lo = lower_bound(p_first, p_last, pos_start, pos_less);
+  const int* p_hi = lower_bound(p_lo, p_last, pos_end, pos_less);
+  return make_pair(p_lo, p_hi);
+}
+
 int
 VariantStore::getSnvsForSegmentCopy (
   map<seqio::TCoord, vector<Variant>>& map_vars,
-  const boost::uuids::uuid id_seg
+  const TSegId id_seg
 ) const
 {
-  int n_vars = 0;
-  map_vars.clear();
-
-  auto it_seg_vars = this->map_seg_vars.find(id_seg);
-  if (it_seg_vars != this->map_seg_vars.end()) {
-    for (int id_var : it_seg_vars->second) {
-      Variant var = this->map_id_snv.at(id_var);
-      if (map_vars.count(var.pos) == 0)
-        map_vars[var.pos] = vector<Variant>();
-      map_vars[var.pos].push_back(var);
-
-        
-      n_vars++;
-    }
-  }
-  
-  return n_vars;
+  return this->getSnvsForSegmentCopy(map_vars, id_seg, 0, numeric_limits<TCoord>::max());
 }
 
 int
 VariantStore::getSnvsForSegmentCopy (
   map<seqio::TCoord, vector<Variant>>& map_vars,
-  const boost::uuids::uuid id_seg,
+  const TSegId id_seg,
   const TCoord pos_start,
   const TCoord pos_end
 ) const
 {
-  int n_vars = 0;
   map_vars.clear();
 
-  auto it_seg_vars = this->map_seg_vars.find(id_seg);
-  if (it_seg_vars != this->map_seg_vars.end()) {
-    for (int id_var : it_seg_vars->second) {
-      Variant var = this->map_id_snv.at(id_var);
-      if ( var.pos>=pos_start && var.pos<=pos_end ) {
-        if (map_vars.count(var.pos) == 0)
-          map_vars[var.pos] = vector<Variant>();
-        map_vars[var.pos].push_back(var);
-      }
-        
-      n_vars++;
-    }
+  // pos_end is inclusive
+  TCoord pos_stop = (pos_end < numeric_limits<TCoord>::max()) ? pos_end+1 : pos_end;
+  auto p_snvs = this->getSegmentSnvs(id_seg, pos_start, pos_stop);
+  for (const int* p_id = p_snvs.first; p_id != p_snvs.second; ++p_id) {
+    Variant var = this->tbl_snv.at(*p_id);
+    map_vars[var.pos].push_back(var);
   }
-  
-  return n_vars;
+
+  return p_snvs.second - p_snvs.first;
 }
 
 unsigned 
@@ -474,15 +857,7 @@ VariantStore::writeGermlineSnvsToVcf (
   unsigned n_vars = 0;
 
   // retrieve germline SNVs
-  vector<Variant> vec_var;
-  for (auto const & id_snv : map_id_snv) {
-
-    int id = id_snv.first;
-    Variant var = id_snv.second;
-
-    if (!var.is_somatic)
-      vec_var.push_back(var);
-  }
+  vector<Variant> vec_var = this->getGermlineSnvVector();
 
   n_vars = writeVcf(filename, genome, vec_var, "germline");
   return n_vars;
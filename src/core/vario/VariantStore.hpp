@@ -1,7 +1,11 @@
 #ifndef VARIANTSTORE_H
 #define VARIANTSTORE_H
 
+#include "../clone.hpp"
 #include "../vario.hpp"
+#include "SegmentVariantMap.hpp"
+#include "VariantTable.hpp"
+#include <limits>
 
 namespace vario {
 
@@ -10,16 +14,16 @@ namespace vario {
  */
 struct VariantStore
 {
-  /** map of single-nucleotide variants */
-  std::map<int, Variant> map_id_snv;
+  /** Association of SNV to SegmentCopy: (number of preceding SegmentCopy modifications, SegmentCopy id, SNV id) */
+  typedef std::tuple<size_t, seqio::TSegId, int> TSegVarAdd;
+
+  /** single-nucleotide variants (columnar, addressed by variant id) */
+  VariantTable tbl_snv;
   /** map of somatic copy-number variants */
   std::map<int, CopyNumberVariant> map_id_cnv;
-  /** remember SNVs affecting each SegmentCopy */
-  std::map<boost::uuids::uuid, std::vector<int>> map_seg_vars;
-  /** index SNVs by chromosome and ref position for fast lookup during spike-in. */
-  std::map<std::string, std::map<seqio::TCoord, std::vector<int>>> map_chr_pos_snvs;
-
-  /** Index variants by chromosome and position. 
+  /** remember SNVs affecting each SegmentCopy, sorted by position (lists may be shared by SegmentCopies) */
+  SegmentVariantMap map_seg_vars;
+  /** Index variants by chromosome and position (for fast lookup during spike-in).
    *  \returns Number of indexed SNVs.
    */
   unsigned indexSnvs ();
@@ -33,6 +37,21 @@ struct VariantStore
   /** Get VariantSet of SNVs. */
   VariantSet getSnvSet ();
 
+  /** Get ids of SNVs carried by a SegmentCopy located in [pos_start, pos_end).
+    * SNVs are sorted by position, the returned range points into the SegmentCopy's variant list
+    * (valid until variants are added).
+    * \param id_seg     SegmentCopy id.
+    * \param pos_start  Left-most position of SNVs (inclusive).
+    * \param pos_end    Right-most position of SNVs (exclusive).
+    * \returns          Range of SNV ids (empty if SegmentCopy carries no SNVs).
+    */
+  std::pair<const int*, const int*>
+  getSegmentSnvs (
+    const seqio::TSegId id_seg,
+    const seqio::TCoord pos_start = 0,
+    const seqio::TCoord pos_end = std::numeric_limits<seqio::TCoord>::max()
+  ) const;
+
   /** Get Variants associated with SegmentCopy. 
     * \param map_vars  Output param: Variants indexed by position.
     * \param id_seg    SegmentCopy id for which to retrieve variants.
@@ -41,7 +60,7 @@ struct VariantStore
   int
   getSnvsForSegmentCopy (
     std::map<seqio::TCoord, std::vector<Variant>>& map_vars,
-    const boost::uuids::uuid id_seg
+    const seqio::TSegId id_seg
   ) const;
 
   /** Get Variants associated with SegmentCopy between given positions. 
@@ -54,7 +73,7 @@ struct VariantStore
   int
   getSnvsForSegmentCopy (
     std::map<seqio::TCoord, std::vector<Variant>>& map_vars,
-    const boost::uuids::uuid id_seg,
+    const seqio::TSegId id_seg,
     const seqio::TCoord pos_start,
     const seqio::TCoord pos_end
   ) const;
@@ -100,6 +119,8 @@ struct VariantStore
   );
 
   /** Loop over variants and for each germline variant, pick affected segment copies in genome instance.
+   *  Variants are located among the SegmentCopies of each chromosome in a single sweep
+   *  (chromosomes in parallel), segment copies are then picked in order of variant ids.
    *  \param genome  Genome instance to which to apply germline variants.
    *  \param rng     Random number generator (used to pick segment copies to mutate).
    *  \returns       true on success, false on error.
@@ -117,8 +138,93 @@ struct VariantStore
    */
   void applyMutation(Mutation m, GenomeInstance& g, RandomNumberGenerator& r);
 
-  /** Transfer mutations from existing SegmentCopies to new ones. */
-  void transferMutations(std::vector<seqio::seg_mod_t> vec_seg_mod);
+  /** Apply a sequence of mutations (e.g. of a clone tree branch) to a GenomeInstance.
+   *  Mutations modify the GenomeInstance in order (see applyMutation()), the resulting
+   *  changes to variant lists of SegmentCopies are applied as one batch.
+   */
+  void
+  applyMutations (
+    const std::vector<Mutation>& vec_mut,
+    GenomeInstance& genome,
+    RandomNumberGenerator& rng
+  );
+
+  /** Apply a mutation to a GenomeInstance, recording changes to variant lists.
+   *  \param mut              Mutation to apply.
+   *  \param genome           GenomeInstance to modify.
+   *  \param rng              Random number generator.
+   *  \param out_vec_seg_mod  Output param: new SegmentCopies are appended.
+   *  \param out_vec_var_add  Output param: new SNV associations are appended.
+   */
+  void
+  planMutation (
+    const Mutation& mut,
+    GenomeInstance& genome,
+    RandomNumberGenerator& rng,
+    std::vector<seqio::seg_mod_t>& out_vec_seg_mod,
+    std::vector<TSegVarAdd>& out_vec_var_add
+  ) const;
+
+  /** Apply a run of SNV mutations to a GenomeInstance, recording changes to variant lists.
+   *  Equivalent to calling planMutation() for each SNV, but loci are located in a single
+   *  sweep over the SegmentCopies of each chromosome.
+   *  \param it_first         First SNV mutation of run.
+   *  \param it_last          End of run (SNVs do not change the genome structure).
+   *  \param genome           GenomeInstance to modify.
+   *  \param rng              Random number generator.
+   *  \param out_vec_seg_mod  Output param: new SegmentCopies are appended.
+   *  \param out_vec_var_add  Output param: new SNV associations are appended.
+   */
+  void
+  planSnvMutations (
+    std::vector<Mutation>::const_iterator it_first,
+    std::vector<Mutation>::const_iterator it_last,
+    GenomeInstance& genome,
+    RandomNumberGenerator& rng,
+    std::vector<seqio::seg_mod_t>& out_vec_seg_mod,
+    std::vector<TSegVarAdd>& out_vec_var_add
+  ) const;
+
+  /** Apply somatic mutations along a clone tree, generating a GenomeInstance for each node.
+   *  Subtrees are processed as parallel tasks as soon as the parent's GenomeInstance is ready.
+   *  Each node draws random numbers from its own stream and SegmentCopy ids from its own
+   *  range, so the result does not depend on the number of threads.
+   *  \param nodes          Clone tree nodes in pre-order (root first).
+   *  \param vec_mut        Somatic mutations (indexed by ids assigned to nodes).
+   *  \param map_id_genome  GenomeInstances by node index (must contain root's GenomeInstance).
+   *  \param rng            Random number generator (used to seed node streams).
+   */
+  void
+  applyCloneTreeMutations (
+    const std::vector<std::shared_ptr<Clone>>& nodes,
+    const std::vector<Mutation>& vec_mut,
+    std::map<int, GenomeInstance>& map_id_genome,
+    RandomNumberGenerator& rng
+  );
+
+  /** Transfer mutations from existing SegmentCopies to new ones.
+   *  New SegmentCopies covering all variants of the old one share its variant list,
+   *  partial copies receive the slice of variants located in the copied interval.
+   *  (thread-safe)
+   */
+  void transferMutations(const std::vector<seqio::seg_mod_t>& vec_seg_mod);
+
+  /** Associate a variant with a SegmentCopy (keeping its variant list sorted by position).
+   *  A variant list shared with other SegmentCopies is copied before being modified.
+   *  (thread-safe)
+   */
+  void addSegmentVariant(const seqio::TSegId id_seg, const int id_var);
+
+  /** Update variant lists of SegmentCopies (thread-safe).
+   *  Transfers and new associations are applied in the order they were recorded.
+   *  \param vec_seg_mod  New SegmentCopies (cf. transferMutations()).
+   *  \param vec_var_add  New SNV associations (cf. addSegmentVariant()).
+   */
+  void
+  updateSegmentVariants (
+    const std::vector<seqio::seg_mod_t>& vec_seg_mod,
+    const std::vector<TSegVarAdd>& vec_var_add
+  );
 
   /** Write somatic SNVs to VCF file.
    *  \param filename  Output file name.
@@ -0,0 +1,223 @@
+#include "VariantTable.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+using namespace std;
+using seqio::TCoord;
+
+namespace vario {
+
+const VariantTable::TRow VariantTable::NO_ROW = numeric_limits<VariantTable::TRow>::max();
+
+/** 2-bit code of a single-base allele (-1 if it cannot be encoded). */
+static short
+encodeAllele (
+  const string& allele
+)
+{
+  if (allele.length() != 1)
+    return -1;
+  switch (allele[0]) {
+    case 'A': return 0;
+    case 'C': return 1;
+    case 'G': return 2;
+    case 'T': return 3;
+  }
+  return -1;
+}
+
+VariantTable::VariantTable () : id_min(0) {}
+
+VariantTable::TRow
+VariantTable::add (
+  const int id,
+  const Variant& var
+)
+{
+  // make room in id index
+  if (vec_id_row.empty()) {
+    id_min = id;
+  } else if (id < id_min) {
+    vec_id_row.insert(vec_id_row.begin(), id_min - id, NO_ROW);
+    id_min = id;
+  }
+  if (size_t(id - id_min) >= vec_id_row.size())
+    vec_id_row.resize(id - id_min + 1, NO_ROW);
+
+  // encode alleles and flags
+  uint8_t code = 0;
+  short code_ref = var.alleles.size() == 2 ? encodeAllele(var.alleles[0]) : -1;
+  short code_alt = var.alleles.size() == 2 ? encodeAllele(var.alleles[1]) : -1;
+  if (code_ref >= 0 && code_alt >= 0)
+    code = code_ref | (code_alt << CODE_SHIFT_ALT);
+  else
+    code = FLAG_EXT_ALLELES;
+  if (var.is_het) code |= FLAG_HET;
+  if (var.is_somatic) code |= FLAG_SOMATIC;
+  if (var.is_error) code |= FLAG_ERROR;
+
+  TRow row = vec_id_row[id - id_min];
+  if (row == NO_ROW) {
+    row = col_id.size();
+    vec_id_row[id - id_min] = row;
+    col_id.push_back(id);
+    col_label.push_back(var.id);
+    col_chr.push_back(internChromosome(var.chr));
+    col_pos.push_back(var.pos);
+    col_rel_pos.push_back(var.rel_pos);
+    col_code.push_back(code);
+    col_idx_mutation.push_back(var.idx_mutation);
+    col_reg_copy.push_back(var.reg_copy);
+  } else {
+    col_label[row] = var.id;
+    col_chr[row] = internChromosome(var.chr);
+    col_pos[row] = var.pos;
+    col_rel_pos[row] = var.rel_pos;
+    col_code[row] = code;
+    col_idx_mutation[row] = var.idx_mutation;
+    col_reg_copy[row] = var.reg_copy;
+    map_row_alleles.erase(row);
+  }
+  if (code & FLAG_EXT_ALLELES)
+    map_row_alleles[row] = var.alleles;
+
+  return row;
+}
+
+vector<int>
+VariantTable::getIds () const
+{
+  vector<int> vec_id;
+  vec_id.reserve(col_id.size());
+  for (size_t i = 0; i < vec_id_row.size(); ++i) {
+    if (vec_id_row[i] != NO_ROW)
+      vec_id.push_back(id_min + int(i));
+  }
+  return vec_id;
+}
+
+uint32_t
+VariantTable::internChromosome (
+  const string& id_chr
+)
+{
+  auto res = map_chr_idx.insert(make_pair(id_chr, uint32_t(vec_chr_name.size())));
+  if (res.second)
+    vec_chr_name.push_back(id_chr);
+  return res.first->second;
+}
+
+void
+VariantTable::setLocus (
+  const TRow row,
+  const string& id_chr,
+  const TCoord pos
+)
+{
+  col_chr[row] = internChromosome(id_chr);
+  col_pos[row] = pos;
+}
+
+/** Get first base of an allele stored in the side table ('N' if missing). */
+static char
+getExtAlleleBase (
+  const map<VariantTable::TRow, vector<string>>& map_row_alleles,
+  const VariantTable::TRow row,
+  const size_t idx_allele
+)
+{
+  const vector<string>& alleles = map_row_alleles.at(row);
+  if (idx_allele >= alleles.size() || alleles[idx_allele].length() == 0)
+    return 'N';
+  return alleles[idx_allele][0];
+}
+
+char
+VariantTable::ref (
+  const TRow row
+) const
+{
+  if (col_code[row] & FLAG_EXT_ALLELES)
+    return getExtAlleleBase(map_row_alleles, row, 0);
+  return seqio::idx2nuc(col_code[row] & 0x3);
+}
+
+char
+VariantTable::alt (
+  const TRow row
+) const
+{
+  if (col_code[row] & FLAG_EXT_ALLELES)
+    return getExtAlleleBase(map_row_alleles, row, 1);
+  return seqio::idx2nuc((col_code[row] >> CODE_SHIFT_ALT) & 0x3);
+}
+
+Variant
+VariantTable::getVariant (
+  const TRow row
+) const
+{
+  Variant var(col_label[row], chr(row), col_pos[row]);
+  if (col_code[row] & FLAG_EXT_ALLELES) {
+    var.alleles = map_row_alleles.at(row);
+  } else {
+    var.alleles.push_back(string(1, ref(row)));
+    var.alleles.push_back(string(1, alt(row)));
+  }
+  var.reg_copy = col_reg_copy[row];
+  var.idx_mutation = col_idx_mutation[row];
+  var.rel_pos = col_rel_pos[row];
+  var.is_somatic = isSomatic(row);
+  var.is_het = isHet(row);
+  var.is_error = isError(row);
+  return var;
+}
+
+Variant
+VariantTable::at (
+  const int id
+) const
+{
+  TRow row = getRow(id);
+  if (row == NO_ROW)
+    throw out_of_range("VariantTable::at");
+  return getVariant(row);
+}
+
+size_t
+VariantTable::indexPositions ()
+{
+  vec_chr_rows.assign(vec_chr_name.size(), vector<TRow>());
+  // variants at the same position are kept in order of ids
+  for (TRow row : vec_id_row) {
+    if (row != NO_ROW)
+      vec_chr_rows[col_chr[row]].push_back(row);
+  }
+  for (auto & vec_rows : vec_chr_rows) {
+    stable_sort(vec_rows.begin(), vec_rows.end(),
+      [this](TRow a, TRow b) { return col_pos[a] < col_pos[b]; });
+  }
+  return col_id.size();
+}
+
+pair<const VariantTable::TRow*, const VariantTable::TRow*>
+VariantTable::getRowsInRange (
+  const string& id_chr,
+  const TCoord start,
+  const TCoord end
+) const
+{
+  auto it_chr = map_chr_idx.find(id_chr);
+  if (it_chr == map_chr_idx.end() || it_chr->second >= vec_chr_rows.size())
+    return make_pair(nullptr, nullptr);
+  const vector<TRow>& vec_rows = vec_chr_rows[it_chr->second];
+  auto it_lo = lower_bound(vec_rows.begin(), vec_rows.end(), start,
+    [this](TRow row, TCoord pos) { return col_pos[row] < pos; });
+  auto it_hi = lower_bound(it_lo, vec_rows.end(), end,
+    [this](TRow row, TCoord pos) { return col_pos[row] < pos; });
+  const TRow* p_data = vec_rows.data();
+  return make_pair(p_data + (it_lo - vec_rows.begin()), p_data + (it_hi - vec_rows.begin()));
+}
+
+} /* namespace vario */
@@ -0,0 +1,124 @@
+#ifndef VARIANTTABLE_H
+#define VARIANTTABLE_H
+
+#include "../vario.hpp"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace vario {
+
+/** Columnar (structure-of-arrays) storage of SNVs.
+ *
+ *  Each SNV occupies one row; rows are addressed by variant ids through a
+ *  dense index (germline variants carry negative ids, somatic ones
+ *  non-negative ids). Chromosome names are interned, single-base ACGT
+ *  alleles are stored as 2-bit codes. Alleles that cannot be encoded
+ *  (multi-base, ambiguous) are kept in a side table.
+ */
+struct VariantTable
+{
+  typedef uint32_t TRow;
+  /** marks variant ids without a row */
+  static const TRow NO_ROW;
+
+  /** bits of allele/flag code: ref (0-1), alt (2-3), flags (4-7) */
+  static const uint8_t CODE_SHIFT_ALT = 2;
+  static const uint8_t FLAG_HET = 0x10;
+  static const uint8_t FLAG_SOMATIC = 0x20;
+  static const uint8_t FLAG_EXT_ALLELES = 0x40;
+  static const uint8_t FLAG_ERROR = 0x80;
+
+  /** interned chromosome names */
+  std::vector<std::string> vec_chr_name;
+  /** index of chromosome names */
+  std::map<std::string, uint32_t> map_chr_idx;
+
+  /** columns (one entry per row) */
+  std::vector<int> col_id;
+  std::vector<std::string> col_label;
+  std::vector<uint32_t> col_chr;
+  std::vector<seqio::TCoord> col_pos;
+  std::vector<double> col_rel_pos;
+  std::vector<uint8_t> col_code;
+  std::vector<int> col_idx_mutation;
+  std::vector<short> col_reg_copy;
+  /** alleles that cannot be 2-bit encoded, by row */
+  std::map<TRow, std::vector<std::string>> map_row_alleles;
+
+  /** dense index of rows by variant id (offset by smallest id) */
+  int id_min;
+  std::vector<TRow> vec_id_row;
+
+  /** rows of each chromosome sorted by position (cf. indexPositions()) */
+  std::vector<std::vector<TRow>> vec_chr_rows;
+
+  /** default c'tor */
+  VariantTable();
+
+  /** Add a variant (replaces existing variant with the same id).
+   *  \returns row of variant.
+   */
+  TRow add(const int id, const Variant& var);
+
+  /** Number of variants. */
+  size_t size() const { return col_id.size(); }
+  /** Number of variants with given id (0 or 1). */
+  size_t count(const int id) const { return getRow(id) == NO_ROW ? 0 : 1; }
+
+  /** Get row of variant (NO_ROW if variant does not exist). */
+  TRow
+  getRow(const int id) const
+  {
+    if (id < id_min || size_t(id - id_min) >= vec_id_row.size())
+      return NO_ROW;
+    return vec_id_row[id - id_min];
+  }
+
+  /** Get variant ids in ascending order. */
+  std::vector<int> getIds() const;
+
+  /** Get chromosome index of name (adding it if not present). */
+  uint32_t internChromosome(const std::string& id_chr);
+
+  /** Set reference locus of a variant. */
+  void setLocus(const TRow row, const std::string& id_chr, const seqio::TCoord pos);
+
+  /** Column accessors */
+  const std::string& chr(const TRow row) const { return vec_chr_name[col_chr[row]]; }
+  seqio::TCoord pos(const TRow row) const { return col_pos[row]; }
+  const std::string& label(const TRow row) const { return col_label[row]; }
+  bool isHet(const TRow row) const { return col_code[row] & FLAG_HET; }
+  bool isSomatic(const TRow row) const { return col_code[row] & FLAG_SOMATIC; }
+  bool isError(const TRow row) const { return col_code[row] & FLAG_ERROR; }
+  /** Get first base of reference allele. */
+  char ref(const TRow row) const;
+  /** Get first base of alternative allele. */
+  char alt(const TRow row) const;
+
+  /** Get variant stored in row (with alleles decoded). */
+  Variant getVariant(const TRow row) const;
+  /** Get variant by id (throws std::out_of_range if it does not exist). */
+  Variant at(const int id) const;
+
+  /** Index rows by chromosome and position.
+   *  \returns Number of indexed variants.
+   */
+  size_t indexPositions();
+
+  /** Get rows of variants on a chromosome located in [start, end), sorted by position.
+   *  NOTE: Requires indexPositions() to have been called before.
+   */
+  std::pair<const TRow*, const TRow*>
+  getRowsInRange (
+    const std::string& id_chr,
+    const seqio::TCoord start,
+    const seqio::TCoord end
+  ) const;
+};
+
+} /* namespace vario */
+
+#endif /* VARIANTTABLE_H */
@@ -16,6 +16,8 @@
 #include "core/seqio/KmerProfile.hpp"
 #include "core/treeio.hpp"
 #include "core/vario.hpp"
+#include "core/vario/HaplotypeStore.hpp"
+#include "core/vario/SegmentArchive.hpp"
 
 #include "pcg-cpp/pcg_random.hpp"
 
@@ -100,6 +102,7 @@ int main (int argc, char* argv[])
   bool seq_reuse_reads = config.getValue<bool>("seq-reuse-reads");
   bool seq_fq_out = config.getValue<bool>("seq-fq-out");
   bool seq_sam_out = config.getValue<bool>("seq-sam-out");
+  bool seq_hap_out = config.getValue<bool>("seq-hap-out");
   int verbosity = config.getValue<int>("verbosity");
   int num_threads = config.threads;
   long seed = config.getValue<long>("seed");
@@ -351,8 +354,11 @@ int main (int argc, char* argv[])
     clone2fn[tree.m_root] = fn_ref_fa;
   }
   
-  ref_genome.indexRecords();
-  fprintf(stderr, "read (%u bp in %u sequences).\n", ref_genome.length, ref_genome.num_records);
+  if ( !do_ref_sim ) // reuse index cache stored next to reference file
+    ref_genome.indexRecords(fn_ref_fa);
+  else
+    ref_genome.indexRecords();
+  fprintf(stderr, "read (%lu bp in %u sequences).\n", ref_genome.length, ref_genome.num_records);
   // TODO: make this a parameter?
   ref_genome.ploidy = 2;
 
@@ -404,7 +410,10 @@ int main (int argc, char* argv[])
     fprintf(stderr, "simulating %d germline variants (model: %s).\n", n_mut_germline, str_model_gl.c_str());
     //vec_var_gl = var_store.generateGermlineVariants(n_mut_germline, ref_genome, model_gl, rng);
     //varset_gl = VariantSet(vec_var_gl);
-    var_store.generateGermlineVariants(n_mut_germline, ref_genome, model_gl, mut_gl_hom, rng);
+    if (!var_store.generateGermlineVariants(n_mut_germline, ref_genome, model_gl, mut_gl_hom, rng)) {
+      fprintf(stderr, "[ERROR] (main) could not generate germline variants.\n");
+      return EXIT_FAILURE;
+    }
 
     fn_mut_gl_vcf = format("%s/germline.vcf", path_out.c_str());
     fprintf(stderr, "writing generated variants to file: %s\n", fn_mut_gl_vcf.c_str());
@@ -420,7 +429,10 @@ int main (int argc, char* argv[])
   vector<Variant> vec_var_somatic;
   if (do_somatic_vars) {
     // generate point mutations (relative position + chr copy)
-    var_store.generateSomaticVariants(vec_mut_som, ref_genome, model_sm, model_cnv, rng);
+    if (!var_store.generateSomaticVariants(vec_mut_som, ref_genome, model_sm, model_cnv, rng)) {
+      fprintf(stderr, "[ERROR] (main) could not generate somatic variants.\n");
+      return EXIT_FAILURE;
+    }
     vec_var_somatic = var_store.getSomaticSnvVector();
     varset_sm = VariantSet(vec_var_somatic);
 
@@ -436,46 +448,22 @@ int main (int argc, char* argv[])
   vector<shared_ptr<Clone>> nodes = tree.getNodesPreOrder();
   // keep an individual GenomeInstance for each clone tree node
   map<int, GenomeInstance> map_id_genome;
+  // SegmentCopy identifiers are handed out by a single allocator across all clones
+  shared_ptr<seqio::SegmentIdAllocator> sp_seg_ids(new seqio::SegmentIdAllocator());
   // generate "healthy" GenomeInstance from reference genome
-  GenomeInstance healthy_genome = GenomeInstance(ref_genome);
+  GenomeInstance healthy_genome = GenomeInstance(ref_genome, sp_seg_ids);
   // root node corresponds to healthy genome (diploid)
   map_id_genome[nodes[0]->index] = healthy_genome;
   // apply germline mutations to healthy genome
   fprintf(stderr, "applying germline variants to clone tree root...\n");
   var_store.applyGermlineVariants(healthy_genome, rng);
 
-  // generate GenomeInstances for clones
+  // generate GenomeInstances for clones (subtrees are processed in parallel)
   if (nodes.size() > 1) {
     fprintf(stderr, "applying somatic variants by traversing clone tree...\n");
-
-    for (size_t i=1; i<nodes.size(); ++i) {
-      cerr << "\t" << *(nodes[i]) << endl;
-
-      // copy parent's genome
-      vector<seqio::seg_mod_t> vec_seg_mod;
-      //GenomeInstance gi_node(map_id_genome[nodes[i]->parent->index], vec_seg_mod);
-      GenomeInstance gi_parent = map_id_genome[nodes[i]->parent->index];
-      GenomeInstance gi_node(gi_parent, vec_seg_mod);
-//cerr << "parent:\t" << *(gi_parent.vec_chr[0]->lst_segments.begin()) << endl;
-//cerr << "child:\t" << *(gi_node.vec_chr[0]->lst_segments.begin()) << endl;
-      var_store.transferMutations(vec_seg_mod);
-
-      // get mutations for clone tree branch
-      vector<int> node_mut = nodes[i]->m_vec_mutations;
-      fprintf(stderr, "\t\t[%lu mutations...]\n", node_mut.size());
-      // apply somatic mutations (SNVs + CNVs, in order)
-      for (int mut : node_mut) {
-//cerr << "id_mut: " << mut << endl;
-        var_store.applyMutation(vec_mut_som[mut], gi_node, rng);
-      }
-      // store GenomeInstance for further use
-      map_id_genome[nodes[i]->index] = gi_node;
-    }
+    var_store.applyCloneTreeMutations(nodes, vec_mut_som, map_id_genome, rng);
   }
 
-cerr << "parent:\t" << *(map_id_genome[0].vec_chr[0]->lst_segments.begin()) << endl;
-cerr << "child:\t" << *(map_id_genome[1].vec_chr[0]->lst_segments.begin()) << endl;
-
   // prepare clone genomes for export
   map<string, GenomeInstance> map_clone_genome;
   vector<string> vec_clone_lbl;
@@ -500,46 +488,25 @@ cerr << "child:\t" << *(map_id_genome[1].vec_chr[0]->lst_segments.begin()) << en
   map_clone_genome[lbl_clone_normal] = map_id_genome[c_normal->index];
   vec_clone_lbl.push_back(lbl_clone_normal);
 
-
-// DEBUG info: export segment copies to file
-// TODO: move out to Logger class
-string fn_dbg_segs = (path_out / "segments.tsv").string();
-std::ofstream ofs_dbg_segs(fn_dbg_segs, std::ofstream::out);
-for (auto const & lbl_gi : map_clone_genome) {
-  string lbl_clone = lbl_gi.first;
-  for (auto const & id_chr : lbl_gi.second.map_id_chr) {
-    string lbl_chr = id_chr.first;
-    for (auto const & chr : id_chr.second) {
-      for (auto const & seg : chr->lst_segments) {
-        ofs_dbg_segs << lbl_clone << "\t";
-        ofs_dbg_segs << lbl_chr << "\t";
-        ofs_dbg_segs << seg.id << "\t";
-        ofs_dbg_segs << seg.ref_start << "\t";
-        ofs_dbg_segs << seg.ref_end << endl;
-      }
-    }    
+  // export clone genome layouts and associated variants (see cloniphy-segments for text export)
+  path fn_seg_archive = path_out / "segments.bin";
+  if (!vario::SegmentArchive::write(fn_seg_archive.string(), map_clone_genome, var_store)) {
+    fprintf(stderr, "[WARN] (main) could not write segment archive '%s'.\n", fn_seg_archive.c_str());
   }
-}
-ofs_dbg_segs.close();
-
-// DEBUG info: export variants associated to each segment copy
-// TODO: move out to Logger class
-string fn_dbg_vars = (path_out / "segment_vars.tsv").string();
-std::ofstream ofs_dbg_vars(fn_dbg_vars, std::ofstream::out);
-for (auto const & cg : map_clone_genome) {
-  string lbl_clone = cg.first;
-  for (auto const & ic : cg.second.map_id_chr) {
-    string lbl_chr = ic.first;
-    for (auto const & chr : ic.second) {
-      for (auto const & seg : chr->lst_segments) {
-        for (auto const & v : var_store.map_seg_vars[seg.id]) {
-          ofs_dbg_vars << seg.id << "\t" << var_store.map_id_snv[v].id << endl;
-        }
+
+  // export haplotype sequences of clone genomes (stored as edits to reference sequences)
+  if (seq_hap_out) {
+    // reference sequences are shared by clones, haplotypes are released once written
+    vario::HaplotypeStore hap_store;
+    for (auto const & lbl_genome : map_clone_genome) {
+      path fn_hap = path_fasta / format("%s.hap.fa", lbl_genome.first.c_str());
+      if (!hap_store.addClone(lbl_genome.first, lbl_genome.second, ref_genome, var_store) ||
+          !hap_store.writeFasta(lbl_genome.first, fn_hap.string())) {
+        fprintf(stderr, "[WARN] (main) could not write haplotypes of clone '%s'.\n", lbl_genome.first.c_str());
       }
+      hap_store.removeClone(lbl_genome.first);
     }
   }
-}
-ofs_dbg_vars.close();
 
   // for decoupling, transform sampling data frame to map
   map<string, map<string, double>> mtx_sample_clone;
@@ -604,7 +571,10 @@ ofs_dbg_vars.close();
 
   // determine allele-specific copy number state for samples
   // bulk_generator.calculateBulkCopyNumber(mtx_sample_clone, map_clone_genome);
-  bulk_generator.calculateBulkCopyNumber(map_clone_genome);
+  if (!bulk_generator.calculateBulkCopyNumber(map_clone_genome)) {
+    fprintf(stderr, "[ERROR] (main) could not determine copy number states of samples.\n");
+    return EXIT_FAILURE;
+  }
   // write absolute copy number states to BED file for each sample
   bulk_generator.writeBulkCopyNumber(path_bed);
 
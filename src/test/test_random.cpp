@@ -46,6 +46,26 @@ BOOST_AUTO_TEST_CASE( indices )
   }
 }
 
+/* pick indices from alias table */
+BOOST_AUTO_TEST_CASE( alias )
+{
+  vector<double> probs = { 0.1, 0.2, 0.0, 0.3, 0.4 };
+  AliasTable tbl(probs);
+  BOOST_REQUIRE( tbl.size() == probs.size() );
+
+  vector<int> counts(probs.size(), 0);
+  int num_draws = 100000;
+  for (int i=0; i<num_draws; ++i) {
+    counts[tbl.sample(gen.generator)]++;
+  }
+
+  BOOST_CHECK( counts[2] == 0 );
+  for (size_t i=0; i<probs.size(); ++i) {
+    BOOST_TEST_MESSAGE( format("%d: %d") % i % counts[i] );
+    BOOST_CHECK_CLOSE( double(counts[i])/num_draws + 1.0, probs[i] + 1.0, 1.0 );
+  }
+}
+
 /* generate random gamma-distributed values */
 BOOST_AUTO_TEST_CASE( gamma )
 {
@@ -9,6 +9,7 @@
 #include <boost/icl/interval_map.hpp>
 #include <map>
 #include <memory>
+#include <omp.h>
 #include <set>
 #include <vector>
 using namespace std;
@@ -74,8 +75,14 @@ BOOST_AUTO_TEST_CASE( gen )
   // display summary stats
   ref_genome.indexRecords();
   BOOST_TEST_MESSAGE( "Genomic 3-mer counts:" );
-  for (auto kv : ref_genome.map_3mer_pos) {
-    BOOST_TEST_MESSAGE( "  " << kv.first << ": " << kv.second.size() );
+  string nucs = "ACGT";
+  for (auto n1 : nucs) {
+    for (auto n2 : nucs) {
+      for (auto n3 : nucs) {
+        string tn = {n1, n2, n3};
+        BOOST_TEST_MESSAGE( "  " << tn << ": " << ref_genome.countTrinuc(tn) );
+      }
+    }
   }
 }
 
@@ -120,10 +127,560 @@ BOOST_AUTO_TEST_CASE ( index )
   BOOST_CHECK( ref_genome.length == 159071719 );
   BOOST_CHECK( ref_genome.num_records == 3 );
   BOOST_CHECK( ref_genome.records.size() == 3 );
-  BOOST_CHECK( ref_genome.nuc_pos[0].size() == 35749166 );
-  BOOST_CHECK( ref_genome.nuc_pos[1].size() == 28451472 );
-  BOOST_CHECK( ref_genome.nuc_pos[2].size() == 28496320 );
-  BOOST_CHECK( ref_genome.nuc_pos[3].size() == 35829712 );
+  BOOST_CHECK( ref_genome.countNuc(0) == 35749166 );
+  BOOST_CHECK( ref_genome.countNuc(1) == 28451472 );
+  BOOST_CHECK( ref_genome.countNuc(2) == 28496320 );
+  BOOST_CHECK( ref_genome.countNuc(3) == 35829712 );
+}
+
+/* 2-bit packed sequences and .2bit file format */
+BOOST_AUTO_TEST_CASE ( packed )
+{
+  string seq = "NNACGTacgtNNNNACGTTTGCAnnGCATGCATGCATGCATGCATGCATGCATGCATrY";
+  PackedSequence ps(seq);
+  BOOST_CHECK( ps.length == seq.length() );
+  BOOST_CHECK( ps.n_runs.size() == 4 );
+  BOOST_CHECK( ps.getNucAt(5) == 'T' );
+  BOOST_CHECK( ps.getNucAt(6) == 'a' );
+  BOOST_CHECK( ps.getNucAt(seq.length()-1) == 'N' );
+  string sub;
+  ps.extract(8, 10, sub);
+  BOOST_CHECK( sub == "gtNNNNACGT" );
+
+  // modify single positions
+  ps.setNucAt(11, 'C');
+  ps.setNucAt(3, 'N');
+  ps.extract(0, 14, sub);
+  BOOST_CHECK( sub == "NNANGTacgtNCNN" );
+  BOOST_CHECK( ps.n_runs.size() == 6 );
+
+  // records written to .2bit file are read back unchanged
+  vector<shared_ptr<SeqRecord>> vec_rec, vec_rec_2bit;
+  vec_rec.push_back(make_shared<SeqRecord>("seq1", "", seq));
+  vec_rec.push_back(make_shared<SeqRecord>("seq2", "", "ACGTA"));
+  vec_rec[1]->pack();
+  BOOST_REQUIRE( writeTwoBit(vec_rec, "test.2bit") );
+  BOOST_REQUIRE( readTwoBit("test.2bit", vec_rec_2bit) );
+  BOOST_REQUIRE( vec_rec_2bit.size() == 2 );
+  BOOST_CHECK( vec_rec_2bit[0]->id == "seq1" );
+  vec_rec_2bit[0]->getSubSeq(0, seq.length(), sub);
+  string seq_iupac = seq.substr(0, seq.length()-2) + "nN"; // IUPAC codes are stored as 'N'
+  BOOST_CHECK( sub == seq_iupac );
+  BOOST_CHECK( vec_rec_2bit[1]->seq_packed.str() == "ACGTA" );
+}
+
+/* memory-mapped FASTA file, accessed via index (.fai) */
+BOOST_AUTO_TEST_CASE ( mapped )
+{
+  ofstream ofs("test_mapped.fa");
+  ofs << ">seq1 id_ref=chrA\nACGTACGTAC\nGTacgtNNNN\nACG\n";
+  ofs << ">seq2\r\nTTTT\r\nGG\r\n";
+  ofs.close();
+  remove("test_mapped.fa.fai");
+
+  GenomeReference genome("test_mapped.fa");
+  BOOST_REQUIRE( genome.records.size() == 2 );
+  BOOST_CHECK( genome.records[0]->is_mapped );
+  BOOST_CHECK( genome.records[0]->id_ref == "chrA" );
+  BOOST_CHECK( genome.records[0]->length() == 23 );
+  BOOST_CHECK( genome.records[1]->length() == 6 );
+  string seq;
+  BOOST_CHECK( genome.getSequence("seq1", 8, 21, seq) );
+  BOOST_CHECK( seq == "ACGTacgtNNNNA" );
+  BOOST_CHECK( genome.getSequence("seq2", 2, 6, seq) );
+  BOOST_CHECK( seq == "TTGG" );
+
+  // index file is generated alongside FASTA
+  vector<FaiRecord> index;
+  BOOST_REQUIRE( readFastaIndex("test_mapped.fa.fai", index) );
+  BOOST_REQUIRE( index.size() == 2 );
+  BOOST_CHECK( index[0].offset == 18 );
+  BOOST_CHECK( index[0].line_bases == 10 && index[0].line_width == 11 );
+  BOOST_CHECK( index[1].line_bases == 4 && index[1].line_width == 6 );
+
+  genome.indexRecords();
+  BOOST_CHECK( genome.masked_length == 25 );
+  BOOST_CHECK( genome.countNuc(1) == 5 );
+}
+
+/* reuse genome index from cache file */
+BOOST_AUTO_TEST_CASE ( cache )
+{
+  RandomNumberGenerator rng(123456789);
+  GenomeReference genome_gen;
+  genome_gen.generate_nucfreqs(3, 100000, 0, {0.3, 0.2, 0.2, 0.3}, rng);
+  genome_gen.records[0]->setNucAt(500, 'N');
+  writeFasta(genome_gen.records, "test_cache.fa");
+  remove("test_cache.fa.gidx");
+
+  // first run generates cache
+  GenomeReference genome("test_cache.fa");
+  BOOST_CHECK( !genome.readIndexCache("test_cache.fa.gidx", "test_cache.fa") );
+  genome.indexRecords("test_cache.fa");
+
+  // second run loads cache
+  GenomeReference genome_cached("test_cache.fa");
+  BOOST_REQUIRE( genome_cached.readIndexCache("test_cache.fa.gidx", "test_cache.fa") );
+  BOOST_CHECK( genome_cached.length == genome.length );
+  BOOST_CHECK( genome_cached.masked_length == genome.masked_length );
+  BOOST_CHECK( genome_cached.vec_start_masked == genome.vec_start_masked );
+  BOOST_CHECK( genome_cached.vec_cumlen_masked == genome.vec_cumlen_masked );
+  BOOST_CHECK( genome_cached.countTrinuc("ACG") == genome.countTrinuc("ACG") );
+  BOOST_CHECK( genome_cached.getNucPos(2, 12345) == genome.getNucPos(2, 12345) );
+
+  // corrupted cache is rejected
+  fstream fs("test_cache.fa.gidx", ios::in | ios::out | ios::binary);
+  fs.seekp(-1, ios::end);
+  fs.put('x');
+  fs.close();
+  BOOST_CHECK( !genome_cached.readIndexCache("test_cache.fa.gidx", "test_cache.fa") );
+}
+
+/* locate k-th occurrence of nucleotides and tri-nucleotides */
+BOOST_AUTO_TEST_CASE ( context )
+{
+  RandomNumberGenerator rng(123456789);
+  GenomeReference genome;
+  genome.generate_nucfreqs(5, 100000, 50000, {0.3, 0.2, 0.2, 0.3}, rng);
+  // mask some positions
+  genome.records[1]->setNucAt(100, 'N');
+  genome.records[2]->setNucAt(5000, 'N');
+  genome.records[2]->setNucAt(5002, 'N');
+  genome.indexRecords();
+
+  // collect positions naively
+  vector<vector<TCoord>> vec_nuc_pos(4);
+  map<string, vector<TCoord>> map_3mer_pos;
+  for (unsigned i=0; i<genome.num_records; ++i) {
+    string seq = genome.records[i]->seq_packed.str();
+    for (TCoord p=0; p<seq.length(); ++p) {
+      short nuc = nuc2idx(seq[p]);
+      if (nuc > -1)
+        vec_nuc_pos[nuc].push_back(genome.vec_start_chr[i] + p);
+      string tn = seq.substr(p, 3);
+      if (tn.length() == 3 && tn.find('N') == string::npos)
+        map_3mer_pos[tn].push_back(genome.vec_start_chr[i] + p);
+    }
+  }
+
+  for (short n=0; n<4; ++n) {
+    BOOST_REQUIRE( genome.countNuc(n) == vec_nuc_pos[n].size() );
+    for (TCoord k=0; k<vec_nuc_pos[n].size(); k+=37)
+      BOOST_CHECK( genome.getNucPos(n, k) == vec_nuc_pos[n][k] );
+    BOOST_CHECK( genome.getNucPos(n, vec_nuc_pos[n].size()-1) == vec_nuc_pos[n].back() );
+  }
+  for (auto const & kv : map_3mer_pos) {
+    BOOST_REQUIRE( genome.countTrinuc(kv.first) == kv.second.size() );
+    for (TCoord k=0; k<kv.second.size(); k+=7)
+      BOOST_CHECK( genome.getTrinucPos(kv.first, k) == kv.second[k] );
+  }
+}
+
+/* resolve global and relative positions to genomic loci */
+BOOST_AUTO_TEST_CASE ( locus )
+{
+  ofstream ofs("test_locus.fa");
+  ofs << ">seq1\nACGTNNNNAC\n>seq2\nNNGGTT\n";
+  ofs.close();
+  GenomeReference genome("test_locus.fa");
+  genome.indexRecords();
+  BOOST_REQUIRE( genome.length == 16 );
+  BOOST_REQUIRE( genome.masked_length == 10 );
+
+  Locus loc = genome.getLocusByGlobalPos(9);
+  BOOST_CHECK( loc.idx_record == 0 && loc.start == 9 && loc.id_ref == "seq1" );
+  loc = genome.getLocusByGlobalPos(10);
+  BOOST_CHECK( loc.idx_record == 1 && loc.start == 0 && loc.id_ref == "seq2" );
+  loc = genome.getLocusByGlobalPos(15);
+  BOOST_CHECK( loc.idx_record == 1 && loc.start == 5 );
+
+  // first position of each unmasked region
+  loc = genome.getAbsoluteLocusMasked(0.0);
+  BOOST_CHECK( loc.idx_record == 0 && loc.start == 0 );
+  loc = genome.getAbsoluteLocusMasked(0.4);
+  BOOST_CHECK( loc.idx_record == 0 && loc.start == 8 );
+  loc = genome.getAbsoluteLocusMasked(0.6);
+  BOOST_CHECK( loc.idx_record == 1 && loc.start == 2 );
+  loc = genome.getAbsoluteLocusMasked(1.0);
+  BOOST_CHECK( loc.idx_record == 1 && loc.start == 5 );
+
+  // batched lookups match single lookups
+  vector<TCoord> vec_pos;
+  for (TCoord p=0; p<genome.length; ++p)
+    vec_pos.push_back(p);
+  vector<Locus> vec_loc;
+  genome.getLociByGlobalPos(vec_pos, vec_loc);
+  BOOST_REQUIRE( vec_loc.size() == vec_pos.size() );
+  for (size_t i=0; i<vec_pos.size(); ++i) {
+    loc = genome.getLocusByGlobalPos(vec_pos[i]);
+    BOOST_CHECK( vec_loc[i].idx_record == loc.idx_record && vec_loc[i].start == loc.start );
+  }
+  vector<double> vec_rel_pos;
+  for (unsigned i=0; i<=20; ++i)
+    vec_rel_pos.push_back(i/20.0);
+  genome.getAbsoluteLociMasked(vec_rel_pos, vec_loc);
+  BOOST_REQUIRE( vec_loc.size() == vec_rel_pos.size() );
+  for (size_t i=0; i<vec_rel_pos.size(); ++i) {
+    loc = genome.getAbsoluteLocusMasked(vec_rel_pos[i]);
+    BOOST_CHECK( vec_loc[i].idx_record == loc.idx_record && vec_loc[i].start == loc.start );
+  }
+}
+
+/* global coordinates beyond 32 bits */
+BOOST_AUTO_TEST_CASE ( coord64 )
+{
+  GenomeReference genome;
+  genome.num_records = 2;
+  genome.records.push_back(make_shared<SeqRecord>("chr1", "", ""));
+  genome.records.push_back(make_shared<SeqRecord>("chr2", "", ""));
+  genome.records[0]->id_ref = "chr1";
+  genome.records[1]->id_ref = "chr2";
+  genome.vec_start_chr = { 0, 5000000000UL, 6000000000UL };
+  genome.length = genome.vec_start_chr.back();
+  genome.vec_start_masked = { 0, 5000000000UL };
+  genome.vec_cumlen_masked = { 5000000000UL, 6000000000UL };
+  genome.masked_length = genome.vec_cumlen_masked.back();
+
+  Locus loc = genome.getLocusByGlobalPos(5500000000UL);
+  BOOST_CHECK( loc.idx_record == 1 && loc.start == 500000000UL && loc.id_ref == "chr2" );
+  loc = genome.getLocusByGlobalPos(4999999999UL);
+  BOOST_CHECK( loc.idx_record == 0 && loc.start == 4999999999UL );
+  loc = genome.getAbsoluteLocusMasked(0.8);
+  BOOST_CHECK( loc.idx_record == 0 && loc.start == 4800000000UL );
+}
+
+/* generate sequence from kmer profile */
+BOOST_AUTO_TEST_CASE ( kmer )
+{
+  // dinucleotide profile: 'C' is never followed by 'G'
+  KmerProfile prof;
+  prof.kmer_length = 2;
+  string nucs = "ACGT";
+  for (char n1 : nucs) {
+    for (char n2 : nucs) {
+      prof.m_vec_kmers.push_back(string(1, n1) + n2);
+      prof.m_vec_weight.push_back(n1 == 'C' && n2 == 'G' ? 0.0 : 1.0);
+      prof.num_kmers++;
+    }
+  }
+  BOOST_REQUIRE( prof.indexPrefixes() );
+  BOOST_CHECK( KmerProfile::getKmerCode("CG") == 6 );
+
+  RandomNumberGenerator rng(123456789);
+  PackedSequence seq;
+  BOOST_CHECK( generateRandomDnaSeq(seq, 10000, prof, rng) == 10000 );
+  BOOST_REQUIRE( seq.length == 10000 );
+  string str_seq = seq.str();
+  BOOST_CHECK( str_seq.find("CG") == string::npos );
+  BOOST_CHECK( str_seq.find_first_not_of("ACGT") == string::npos );
+  BOOST_CHECK( count(str_seq.begin(), str_seq.end(), 'C') > 1000 );
+}
+
+/* generated genome does not depend on number of threads */
+BOOST_AUTO_TEST_CASE ( gen_parallel )
+{
+  int num_threads = omp_get_max_threads();
+  vector<string> vec_seq[2];
+  for (int n : {1, 4}) {
+    omp_set_num_threads(n);
+    RandomNumberGenerator rng(123456789);
+    GenomeReference genome;
+    genome.generate_nucfreqs(8, 20000, 10000, {0.3, 0.2, 0.2, 0.3}, rng);
+    BOOST_REQUIRE( genome.records.size() == 8 );
+    for (auto const & rec : genome.records)
+      vec_seq[n > 1].push_back(rec->seq_packed.str());
+  }
+  omp_set_num_threads(num_threads);
+  BOOST_CHECK( vec_seq[0] == vec_seq[1] );
+  BOOST_CHECK( vec_seq[0][0] != vec_seq[0][1] );
+}
+
+/* access sequences through views */
+BOOST_AUTO_TEST_CASE ( view )
+{
+  ofstream ofs("test_view.fa");
+  ofs << ">seq1\nACGTACGTAC\nGTacgtNNNN\nACG\n";
+  ofs.close();
+  GenomeReference genome("test_view.fa");
+  BOOST_REQUIRE( genome.records.size() == 1 );
+
+  // chromosome composed of two records (mapped, packed)
+  shared_ptr<SeqRecord> sp_rec2(new SeqRecord("seq2", "", "TTGGccNA"));
+  sp_rec2->pack();
+  shared_ptr<ChromosomeReference> sp_chr = genome.chromosomes["seq1"];
+  sp_chr->map_start_rec[30] = sp_rec2;
+  sp_chr->length = 38;
+
+  vector<SeqView> views;
+  BOOST_REQUIRE( genome.getSequenceViews("seq1", 20, 34, views) );
+  BOOST_REQUIRE( views.size() == 2 );
+  BOOST_CHECK( views[0].pos_chr == 20 && views[0].length() == 3 );
+  BOOST_CHECK( views[1].pos_chr == 30 && views[1].length() == 4 );
+  string seq;
+  views[0].str(seq);
+  BOOST_CHECK( seq == "ACG" );
+  BOOST_CHECK( string(views[1].begin(), views[1].end()) == "TTGG" );
+  char buf[8];
+  BOOST_CHECK( views[1].copy(2, 8, buf) == 2 );
+  BOOST_CHECK( string(buf, 2) == "GG" );
+  BOOST_CHECK( !genome.getSequenceViews("seq1", 24, 29, views) );
+
+  BOOST_CHECK( genome.getSequence("seq1", 12, 34, seq) );
+  BOOST_CHECK( seq == "acgtNNNNACGTTGG" );
+
+  // single-base access
+  BOOST_CHECK( genome.getNucAt("seq1", 0) == 'A' );
+  BOOST_CHECK( genome.getNucAt("seq1", 13) == 'c' );
+  BOOST_CHECK( genome.getNucAt("seq1", 25) == 'N' );
+  BOOST_CHECK( genome.getNucAt("seq1", 34) == 'c' );
+  BOOST_CHECK( genome.getNucAt("seq1", 36) == 'N' );
+}
+
+/* FASTA records streamed from sequence views */
+BOOST_AUTO_TEST_CASE ( fasta_stream )
+{
+  // long enough to exceed the output buffer several times
+  string seq(200003, 'N');
+  const char nucs[] = "ACGT";
+  for (size_t i = 0; i < seq.length(); ++i)
+    seq[i] = nucs[(i*i + 7*i) % 4];
+  shared_ptr<SeqRecord> sp_rec(new SeqRecord("seq", "", seq));
+  sp_rec->pack();
+
+  for (TCoord padding : { 0, 7, 150 }) {
+    for (TCoord len : { 1, 60, 1000, 200000 }) {
+      SeqView view(sp_rec.get(), 3, len, 3);
+      string str_pad(padding, 'A');
+      vector<shared_ptr<SeqRecord>> vec_rec = { make_shared<SeqRecord>("tile", "", str_pad+seq.substr(3, len)+str_pad) };
+      ostringstream oss_exp, oss_stream;
+      writeFasta(vec_rec, oss_exp, 60);
+      writeFastaRecord("tile", view, oss_stream, padding, 'A', 60);
+      BOOST_CHECK( oss_stream.str() == oss_exp.str() );
+    }
+  }
+}
+
+/* segment copy identifiers */
+BOOST_AUTO_TEST_CASE ( segid )
+{
+  // forked ranges do not overlap with parent range
+  SegmentIdAllocator ids;
+  BOOST_CHECK( ids.next() == 0 );
+  shared_ptr<SegmentIdAllocator> sp_fork = ids.fork(10);
+  BOOST_CHECK( sp_fork->next() == 1 );
+  BOOST_CHECK( sp_fork->available() == 9 );
+  BOOST_CHECK( ids.next() == 11 );
+
+  // genome copies share segment copies until they are modified
+  RandomNumberGenerator rng(123456789);
+  ref_genome = GenomeReference();
+  ref_genome.generate_nucfreqs(3, 1000, 0, {0.3, 0.2, 0.2, 0.3}, rng);
+  shared_ptr<SegmentIdAllocator> sp_ids(new SegmentIdAllocator(100));
+  GenomeInstance genome(ref_genome, sp_ids);
+  BOOST_CHECK( genome.map_id_chr["chr1"][0]->segments.front().id >= 100 );
+  GenomeInstance genome_copy(genome);
+  BOOST_CHECK( genome_copy.map_id_chr["chr1"][0] == genome.map_id_chr["chr1"][0] );
+
+  // modified chromosome is copied, others remain shared
+  shared_ptr<ChromosomeInstance> sp_chr = genome_copy.unshareChromosome("chr1", 0);
+  sp_chr->amplifyRegion(0.2, 0.5, true, false);
+  BOOST_CHECK( sp_chr->segments.size() == 3 );
+  BOOST_CHECK( genome.map_id_chr["chr1"][0]->segments.size() == 1 );
+  BOOST_CHECK( genome_copy.map_id_chr["chr1"][0] == sp_chr );
+  BOOST_CHECK( find(genome_copy.vec_chr.begin(), genome_copy.vec_chr.end(), sp_chr) != genome_copy.vec_chr.end() );
+  BOOST_CHECK( genome_copy.map_id_chr["chr1"][1] == genome.map_id_chr["chr1"][1] );
+
+  // inherited segment copy gets a new id when modified (only once)
+  vector<seg_mod_t> vec_seg_mod;
+  SegmentCopy seg_old = genome.map_id_chr["chr2"][1]->segments.front();
+  TSegId id_new = genome_copy.unshareSegmentCopy("chr2", seg_old, vec_seg_mod);
+  BOOST_CHECK( id_new != seg_old.id );
+  BOOST_CHECK( vec_seg_mod.size() == 1 );
+  BOOST_CHECK( genome.map_id_chr["chr2"][1]->segments.front().id == seg_old.id );
+  SegmentCopy seg_new = genome_copy.map_id_chr["chr2"][1]->segments.front();
+  BOOST_CHECK( seg_new.id == id_new );
+  BOOST_CHECK( genome_copy.unshareSegmentCopy("chr2", seg_new, vec_seg_mod) == id_new );
+  BOOST_CHECK( vec_seg_mod.size() == 1 );
+}
+
+/* segment copies indexed by physical position */
+BOOST_AUTO_TEST_CASE ( segtree )
+{
+  // segments of length 10, each covering a distinct reference region
+  SegmentTree tree;
+  vector<SegmentCopy> vec_seg;
+  for (TSegId i=0; i<1000; ++i) {
+    SegmentCopy seg(i, 100*i, 100*i+10, 'A');
+    tree.push_back(seg);
+    vec_seg.push_back(seg);
+  }
+  BOOST_CHECK( tree.size() == 1000 );
+  BOOST_CHECK( tree.length() == 10000 );
+  BOOST_CHECK( equal(tree.begin(), tree.end(), vec_seg.begin()) );
+
+  // building from a sequence gives the same tree, without intermediate nodes
+  SegmentTree tree_built;
+  tree_built.build(vec_seg);
+  BOOST_CHECK( tree_built.size() == 1000 && tree_built.length() == 10000 );
+  BOOST_CHECK( equal(tree_built.begin(), tree_built.end(), vec_seg.begin()) );
+  BOOST_CHECK( (*tree_built.sp_arena)[tree_built.root].seg.id == (*tree.sp_arena)[tree.root].seg.id );
+  BOOST_CHECK( tree_built.sp_arena->size() == 1000 );
+
+  // split inside and at boundary of segments
+  SegmentTree left, right;
+  SegmentCopy seg_mid;
+  TCoord off_mid = 0;
+  BOOST_CHECK( tree.split(4567, left, right, seg_mid, off_mid) );
+  BOOST_CHECK( seg_mid.id == 456 && off_mid == 7 );
+  BOOST_CHECK( left.size() == 456 && right.size() == 543 );
+  BOOST_CHECK( right.front().id == 457 );
+  BOOST_CHECK( !tree.split(4570, left, right, seg_mid, off_mid) );
+  BOOST_CHECK( left.size() == 457 && right.front().id == 457 );
+  left.append(right);
+  BOOST_CHECK( equal(left.begin(), left.end(), vec_seg.begin()) );
+  BOOST_CHECK( tree.size() == 1000 ); // original tree unchanged
+
+  // parts of segments covering physical interval
+  vector<tuple<SegmentCopy, TCoord, TCoord>> vec_pieces;
+  tree.getPieces(15, 32, vec_pieces);
+  BOOST_REQUIRE( vec_pieces.size() == 3 );
+  BOOST_CHECK( get<1>(vec_pieces[0]) == 105 && get<2>(vec_pieces[0]) == 110 );
+  BOOST_CHECK( get<0>(vec_pieces[1]).id == 2 );
+  BOOST_CHECK( get<1>(vec_pieces[2]) == 300 && get<2>(vec_pieces[2]) == 302 );
+
+  // lookup by reference position and id
+  vector<SegmentCopy> vec_at;
+  tree.getSegmentCopiesAt(50005, vec_at);
+  BOOST_REQUIRE( vec_at.size() == 1 );
+  BOOST_CHECK( vec_at[0].id == 500 );
+  vec_at.clear();
+  tree.getSegmentCopiesAt(50015, vec_at);
+  BOOST_CHECK( vec_at.size() == 0 );
+  SegmentTree tree_copy = tree;
+  BOOST_CHECK( tree_copy.replaceId(vec_seg[500], 5000) );
+  BOOST_CHECK( !tree_copy.contains(vec_seg[500]) );
+  BOOST_CHECK( tree.contains(vec_seg[500]) );
+}
+
+/* trees modified concurrently, nodes allocated from a common arena */
+BOOST_AUTO_TEST_CASE ( segarena )
+{
+  shared_ptr<SegmentTree::Arena> sp_arena = make_shared<SegmentTree::Arena>();
+  const int num_trees = 8;
+  const TSegId num_seg = 10000; // spans several arena chunks
+  vector<SegmentTree> vec_tree(num_trees, SegmentTree(sp_arena));
+  #pragma omp parallel for
+  for (int i = 0; i < num_trees; ++i) {
+    for (TSegId j = 0; j < num_seg; ++j)
+      vec_tree[i].push_back(SegmentCopy(i*num_seg + j, 10*j, 10*j+10, 'A'));
+  }
+  BOOST_CHECK( sp_arena->size() >= num_trees*num_seg );
+  for (int i = 0; i < num_trees; ++i) {
+    BOOST_CHECK( vec_tree[i].size() == num_seg );
+    TSegId id_exp = i*num_seg;
+    bool is_ordered = true;
+    for (auto const & seg : vec_tree[i])
+      is_ordered = is_ordered && (seg.id == id_exp++);
+    BOOST_CHECK( is_ordered );
+  }
+
+  // trees derived from each other share the arena
+  SegmentTree left, right;
+  SegmentCopy seg_mid;
+  TCoord off_mid = 0;
+  vec_tree[0].split(50005, left, right, seg_mid, off_mid);
+  BOOST_CHECK( left.sp_arena == sp_arena && right.sp_arena == sp_arena );
+  left.append(right);
+  BOOST_CHECK( left.size() == num_seg-1 );
+}
+
+BOOST_AUTO_TEST_CASE ( segindex )
+{
+  // overlapping SegmentCopies: [0,100), [50,150), [100,200), [300,400)
+  vector<SegmentCopy> vec_seg;
+  vec_seg.push_back(SegmentCopy(3, 0, 100, 'A'));
+  vec_seg.push_back(SegmentCopy(1, 50, 150, 'A'));
+  vec_seg.push_back(SegmentCopy(2, 100, 200, 'B'));
+  vec_seg.push_back(SegmentCopy(0, 300, 400, 'B'));
+  SegmentIndex idx;
+  idx.build(vec_seg);
+
+  // compare with boost::icl interval map
+  TSegMap imap_seg;
+  for (auto const & seg : vec_seg) {
+    std::set<SegmentCopy> segset({seg});
+    imap_seg += make_pair(interval<TCoord>::right_open(seg.ref_start, seg.ref_end), segset);
+  }
+  vector<pair<TCoord, TCoord>> vec_qry = { {0,1}, {49,51}, {99,101}, {150,350}, {200,300}, {399,500}, {0,400} };
+  for (auto const & qry : vec_qry) {
+    TSegSet iset_qry;
+    iset_qry.add(interval<TCoord>::right_open(qry.first, qry.second));
+    vector<TSegId> vec_exp;
+    for (auto const & itvl_iset : (imap_seg & iset_qry))
+      for (const SegmentCopy & seg : itvl_iset.second)
+        vec_exp.push_back(seg.id);
+    auto p_ids = idx.getSegmentIds(qry.first, qry.second);
+    vector<TSegId> vec_obs(p_ids.first, p_ids.second);
+    BOOST_CHECK( vec_obs == vec_exp );
+  }
+
+  // position not covered by any SegmentCopy
+  auto p_ids = idx.getSegmentIds(250, 260);
+  BOOST_CHECK( p_ids.first == p_ids.second );
+  p_ids = idx.getSegmentIds(400, 410);
+  BOOST_CHECK( p_ids.first == p_ids.second );
+}
+
+BOOST_AUTO_TEST_CASE ( cnprofile )
+{
+  // clone 1: [0,100) A, [50,150) B, [100,200) A, [300,400) B
+  vector<SegmentCopy> vec_seg_1;
+  vec_seg_1.push_back(SegmentCopy(0, 0, 100, 'A'));
+  vec_seg_1.push_back(SegmentCopy(1, 50, 150, 'B'));
+  vec_seg_1.push_back(SegmentCopy(2, 100, 200, 'A'));
+  vec_seg_1.push_back(SegmentCopy(3, 300, 400, 'B'));
+  // clone 2: [0,400) A, [0,400) B
+  vector<SegmentCopy> vec_seg_2;
+  vec_seg_2.push_back(SegmentCopy(4, 0, 400, 'A'));
+  vec_seg_2.push_back(SegmentCopy(5, 0, 400, 'B'));
+  CopyNumberProfile cn_1, cn_2;
+  cn_1.build(vec_seg_1);
+  cn_2.build(vec_seg_2);
+
+  // compare with boost::icl interval map (uncovered intervals are not stored there)
+  typedef std::map<TCoord, pair<double, double>> TCnCheck;
+  auto toMap = [](const CopyNumberProfile& cn) {
+    TCnCheck map_cn;
+    for (size_t i = 0; i < cn.numIntervals(); ++i)
+      if (cn.isCovered(i))
+        map_cn[cn.m_bkp[i]] = make_pair(cn.m_count_A[i], cn.m_count_B[i]);
+    return map_cn;
+  };
+  interval_map<TCoord, AlleleSpecCopyNum> imap_cn;
+  for (auto const & seg : vec_seg_1) {
+    AlleleSpecCopyNum ascn;
+    (seg.gl_allele == 'A' ? ascn.count_A : ascn.count_B) = 1.0;
+    imap_cn += make_pair(interval<TCoord>::right_open(seg.ref_start, seg.ref_end), ascn);
+  }
+  TCnCheck map_exp;
+  for (auto const & itvl_cn : imap_cn)
+    map_exp[itvl_cn.first.lower()] = make_pair(itvl_cn.second.count_A, itvl_cn.second.count_B);
+  BOOST_CHECK( toMap(cn_1) == map_exp );
+  BOOST_CHECK( cn_1.numIntervals() == 5 ); // incl. gap [200,300)
+  BOOST_CHECK( cn_1.find(250) == 3 && !cn_1.isCovered(3) );
+  BOOST_CHECK( cn_1.find(400) == cn_1.numIntervals() );
+  BOOST_CHECK( cn_1.getAbsoluteLength() == 400 );
+
+  // weighted sum of profiles
+  CopyNumberProfile cn_mix;
+  cn_mix.build({ &cn_1, &cn_2 }, { 0.5, 0.25 });
+  BOOST_CHECK( cn_mix.numIntervals() == 5 );
+  size_t i = cn_mix.find(75);
+  BOOST_CHECK( cn_mix.m_bkp[i] == 50 && cn_mix.m_bkp[i+1] == 150 ); // joined intervals
+  BOOST_CHECK( cn_mix.m_count_A[i] == 0.75 && cn_mix.m_count_B[i] == 0.75 );
+  i = cn_mix.find(250);
+  BOOST_CHECK( cn_mix.m_count_A[i] == 0.25 && cn_mix.m_count_B[i] == 0.25 );
+  BOOST_CHECK( cn_mix.getAbsoluteLength() == 400 );
 }
 
 BOOST_AUTO_TEST_CASE ( tmap )
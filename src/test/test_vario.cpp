@@ -3,11 +3,17 @@
 
 #include "../core/random.hpp"
 #include "../core/seqio.hpp"
+#include "../core/treeio.hpp"
 #include "../core/vario.hpp"
+#include "../core/vario/HaplotypeStore.hpp"
+#include "../core/vario/SegmentArchive.hpp"
+#include "../core/vario/SegmentVariantMap.hpp"
+#include "../core/vario/VariantTable.hpp"
 #include "../core/vario/VariantStore.hpp"
 #include <boost/icl/interval_map.hpp>
 using namespace boost::icl;
 #include <fstream>
+#include <omp.h>
 #include <vector>
 using stringio::format;
 using evolution::GermlineSubstitutionModel;
@@ -54,6 +60,69 @@ struct FixtureVario {
     BOOST_TEST_MESSAGE( "teardown fixture" );
   }
 
+
+  /** Generate random somatic mutations on first reference chromosome.
+   *  Every k-th mutation is a focal CNV (every other one a deletion), others are SNVs.
+   */
+  void
+  generateMutations (
+    vector<Mutation>& vec_mut,
+    VariantStore& var_store,
+    const int num_mut,
+    const int k_cnv,
+    const double len_cnv,
+    function<double()>& random_dbl
+  )
+  {
+    string id_chr = ref_genome.chromosomes.begin()->first;
+    vec_mut.assign(num_mut, Mutation());
+    for (int i = 0; i < num_mut; ++i) {
+      vec_mut[i].id = i;
+      if (i % k_cnv == 0) {
+        vec_mut[i].is_cnv = true;
+        CopyNumberVariant cnv;
+        cnv.ref_chr = id_chr;
+        cnv.is_deletion = (i % (2*k_cnv) == 0);
+        cnv.start_rel = random_dbl() * 0.9;
+        cnv.len_rel = len_cnv;
+        var_store.map_id_cnv[i] = cnv;
+      } else {
+        vec_mut[i].is_snv = true;
+        TCoord pos = TCoord(random_dbl() * ref_genome.length);
+        var_store.tbl_snv.add(i, Variant(format("snv%d", i), id_chr, pos));
+      }
+    }
+  }
+
+  /** Check that two genomes consist of the same SegmentCopies and that
+   *  the same variants are associated with SegmentCopies in both stores.
+   */
+  void
+  checkEqualGenomes (
+    const GenomeInstance& g_a,
+    const VariantStore& var_store_a,
+    const GenomeInstance& g_b,
+    const VariantStore& var_store_b
+  )
+  {
+    BOOST_REQUIRE( g_a.vec_chr.size() == g_b.vec_chr.size() );
+    for (size_t i = 0; i < g_a.vec_chr.size(); ++i) {
+      vector<SegmentCopy> vec_seg_a(g_a.vec_chr[i]->segments.begin(), g_a.vec_chr[i]->segments.end());
+      vector<SegmentCopy> vec_seg_b(g_b.vec_chr[i]->segments.begin(), g_b.vec_chr[i]->segments.end());
+      BOOST_REQUIRE( vec_seg_a.size() == vec_seg_b.size() );
+      for (size_t j = 0; j < vec_seg_a.size(); ++j) {
+        BOOST_CHECK( vec_seg_a[j].id == vec_seg_b[j].id );
+        BOOST_CHECK( vec_seg_a[j].ref_start == vec_seg_b[j].ref_start );
+        BOOST_CHECK( vec_seg_a[j].ref_end == vec_seg_b[j].ref_end );
+      }
+    }
+    BOOST_REQUIRE( var_store_a.map_seg_vars.size() == var_store_b.map_seg_vars.size() );
+    for (auto const & kv : var_store_a.map_seg_vars) {
+      BOOST_REQUIRE( var_store_b.map_seg_vars.count(kv.first) > 0 );
+      BOOST_CHECK( *(kv.second) == *(var_store_b.map_seg_vars.at(kv.first)) );
+    }
+  }
+
   string fn_vcf;
   GermlineSubstitutionModel model;
   seqio::GenomeReference ref_genome;
@@ -88,6 +157,24 @@ BOOST_AUTO_TEST_CASE( vcf_sumstats )
   BOOST_TEST_MESSAGE( format(" T | %0.4f | %0.4f | %0.4f | %0.4f ", f[3][0], f[3][1], f[3][2], f[3][3]) );
 }
 
+/* nucleotides absent from the reference are not mutated */
+BOOST_AUTO_TEST_CASE( germline_missing_nuc )
+{
+  // reference consists only of A and T
+  GenomeReference ref_at;
+  ref_at.generate_nucfreqs(1, 10000, 0, { 0.5, 0.0, 0.0, 0.5 }, rng);
+  ref_at.indexRecords();
+  BOOST_REQUIRE( ref_at.countNuc(1) == 0 && ref_at.countNuc(2) == 0 );
+
+  VariantStore var_store;
+  BOOST_REQUIRE( var_store.generateGermlineVariants(100, ref_at, model, 0.1, rng) );
+  BOOST_CHECK( var_store.tbl_snv.size() == 100 );
+  for (int id : var_store.tbl_snv.getIds()) {
+    char ref = var_store.tbl_snv.ref(var_store.tbl_snv.getRow(id));
+    BOOST_CHECK( ref == 'A' || ref == 'T' );
+  }
+}
+
 /* generate set of novel variants */
 /* TODO: Test has to be rewritten (use VariantStore). */
 BOOST_AUTO_TEST_CASE( germline )
@@ -169,6 +256,52 @@ BOOST_AUTO_TEST_CASE( var_dist )
   BOOST_TEST_MESSAGE( format(" T | %0.4f | %0.4f | %0.4f | %0.4f ", g[3][0], g[3][1], g[3][2], g[3][3]) );
 }
 
+/* assign germline variants to SegmentCopies of a rearranged genome */
+BOOST_AUTO_TEST_CASE( germline_seg )
+{
+  // NOTE: reference genome generated in FixtureVario()
+  string id_chr = ref_genome.chromosomes.begin()->first;
+  function<double()> random_dbl = rng.getRandomFunctionReal(0.0, 1.0);
+  VariantStore var_store;
+  var_store.generateGermlineVariants(1000, ref_genome, model, 0.1, rng);
+
+  // focal CNVs, so that loci are covered by varying numbers of SegmentCopies
+  GenomeInstance genome(ref_genome);
+  vector<Mutation> vec_mut(10);
+  for (int i = 0; i < 10; ++i) {
+    vec_mut[i].id = i;
+    vec_mut[i].is_cnv = true;
+    CopyNumberVariant cnv;
+    cnv.ref_chr = id_chr;
+    cnv.is_deletion = (i % 3 == 0);
+    cnv.start_rel = random_dbl() * 0.8;
+    cnv.len_rel = 0.2;
+    var_store.map_id_cnv[i] = cnv;
+  }
+  var_store.applyMutations(vec_mut, genome, rng);
+  var_store.applyGermlineVariants(genome, rng);
+
+  std::map<int, std::set<TSegId>> map_var_segs;
+  for (auto const & kv : var_store.map_seg_vars)
+    for (int id_var : *(kv.second))
+      map_var_segs[id_var].insert(kv.first);
+  for (int id_snv : var_store.tbl_snv.getIds()) {
+    const Variant var = var_store.tbl_snv.at(id_snv);
+    vector<SegmentCopy> vec_seg = genome.getSegmentCopiesAt(var.chr, var.pos);
+    const std::set<TSegId>& set_carrier = map_var_segs[id_snv];
+    size_t num_carrier = 0;
+    for (auto const & seg : vec_seg)
+      num_carrier += set_carrier.count(seg.id);
+    BOOST_CHECK( num_carrier == set_carrier.size() ); // only overlapping SegmentCopies
+    if (vec_seg.size() == 0)
+      continue;
+    if (var.is_het)
+      BOOST_CHECK( num_carrier == 1 );
+    else
+      BOOST_CHECK( num_carrier == vec_seg.size() );
+  }
+}
+
 /* test data structures for CNVs */
 BOOST_AUTO_TEST_CASE( cnv )
 {
@@ -221,10 +354,10 @@ BOOST_AUTO_TEST_CASE( cnv )
   var_store.map_id_cnv[mut_cnv_del.id] = var_cnv_del;
   var_store.map_id_cnv[mut_cnv_amp.id] = var_cnv_amp;
   var_store.map_id_cnv[mut_cnv_wgd.id] = var_cnv_wgd;
-  var_store.map_id_snv[mut_snv_1.id] = var_snv_1;
+  var_store.tbl_snv.add(mut_snv_1.id, var_snv_1);
   shared_ptr<ChromosomeInstance> chr_src = g_inst.map_id_chr[var_snv_1.chr][0];
-  SegmentCopy seg_src = chr_src->lst_segments.front();
-  var_store.map_seg_vars[seg_src.id] = { mut_snv_1.id };
+  SegmentCopy seg_src = chr_src->segments.front();
+  var_store.addSegmentVariant(seg_src.id, mut_snv_1.id);
 
   BOOST_TEST_MESSAGE( "Genome initially:\n" << g_inst );
 
@@ -266,10 +399,337 @@ BOOST_AUTO_TEST_CASE( cnv )
 
   // were variants duplicated correctly?
   shared_ptr<ChromosomeInstance> chr_copy = g_inst.map_id_chr[var_snv_1.chr][2];
-  SegmentCopy seg_copy = chr_copy->lst_segments.front();
+  SegmentCopy seg_copy = chr_copy->segments.front();
   BOOST_CHECK( var_store.map_seg_vars.count(seg_copy.id) == 1 );
-  auto v_mut_copy = var_store.map_seg_vars[seg_copy.id];
+  auto v_mut_copy = *(var_store.map_seg_vars[seg_copy.id]);
   BOOST_CHECK( find(v_mut_copy.begin(), v_mut_copy.end(), mut_snv_1.id) != v_mut_copy.end() );
 }
 
+/* clone genomes built in parallel do not depend on number of threads */
+BOOST_AUTO_TEST_CASE( clone_tree )
+{
+  // NOTE: reference genome generated in FixtureVario()
+  function<double()> random_dbl = rng.getRandomFunctionReal(0.0, 1.0);
+  int num_clones = 8;
+  int num_mut = 200;
+  treeio::Tree<Clone> tree(num_clones);
+  tree.generateRandomTopologyInternalNodes(random_dbl);
+  tree.dropSomaticMutations(num_mut, 0, rng);
+  vector<shared_ptr<Clone>> nodes = tree.getNodesPreOrder();
+
+  // every 5th mutation is a focal CNV, others are SNVs
+  VariantStore var_store_init;
+  vector<Mutation> vec_mut;
+  generateMutations(vec_mut, var_store_init, num_mut, 5, 0.05, random_dbl);
+
+  // build clone genomes using one and four threads (restore setting afterwards)
+  int num_threads_max = omp_get_max_threads();
+  vector<VariantStore> vec_var_store;
+  vector<std::map<int, GenomeInstance>> vec_map_id_genome;
+  for (int num_threads : { 1, 4 }) {
+    omp_set_num_threads(num_threads);
+    VariantStore var_store = var_store_init;
+    std::map<int, GenomeInstance> map_id_genome;
+    map_id_genome[nodes[0]->index] = GenomeInstance(ref_genome);
+    RandomNumberGenerator rng_tree(seed);
+    var_store.applyCloneTreeMutations(nodes, vec_mut, map_id_genome, rng_tree);
+    vec_var_store.push_back(var_store);
+    vec_map_id_genome.push_back(map_id_genome);
+  }
+  omp_set_num_threads(num_threads_max);
+
+  BOOST_REQUIRE( vec_map_id_genome[0].size() == nodes.size() );
+  BOOST_REQUIRE( vec_map_id_genome[1].size() == nodes.size() );
+  for (auto const & node : nodes) {
+    checkEqualGenomes(vec_map_id_genome[0].at(node->index), vec_var_store[0],
+                      vec_map_id_genome[1].at(node->index), vec_var_store[1]);
+  }
+}
+
+/* applying a branch's mutations in one batch gives the same result as one by one */
+BOOST_AUTO_TEST_CASE( mut_batch )
+{
+  // NOTE: reference genome generated in FixtureVario()
+  function<double()> random_dbl = rng.getRandomFunctionReal(0.0, 1.0);
+  int num_mut = 100;
+  // every 4th mutation is a focal CNV, others are SNVs
+  VariantStore var_store_single;
+  vector<Mutation> vec_mut;
+  generateMutations(vec_mut, var_store_single, num_mut, 4, 0.1, random_dbl);
+  VariantStore var_store_batch = var_store_single;
+
+  GenomeInstance g_single(ref_genome);
+  RandomNumberGenerator rng_single(seed);
+  for (auto const & mut : vec_mut)
+    var_store_single.applyMutation(mut, g_single, rng_single);
+  GenomeInstance g_batch(ref_genome);
+  RandomNumberGenerator rng_batch(seed);
+  var_store_batch.applyMutations(vec_mut, g_batch, rng_batch);
+
+  checkEqualGenomes(g_single, var_store_single, g_batch, var_store_batch);
+
+  // a SegmentCopy is picked independently for each SNV (both homologous copies are hit)
+  string id_chr = ref_genome.chromosomes.begin()->first;
+  VariantStore var_store_dip;
+  vector<Mutation> vec_snv(50);
+  for (int i = 0; i < int(vec_snv.size()); ++i) {
+    vec_snv[i].id = i;
+    vec_snv[i].is_snv = true;
+    var_store_dip.tbl_snv.add(i, Variant(format("snv%d", i), id_chr, 100*i));
+  }
+  GenomeInstance g_dip(ref_genome);
+  RandomNumberGenerator rng_dip(seed);
+  var_store_dip.applyMutations(vec_snv, g_dip, rng_dip);
+  std::set<char> set_allele;
+  for (auto const & sp_chr : g_dip.map_id_chr[id_chr]) {
+    for (auto const & seg : sp_chr->segments) {
+      if (var_store_dip.map_seg_vars.count(seg.id) > 0)
+        set_allele.insert(seg.gl_allele);
+    }
+  }
+  BOOST_CHECK( set_allele.size() == 2 );
+}
+
+/* write clone genomes to segment archive and load them back */
+BOOST_AUTO_TEST_CASE( seg_archive )
+{
+  // NOTE: reference genome generated in FixtureVario()
+  string id_chr = ref_genome.chromosomes.begin()->first;
+  GenomeInstance g_healthy(ref_genome);
+  GenomeInstance g_tumor(g_healthy);
+  shared_ptr<ChromosomeInstance> sp_chr = g_tumor.unshareChromosome(id_chr, 0);
+  sp_chr->amplifyRegion(0.4, 0.2, true, false);
+  VariantStore var_store;
+  var_store.tbl_snv.add(0, Variant("snv0", id_chr, 100));
+  var_store.tbl_snv.add(1, Variant("snv1", id_chr, 50000));
+  var_store.addSegmentVariant(g_healthy.vec_chr[0]->segments.front().id, 0);
+  var_store.addSegmentVariant(sp_chr->segments.front().id, 1);
+  std::map<string, GenomeInstance> map_clone_genome = { {"N", g_healthy}, {"T", g_tumor} };
+
+  string fn_archive = "test_segments.bin";
+  BOOST_REQUIRE( SegmentArchive::write(fn_archive, map_clone_genome, var_store) );
+  SegmentArchive archive;
+  BOOST_REQUIRE( archive.open(fn_archive) );
+  BOOST_CHECK( archive.getCloneLabels() == vector<string>({ "N", "T" }) );
+  BOOST_CHECK( archive.getChromosomeIds("T") == vector<string>({ id_chr }) );
+
+  // all SegmentCopies, in physical order
+  for (auto const & lbl_gi : map_clone_genome) {
+    vector<ArchivedSegment> vec_seg;
+    BOOST_REQUIRE( archive.getSegments(lbl_gi.first, id_chr, vec_seg) );
+    size_t i = 0;
+    for (size_t j = 0; j < lbl_gi.second.map_id_chr.at(id_chr).size(); ++j) {
+      for (auto const & seg : lbl_gi.second.map_id_chr.at(id_chr)[j]->segments) {
+        BOOST_REQUIRE( i < vec_seg.size() );
+        BOOST_CHECK( vec_seg[i].idx_chr_inst == j );
+        BOOST_CHECK( vec_seg[i].id == seg.id );
+        BOOST_CHECK( vec_seg[i].ref_start == seg.ref_start );
+        BOOST_CHECK( vec_seg[i].ref_end == seg.ref_end );
+        ++i;
+      }
+    }
+    BOOST_CHECK( i == vec_seg.size() );
+    BOOST_CHECK( vec_seg[0].vec_var_ids == vector<string>({ lbl_gi.first == "N" ? "snv0" : "snv1" }) );
+  }
+
+  // SegmentCopies overlapping a region
+  vector<ArchivedSegment> vec_seg_reg;
+  BOOST_REQUIRE( archive.getSegments("T", id_chr, vec_seg_reg, 45000, 46000) );
+  BOOST_CHECK( vec_seg_reg.size() == 3 ); // amplified region (2x) + homologous chromosome
+  for (auto const & seg : vec_seg_reg)
+    BOOST_CHECK( seg.ref_start < 46000 && seg.ref_end > 45000 );
+  BOOST_CHECK( !archive.getSegments("X", id_chr, vec_seg_reg) );
+
+  // corrupted blocks are detected
+  const SegmentArchive::Entry& entry_last = archive.vec_entries.back();
+  fstream fs(fn_archive, ios::in | ios::out | ios::binary);
+  fs.seekp(archive.pos_blocks + entry_last.offset + entry_last.len - 1);
+  fs.put('\xff');
+  fs.close();
+  SegmentArchive archive_bad;
+  BOOST_REQUIRE( archive_bad.open(fn_archive) );
+  vector<ArchivedSegment> vec_seg_bad;
+  BOOST_CHECK( !archive_bad.getSegments(entry_last.lbl_clone, entry_last.id_chr, vec_seg_bad) );
+  remove(fn_archive.c_str());
+}
+
+/* columnar SNV storage */
+BOOST_AUTO_TEST_CASE( var_table )
+{
+  VariantTable tbl;
+  Variant var_som("s0", "chr2", 300);
+  var_som.alleles = { "C", "T" };
+  var_som.is_somatic = true;
+  tbl.add(0, var_som);
+  for (int i = 0; i < 3; ++i) {
+    Variant var_gl(format("g%d", i), "chr1", 100*(3-i));
+    var_gl.alleles = { "A", "G" };
+    var_gl.is_het = (i != 1);
+    var_gl.idx_mutation = i-3;
+    tbl.add(i-3, var_gl);
+  }
+  Variant var_ext("s2", "chr1", 200);
+  var_ext.alleles = { "AC", "n" };
+  var_ext.is_somatic = true;
+  var_ext.is_error = true;
+  var_ext.reg_copy = 1;
+  var_ext.idx_mutation = 7;
+  tbl.add(2, var_ext);
+
+  BOOST_CHECK( tbl.size() == 5 );
+  BOOST_CHECK( tbl.vec_chr_name.size() == 2 ); // chromosome names are interned
+  BOOST_CHECK( tbl.getIds() == vector<int>({ -3, -2, -1, 0, 2 }) );
+  BOOST_CHECK( tbl.count(1) == 0 && tbl.count(-4) == 0 && tbl.count(3) == 0 );
+  BOOST_CHECK_THROW( tbl.at(1), std::out_of_range );
+
+  // variants are decoded from columns
+  Variant var = tbl.at(-2);
+  BOOST_CHECK( var.id == "g1" && var.chr == "chr1" && var.pos == 200 );
+  BOOST_CHECK( var.alleles == vector<string>({ "A", "G" }) );
+  BOOST_CHECK( !var.is_het && !var.is_somatic && var.idx_mutation == -2 );
+  VariantTable::TRow row = tbl.getRow(0);
+  BOOST_CHECK( tbl.ref(row) == 'C' && tbl.alt(row) == 'T' && tbl.isSomatic(row) );
+  var = tbl.at(2);
+  BOOST_CHECK( var.alleles == vector<string>({ "AC", "n" }) );
+  BOOST_CHECK( var.is_error && var.reg_copy == 1 && var.idx_mutation == 7 );
+  BOOST_CHECK( !tbl.at(-1).is_error );
+  BOOST_CHECK( tbl.alt(tbl.getRow(2)) == 'n' );
+
+  // replacing a variant keeps its row
+  var_som.pos = 50;
+  tbl.add(0, var_som);
+  BOOST_CHECK( tbl.size() == 5 && tbl.getRow(0) == row && tbl.pos(row) == 50 );
+
+  // positional index (variants at the same position ordered by id)
+  BOOST_CHECK( tbl.indexPositions() == 5 );
+  auto p_rows = tbl.getRowsInRange("chr1", 150, 300);
+  BOOST_REQUIRE( p_rows.second - p_rows.first == 2 );
+  BOOST_CHECK( tbl.col_id[p_rows.first[0]] == -2 && tbl.col_id[p_rows.first[1]] == 2 );
+  p_rows = tbl.getRowsInRange("chrX", 0, 1000);
+  BOOST_CHECK( p_rows.first == p_rows.second );
+}
+
+/* SegmentCopy -> SNV lists (hash map, sorted by position) */
+BOOST_AUTO_TEST_CASE( seg_vars )
+{
+  SegmentVariantMap map_seg_vars;
+  for (TSegId id = 0; id < 1000; ++id)
+    map_seg_vars[id*7] = make_shared<vector<int>>(1, int(id));
+  BOOST_CHECK( map_seg_vars.size() == 1000 );
+  BOOST_CHECK( map_seg_vars.vec_slots.size() >= 2000 ); // load factor <= 1/2
+  size_t num_entries = 0;
+  for (auto const & kv : map_seg_vars) {
+    BOOST_CHECK( kv.first % 7 == 0 && kv.second->front() == int(kv.first / 7) );
+    ++num_entries;
+  }
+  BOOST_CHECK( num_entries == 1000 );
+  BOOST_CHECK( map_seg_vars.count(700) == 1 && map_seg_vars.count(701) == 0 );
+  BOOST_CHECK( map_seg_vars.find(701) == map_seg_vars.end() );
+  BOOST_CHECK( map_seg_vars.at(700)->front() == 100 );
+  BOOST_CHECK_THROW( map_seg_vars.at(701), std::out_of_range );
+  // accessing existing entries does not rehash (table filled to maximum load)
+  SegmentVariantMap map_full;
+  for (TSegId id = 0; id < 16; ++id)
+    map_full[id];
+  size_t num_slots = map_full.vec_slots.size();
+  BOOST_REQUIRE( 2*map_full.size() == num_slots );
+  shared_ptr<vector<int>>& sp_vars = map_full[0];
+  for (TSegId id = 0; id < 16; ++id)
+    map_full[id];
+  BOOST_CHECK( map_full.vec_slots.size() == num_slots );
+  BOOST_CHECK( &sp_vars == &map_full[0] );
+  map_full[16];
+  BOOST_CHECK( map_full.vec_slots.size() == 2*num_slots );
+
+  // variant lists are kept sorted by position (then id)
+  VariantStore var_store;
+  vector<TCoord> vec_pos = { 500, 100, 300, 100, 900, 200 };
+  for (size_t i = 0; i < vec_pos.size(); ++i)
+    var_store.tbl_snv.add(i, Variant(format("snv%d", i), "chr1", vec_pos[i]));
+  var_store.addSegmentVariant(1, 3);
+  var_store.addSegmentVariant(1, 0);
+  vector<VariantStore::TSegVarAdd> vec_var_add;
+  for (int i : { 2, 1, 4, 5 })
+    vec_var_add.push_back(make_tuple(0, 1, i));
+  var_store.updateSegmentVariants(vector<seqio::seg_mod_t>(), vec_var_add);
+  BOOST_CHECK( *(var_store.map_seg_vars.at(1)) == vector<int>({ 1, 3, 5, 2, 0, 4 }) );
+
+  // SNVs within a range are found without copying
+  auto p_snvs = var_store.getSegmentSnvs(1, 150, 500);
+  BOOST_CHECK( vector<int>(p_snvs.first, p_snvs.second) == vector<int>({ 5, 2 }) );
+  p_snvs = var_store.getSegmentSnvs(1);
+  BOOST_CHECK( p_snvs.second - p_snvs.first == 6 );
+  p_snvs = var_store.getSegmentSnvs(2);
+  BOOST_CHECK( p_snvs.first == p_snvs.second );
+
+  // transfer to new SegmentCopies: whole copies share lists, partial copies get slices
+  vector<seqio::seg_mod_t> vec_seg_mod;
+  vec_seg_mod.push_back(make_tuple(10, 1, 0, 1000));
+  vec_seg_mod.push_back(make_tuple(11, 1, 150, 501));
+  vec_seg_mod.push_back(make_tuple(12, 1, 600, 800));
+  var_store.transferMutations(vec_seg_mod);
+  BOOST_CHECK( var_store.map_seg_vars.at(10) == var_store.map_seg_vars.at(1) );
+  BOOST_CHECK( *(var_store.map_seg_vars.at(11)) == vector<int>({ 5, 2, 0 }) );
+  BOOST_CHECK( var_store.map_seg_vars.count(12) == 0 );
+}
+
+BOOST_AUTO_TEST_CASE( haplotypes )
+{
+  // NOTE: reference genome generated in FixtureVario()
+  string id_chr = ref_genome.chromosomes.begin()->first;
+  function<double()> random_dbl = rng.getRandomFunctionReal(0.0, 1.0);
+  VariantStore var_store;
+  var_store.generateGermlineVariants(1000, ref_genome, model, 0.1, rng);
+
+  // gains and losses, so that SegmentCopies are duplicated, reordered and missing
+  GenomeInstance genome(ref_genome);
+  vector<Mutation> vec_mut(10);
+  for (int i = 0; i < 10; ++i) {
+    vec_mut[i].id = i;
+    vec_mut[i].is_cnv = true;
+    CopyNumberVariant cnv;
+    cnv.ref_chr = id_chr;
+    cnv.is_deletion = (i % 3 == 0);
+    cnv.start_rel = random_dbl() * 0.8;
+    cnv.len_rel = 0.2;
+    var_store.map_id_cnv[i] = cnv;
+  }
+  var_store.applyMutations(vec_mut, genome, rng);
+  var_store.applyGermlineVariants(genome, rng);
+
+  HaplotypeStore hap_store;
+  BOOST_REQUIRE( hap_store.addClone("T", genome, ref_genome, var_store) );
+  BOOST_REQUIRE( hap_store.getNumHaplotypes("T", id_chr) == genome.map_id_chr[id_chr].size() );
+  BOOST_CHECK( hap_store.getNumHaplotypes("X", id_chr) == 0 );
+
+  // compare to concatenated reference sequences of SegmentCopies (with SNVs)
+  for (size_t i = 0; i < genome.map_id_chr[id_chr].size(); ++i) {
+    string seq_exp;
+    for (auto const & seg : genome.map_id_chr[id_chr][i]->segments) {
+      string seq_seg;
+      ref_genome.getSequence(id_chr, seg.ref_start, seg.ref_end, seq_seg);
+      auto it_seg_vars = var_store.map_seg_vars.find(seg.id);
+      if (it_seg_vars != var_store.map_seg_vars.end())
+        for (int id_var : *(it_seg_vars->second)) {
+          const Variant var = var_store.tbl_snv.at(id_var);
+          seq_seg[var.pos - seg.ref_start] = var.alleles[1][0];
+        }
+      seq_exp += seq_seg;
+    }
+    string seq_hap;
+    BOOST_REQUIRE( hap_store.getSequence("T", id_chr, i, 0, seq_exp.length(), seq_hap) );
+    BOOST_CHECK( seq_hap == seq_exp );
+    BOOST_REQUIRE( hap_store.getSequence("T", id_chr, i, 1000, 2000, seq_hap) );
+    BOOST_CHECK( seq_hap == seq_exp.substr(1000, 1000) );
+  }
+  string seq_none;
+  BOOST_CHECK( !hap_store.getSequence("T", id_chr, 99, 0, 10, seq_none) );
+
+  // released clones keep host sequences for other clones
+  BOOST_CHECK( hap_store.removeClone("T") );
+  BOOST_CHECK( hap_store.getNumHaplotypes("T", id_chr) == 0 );
+  BOOST_CHECK( !hap_store.removeClone("T") );
+  BOOST_CHECK( hap_store.map_chr_host.count(id_chr) == 1 );
+}
+
 BOOST_AUTO_TEST_SUITE_END()